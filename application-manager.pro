@@ -86,6 +86,7 @@ printConfigLine("Shellserver support", $$yesNo(qtHaveModule(pshellserver)), auto
 printConfigLine("Genivi support", $$yesNo(qtHaveModule(geniviextras)), auto)
 printConfigLine("libbacktrace support", $$check_libbacktrace, auto)
 printConfigLine("Systemd workaround", $$yesNo(CONFIG(systemd-workaround)), auto)
+printConfigLine("Tracing", $$yesNo(CONFIG(enable-tracing)), auto)
 printConfigLine("System libarchive", $$yesNo(config_libarchive), auto)
 printConfigLine("System libyaml", $$yesNo(config_libyaml), auto)
 printConfigLine()
@@ -84,6 +84,15 @@ QVariantMap Application::toVariantMap() const
     case TracksLocation: backgroundMode = qSL("TracksLocation"); break;
     }
     map[qSL("backgroundMode")] = backgroundMode;
+    QString restartPolicy;
+    switch (m_restartPolicy) {
+    default:
+    case DefaultRestart:   break;
+    case NeverRestart:     restartPolicy = qSL("never"); break;
+    case RestartOnFailure: restartPolicy = qSL("on-failure"); break;
+    case AlwaysRestart:    restartPolicy = qSL("always"); break;
+    }
+    map[qSL("restartPolicy")] = restartPolicy;
     map[qSL("version")] = m_version;
     map[qSL("baseDir")] = m_baseDir.absolutePath();
     map[qSL("installationLocationId")] = m_installationReport ? m_installationReport->installationLocationId() : QString();
@@ -147,6 +156,16 @@ Application::ExitStatus Application::lastExitStatus() const
     return m_lastExitStatus;
 }
 
+int Application::restartCount() const
+{
+    return m_restartCount;
+}
+
+int Application::restartDelay() const
+{
+    return m_restartDelay;
+}
+
 bool Application::isPreloaded() const
 {
     return m_nonAliased ? m_nonAliased->m_preload : m_preload;
@@ -197,6 +216,32 @@ Application::BackgroundMode Application::backgroundMode() const
     return m_nonAliased ? m_nonAliased->m_backgroundMode : m_backgroundMode;
 }
 
+Application::RestartPolicy Application::restartPolicy() const
+{
+    return m_nonAliased ? m_nonAliased->m_restartPolicy : m_restartPolicy;
+}
+
+Application::RestartPolicy Application::restartPolicyFromString(const QString &policy, bool *ok)
+{
+    static const QPair<const char *, Application::RestartPolicy> restartMap[] = {
+        { "never",      NeverRestart },
+        { "on-failure", RestartOnFailure },
+        { "always",     AlwaysRestart },
+        { "",           DefaultRestart }
+    };
+
+    for (const auto &entry : restartMap) {
+        if (policy == qL1S(entry.first)) {
+            if (ok)
+                *ok = true;
+            return entry.second;
+        }
+    }
+    if (ok)
+        *ok = false;
+    return DefaultRestart;
+}
+
 QString Application::version() const
 {
     return m_nonAliased ? m_nonAliased->m_version : m_version;
@@ -250,6 +295,7 @@ void Application::mergeInto(Application *app) const
     app->m_mimeTypes = m_mimeTypes;
     app->m_categories = m_categories;
     app->m_backgroundMode = m_backgroundMode;
+    app->m_restartPolicy = m_restartPolicy;
     app->m_version = m_version;
 }
 
@@ -335,6 +381,7 @@ Application *Application::readFromDataStream(QDataStream &ds, const QVector<cons
     QScopedPointer<Application> app(new Application);
     bool isAlias;
     qint32 backgroundMode;
+    qint32 restartPolicy;
     QString baseDir;
     QByteArray installationReport;
 
@@ -353,6 +400,7 @@ Application *Application::readFromDataStream(QDataStream &ds, const QVector<cons
        >> app->m_categories
        >> app->m_mimeTypes
        >> backgroundMode
+       >> restartPolicy
        >> app->m_version
        >> baseDir
        >> app->m_uid
@@ -363,6 +411,7 @@ Application *Application::readFromDataStream(QDataStream &ds, const QVector<cons
     app->m_mimeTypes.sort();
 
     app->m_backgroundMode = static_cast<Application::BackgroundMode>(backgroundMode);
+    app->m_restartPolicy = static_cast<Application::RestartPolicy>(restartPolicy);
     app->m_baseDir.setPath(baseDir);
     if (!installationReport.isEmpty()) {
         QBuffer buffer(&installationReport);
@@ -414,6 +463,7 @@ void Application::writeToDataStream(QDataStream &ds, const QVector<const Applica
        << m_categories
        << m_mimeTypes
        << qint32(m_backgroundMode)
+       << qint32(m_restartPolicy)
        << m_version
        << m_baseDir.absolutePath()
        << m_uid
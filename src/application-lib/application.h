@@ -79,6 +79,8 @@ class Application : public QObject
     Q_PROPERTY(QT_PREPEND_NAMESPACE_AM(AbstractRuntime) *runtime READ currentRuntime)
     Q_PROPERTY(int lastExitCode READ lastExitCode)
     Q_PROPERTY(ExitStatus lastExitStatus READ lastExitStatus)
+    Q_PROPERTY(RestartPolicy restartPolicy READ restartPolicy)
+    Q_PROPERTY(int restartCount READ restartCount)
 
 public:
     enum Type { Gui, Headless };
@@ -87,6 +89,9 @@ public:
     enum ExitStatus { NormalExit, CrashExit, ForcedExit };
     Q_ENUM(ExitStatus)
 
+    enum RestartPolicy { DefaultRestart, NeverRestart, RestartOnFailure, AlwaysRestart };
+    Q_ENUM(RestartPolicy)
+
     QString id() const;
     QString absoluteCodeFilePath() const;
     QString codeFilePath() const;
@@ -118,6 +123,9 @@ public:
     };
     BackgroundMode backgroundMode() const;
 
+    RestartPolicy restartPolicy() const;
+    static RestartPolicy restartPolicyFromString(const QString &policy, bool *ok = nullptr);
+
     QString version() const;
 
     void validate() const throw (Exception);
@@ -151,6 +159,8 @@ public:
 
     int lastExitCode() const;
     ExitStatus lastExitStatus() const;
+    int restartCount() const;
+    int restartDelay() const;
 
 private:
     Application();
@@ -175,6 +185,7 @@ private:
     QStringList m_mimeTypes;
 
     BackgroundMode m_backgroundMode = Auto;
+    RestartPolicy m_restartPolicy = DefaultRestart;
 
     QString m_version;
 
@@ -196,6 +207,9 @@ private:
     mutable int m_lastExitCode = 0;
     mutable ExitStatus m_lastExitStatus = NormalExit;
 
+    mutable int m_restartCount = 0; // automatic restarts after the application exited
+    mutable int m_restartDelay = 0; // back-off delay of the last automatic restart in msec
+
     friend class YamlApplicationScanner;
     friend class ApplicationManager; // needed to update installation status
     friend class ApplicationDatabase; // needed to create Application objects
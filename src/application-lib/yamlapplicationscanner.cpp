@@ -181,6 +181,11 @@ Application *YamlApplicationScanner::scanInternal(const QString &filePath, bool
                     }
                     if (!found)
                         throw Exception(Error::Parse, "the 'backgroundMode' value '%1' is not valid").arg(enumValue);
+                } else if (field == "restartPolicy") {
+                    bool ok;
+                    app->m_restartPolicy = Application::restartPolicyFromString(v.toString(), &ok);
+                    if (!ok)
+                        throw Exception(Error::Parse, "the 'restartPolicy' value '%1' is not valid").arg(v.toString());
                 } else {
                     unknownField = true;
                 }
@@ -23,6 +23,7 @@ SOURCES += \
     utilities.cpp \
     qtyaml.cpp \
     startuptimer.cpp \
+    trace.cpp \
     dbus-policy.cpp \
 
 qtHaveModule(qml):SOURCES += \
@@ -38,6 +39,7 @@ HEADERS += \
     utilities.h \
     qtyaml.h \
     startuptimer.h \
+    trace.h \
     dbus-policy.h \
 
 qtHaveModule(qml):HEADERS += \
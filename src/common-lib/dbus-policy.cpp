@@ -141,4 +141,23 @@ bool checkDBusPolicy(const QDBusContext *dbusContext, const QMap<QByteArray, DBu
 #endif
 }
 
+// Unlike checkDBusPolicy(), this denies all calls via D-Bus, if there is no policy for the
+// function at all. Needed for functions that are too dangerous to be open to everybody by default.
+bool requireDBusPolicy(const QDBusContext *dbusContext, const QMap<QByteArray, DBusPolicy> &dbusPolicy,
+                       const QByteArray &function)
+{
+#if !defined(QT_DBUS_LIB) || defined(Q_OS_WIN)
+    Q_UNUSED(dbusContext)
+    Q_UNUSED(dbusPolicy)
+    Q_UNUSED(function)
+    return true;
+#else
+    if (!dbusContext->calledFromDBus() || dbusPolicy.contains(function))
+        return true;
+
+    dbusContext->sendErrorReply(QDBusError::AccessDenied, qSL("Protected function call (no policy)"));
+    return false;
+#endif
+}
+
 QT_END_NAMESPACE_AM
@@ -65,6 +65,8 @@ QMap<QByteArray, DBusPolicy> parseDBusPolicy(const QVariantMap &yamlFragment);
 
 bool checkDBusPolicy(const QDBusContext *dbusContext, const QMap<QByteArray, DBusPolicy> &dbusPolicy,
                      const QByteArray &function, const std::function<QStringList(qint64)> &pidToCapabilities);
+bool requireDBusPolicy(const QDBusContext *dbusContext, const QMap<QByteArray, DBusPolicy> &dbusPolicy,
+                       const QByteArray &function);
 
 QT_END_NAMESPACE_AM
 
@@ -0,0 +1,287 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <QAtomicInteger>
+#include <algorithm>
+#include <atomic>
+
+#include "global.h"
+#include "trace.h"
+
+#if defined(Q_OS_LINUX)
+#  include <unistd.h>
+#  include <sys/syscall.h>
+#endif
+
+QT_BEGIN_NAMESPACE_AM
+
+namespace {
+
+// fixed size, so that recording never allocates
+struct TraceEvent
+{
+    quint64 timestamp; // nsecs since the trace clock was started
+    const char *category;
+    const char *name;
+    qint64 value;
+    char phase;
+    char text[31];
+};
+
+struct TraceSlot
+{
+    // seqlock: 0 while the event is being written, index + 1 afterwards
+    QAtomicInteger<quint64> sequence;
+    TraceEvent event;
+};
+
+struct TraceRing
+{
+    static const int Size = 4096; // has to be a power of 2
+
+    QAtomicInt inUse;   // owned by a running thread
+    quint64 head = 0;   // only ever touched by the owning thread
+    quint64 threadId = 0;
+    QByteArray threadName;
+    TraceSlot entries[Size];
+};
+
+struct TraceRegistry
+{
+    TraceRegistry() { clock.start(); }
+
+    QMutex mutex;
+    QVector<TraceRing *> rings; // never deleted: threads might still be recording on exit
+    QElapsedTimer clock;
+};
+
+Q_GLOBAL_STATIC(TraceRegistry, traceRegistry)
+
+// gives the ring back to the pool, when its thread exits
+struct ThreadRing
+{
+    ~ThreadRing()
+    {
+        if (ring)
+            ring->inUse.storeRelease(0);
+    }
+    TraceRing *ring = nullptr;
+};
+
+static thread_local ThreadRing threadRing;
+
+static quint64 currentThreadId()
+{
+#if defined(Q_OS_LINUX)
+    return quint64(::syscall(SYS_gettid));
+#else
+    return quint64(quintptr(QThread::currentThreadId()));
+#endif
+}
+
+static TraceRing *currentRing()
+{
+    TraceRing *ring = threadRing.ring;
+    if (Q_LIKELY(ring))
+        return ring;
+
+    TraceRegistry *registry = traceRegistry();
+    QMutexLocker locker(&registry->mutex);
+
+    // re-use the ring of a finished thread, but forget about its events
+    for (TraceRing *r : qAsConst(registry->rings)) {
+        if (r->inUse.testAndSetAcquire(0, 1)) {
+            ring = r;
+            for (TraceSlot &slot : ring->entries)
+                slot.sequence.store(0);
+            break;
+        }
+    }
+    if (!ring) {
+        ring = new TraceRing;
+        ring->inUse.store(1);
+        registry->rings.append(ring);
+    }
+    ring->threadId = currentThreadId();
+    ring->threadName = QThread::currentThread() ? QThread::currentThread()->objectName().toUtf8()
+                                                : QByteArray();
+    threadRing.ring = ring;
+    return ring;
+}
+
+} // anonymous namespace
+
+void Trace::record(Trace::Phase phase, const char *category, const char *name, const char *text, qint64 value)
+{
+    TraceRegistry *registry = traceRegistry();
+    if (Q_UNLIKELY(!registry)) // already destroyed
+        return;
+
+    TraceRing *ring = currentRing();
+    quint64 index = ring->head++;
+    TraceSlot &slot = ring->entries[index & (TraceRing::Size - 1)];
+
+    slot.sequence.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TraceEvent &e = slot.event;
+    e.timestamp = quint64(registry->clock.nsecsElapsed());
+    e.category = category;
+    e.name = name;
+    e.value = value;
+    e.phase = phase;
+    if (text)
+        qstrncpy(e.text, text, sizeof(e.text));
+    else
+        e.text[0] = 0;
+
+    slot.sequence.storeRelease(index + 1);
+}
+
+void Trace::record(Trace::Phase phase, const char *category, const char *name, const QByteArray &text, qint64 value)
+{
+    record(phase, category, name, text.constData(), value);
+}
+
+void Trace::record(Trace::Phase phase, const char *category, const char *name, const QString &text, qint64 value)
+{
+    // no allocations: anything outside of ASCII is replaced
+    char buffer[sizeof(TraceEvent::text)];
+    int len = qMin(text.size(), int(sizeof(buffer)) - 1);
+    for (int i = 0; i < len; ++i) {
+        ushort u = text.at(i).unicode();
+        buffer[i] = (u >= 0x20 && u < 0x80) ? char(u) : '?';
+    }
+    buffer[len] = 0;
+    record(phase, category, name, buffer, value);
+}
+
+QByteArray Trace::toChromeJson()
+{
+    TraceRegistry *registry = traceRegistry();
+    if (!registry)
+        return QByteArray();
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray events;
+
+    QMutexLocker locker(&registry->mutex);
+    for (const TraceRing *ring : qAsConst(registry->rings)) {
+        if (!ring->threadName.isEmpty()) {
+            events.append(QJsonObject {
+                { qSL("ph"), qSL("M") },
+                { qSL("name"), qSL("thread_name") },
+                { qSL("pid"), pid },
+                { qSL("tid"), qint64(ring->threadId) },
+                { qSL("args"), QJsonObject { { qSL("name"), QString::fromUtf8(ring->threadName) } } }
+            });
+        }
+
+        // copy all completely written events, while the owning thread is still recording
+        QVector<QPair<quint64, TraceEvent>> copies;
+        copies.reserve(TraceRing::Size);
+        for (const TraceSlot &slot : ring->entries) {
+            quint64 before = slot.sequence.loadAcquire();
+            if (!before)
+                continue;
+            TraceEvent e = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load() == before)
+                copies.append(qMakePair(before, e));
+        }
+        std::sort(copies.begin(), copies.end(), [](const QPair<quint64, TraceEvent> &a,
+                                                   const QPair<quint64, TraceEvent> &b) {
+            return a.first < b.first;
+        });
+
+        for (const auto &copy : qAsConst(copies)) {
+            const TraceEvent &e = copy.second;
+            QJsonObject o {
+                { qSL("ph"), QString(QLatin1Char(e.phase)) },
+                { qSL("cat"), QString::fromLatin1(e.category) },
+                { qSL("name"), QString::fromLatin1(e.name) },
+                { qSL("ts"), double(e.timestamp) / 1000 }, // usecs
+                { qSL("pid"), pid },
+                { qSL("tid"), qint64(ring->threadId) }
+            };
+            if (e.phase == Instant)
+                o.insert(qSL("s"), qSL("t"));
+
+            QJsonObject args;
+            if (e.text[0])
+                args.insert(qSL("text"), QString::fromLatin1(e.text, int(qstrnlen(e.text, sizeof(e.text)))));
+            if (e.value)
+                args.insert(qSL("value"), e.value);
+            if (!args.isEmpty())
+                o.insert(qSL("args"), args);
+            events.append(o);
+        }
+    }
+    locker.unlock();
+
+    return QJsonDocument(QJsonObject {
+                             { qSL("traceEvents"), events },
+                             { qSL("displayTimeUnit"), qSL("ms") }
+                         }).toJson(QJsonDocument::Compact);
+}
+
+bool Trace::dump(const QString &fileName)
+{
+    QFile f(fileName);
+    if (!f.open(QFile::WriteOnly | QFile::Truncate)) {
+        qCWarning(LogSystem) << "WARNING: could not write the trace to" << fileName << ":" << f.errorString();
+        return false;
+    }
+    QByteArray json = toChromeJson();
+    return f.write(json) == json.size();
+}
+
+QT_END_NAMESPACE_AM
@@ -0,0 +1,110 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QByteArray>
+#include <QtAppManCommon/global.h>
+
+// Low-overhead tracing of the manager's hot paths: the events are recorded into a fixed-size,
+// lock-free ring buffer per thread and can be dumped as Chrome trace-event JSON (which can be
+// loaded into Perfetto or chrome://tracing).
+// The AM_TRACE_* macros are only compiled in when building with CONFIG+=enable-tracing.
+
+#if defined(AM_TRACING)
+#  define AM_TRACE_CONCAT2(a, b) a ## b
+#  define AM_TRACE_CONCAT(a, b) AM_TRACE_CONCAT2(a, b)
+   // records a begin event now and the matching end event when leaving the current scope
+#  define AM_TRACE_SCOPE(category, name, ...) \
+       QT_PREPEND_NAMESPACE_AM(TraceScope) AM_TRACE_CONCAT(amTraceScope, __LINE__)(category, name, ##__VA_ARGS__)
+#  define AM_TRACE_INSTANT(category, name, ...) \
+       QT_PREPEND_NAMESPACE_AM(Trace)::record(QT_PREPEND_NAMESPACE_AM(Trace)::Instant, category, name, ##__VA_ARGS__)
+#else
+#  define AM_TRACE_SCOPE(category, name, ...) do { } while (false)
+#  define AM_TRACE_INSTANT(category, name, ...) do { } while (false)
+#endif
+
+QT_BEGIN_NAMESPACE_AM
+
+class Trace
+{
+public:
+    enum Phase : char { Begin = 'B', End = 'E', Instant = 'i' };
+
+    // category and name have to be string literals: only the pointers are stored. The text
+    // is truncated to 30 ASCII characters, value is an arbitrary number (e.g. a pid or a state)
+    static void record(Phase phase, const char *category, const char *name,
+                       const char *text = nullptr, qint64 value = 0);
+    static void record(Phase phase, const char *category, const char *name,
+                       const QByteArray &text, qint64 value = 0);
+    static void record(Phase phase, const char *category, const char *name,
+                       const QString &text, qint64 value = 0);
+
+    // not real-time safe: takes a lock and allocates
+    static QByteArray toChromeJson();
+    static bool dump(const QString &fileName);
+};
+
+class TraceScope
+{
+public:
+    template <typename... Args>
+    TraceScope(const char *category, const char *name, const Args &... args)
+        : m_category(category)
+        , m_name(name)
+    {
+        Trace::record(Trace::Begin, category, name, args...);
+    }
+
+    ~TraceScope()
+    {
+        Trace::record(Trace::End, m_category, m_name);
+    }
+
+private:
+    const char *m_category;
+    const char *m_name;
+
+    Q_DISABLE_COPY(TraceScope)
+};
+
+QT_END_NAMESPACE_AM
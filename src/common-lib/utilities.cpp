@@ -437,6 +437,7 @@ QT_BEGIN_NAMESPACE_AM
 static bool printBacktrace;
 static bool dumpCore;
 static int waitForGdbAttach;
+static void (*crashCallback)() = nullptr;
 
 static char *demangleBuffer;
 static size_t demangleBufferSize;
@@ -453,6 +454,9 @@ static void crashHandler(const char *why)
 
     fprintf(stderr, "\n*** process %s (%d) crashed ***\n\n > why: %s\n", who, pid, why);
 
+    if (crashCallback)
+        crashCallback();
+
     if (printBacktrace) {
 #if defined(AM_USE_LIBBACKTRACE) && defined(BACKTRACE_SUPPORTED)
         struct btData {
@@ -691,6 +695,11 @@ void setCrashActionConfiguration(const QVariantMap &config)
     dumpCore = config.value(qSL("dumpCore"), dumpCore).toBool();
 }
 
+void setCrashCallback(void (*callback)())
+{
+    crashCallback = callback;
+}
+
 #else // Q_OS_LINUX
 
 void setCrashActionConfiguration(const QVariantMap &config)
@@ -698,6 +707,11 @@ void setCrashActionConfiguration(const QVariantMap &config)
     Q_UNUSED(config)
 }
 
+void setCrashCallback(void (*callback)())
+{
+    Q_UNUSED(callback)
+}
+
 #endif // !Q_OS_LINUX
 
 bool canOutputAnsiColors(int fd)
@@ -180,6 +180,8 @@ QString findOnSDCard(const QString &file);
 #endif
 
 void setCrashActionConfiguration(const QVariantMap &config);
+// the callback is run from within the crash handler, so it may only use async-signal-safe functions
+void setCrashCallback(void (*callback)());
 
 bool canOutputAnsiColors(int fd);
 
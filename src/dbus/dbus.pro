@@ -5,5 +5,6 @@ OTHER_FILES = \
     io.qt.applicationmanager.applicationinterface.xml \
     io.qt.applicationmanager.runtimeinterface.xml \
     io.qt.applicationmanager.xml \
+    io.qt.systemmonitor.xml \
     io.qt.windowmanager.xml \
     org.freedesktop.notifications.xml \
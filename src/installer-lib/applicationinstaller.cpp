@@ -42,6 +42,7 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QUuid>
+#include <QElapsedTimer>
 
 #include "application.h"
 #include "applicationinstaller.h"
@@ -54,6 +55,7 @@
 #include "global.h"
 #include "qml-utilities.h"
 #include "applicationmanager.h"
+#include "metricsexporter.h"
 
 
 #define AM_AUTHENTICATE_DBUS(RETURN_TYPE) \
@@ -203,6 +205,17 @@ ApplicationInstaller::ApplicationInstaller(const QVector<InstallationLocation> &
     d->installationLocations = installationLocations;
     d->manifestDir = manifestDir;
     d->imageMountDir = imageMountDir;
+
+    static const QVector<qreal> buckets { 0.5, 1, 2.5, 5, 10, 30, 60, 120, 300, 600 };
+    MetricsExporter *me = MetricsExporter::instance();
+    me->registerHistogram(qSL("am_installer_task_seconds"), qSL("Time from the start of an installer task until it finished or failed"), buckets);
+    me->registerHistogram(qSL("am_installer_extraction_seconds"), qSL("Time an installation task needed to extract and verify the package"), buckets);
+    me->registerGauge(qSL("am_installer_queued_tasks"), qSL("Installer tasks waiting to be executed"));
+    me->registerGauge(qSL("am_installer_active_tasks"), qSL("Installer tasks currently being executed"));
+    me->registerCollector(this, [this, me]() {
+        me->setGauge(qSL("am_installer_queued_tasks"), MetricsExporter::Labels(), d->taskQueue.size());
+        me->setGauge(qSL("am_installer_active_tasks"), MetricsExporter::Labels(), d->activeTasks.size());
+    });
 }
 
 ApplicationInstaller::~ApplicationInstaller()
@@ -290,6 +303,18 @@ bool ApplicationInstaller::enableApplicationUserIdSeparation(uint minUserId, uin
     return true;
 }
 
+int ApplicationInstaller::maxConcurrentTasks() const
+{
+    return d->maxConcurrentTasks;
+}
+
+// Download, extraction and verification of up to maxTasks packages can run in parallel
+void ApplicationInstaller::setMaxConcurrentTasks(int maxTasks)
+{
+    d->maxConcurrentTasks = qBound(1, maxTasks, 16);
+    triggerExecuteNextTask();
+}
+
 uint ApplicationInstaller::findUnusedUserId() const throw(Exception)
 {
     if (!isApplicationUserIdSeparationEnabled())
@@ -714,7 +739,7 @@ void ApplicationInstaller::acknowledgePackageInstallation(const QString &taskId)
     AM_AUTHENTICATE_DBUS(void)
 
     auto allTasks = d->taskQueue;
-    allTasks.append(d->activeTask);
+    allTasks.append(d->activeTasks);
 
     for (AsynchronousTask *task : qAsConst(allTasks)) {
         if (qobject_cast<InstallationTask *>(task) && (task->id() == taskId)) {
@@ -771,10 +796,10 @@ QString ApplicationInstaller::taskState(const QString &taskId)
     AM_AUTHENTICATE_DBUS(QString)
 
     auto allTasks = d->taskQueue;
-    allTasks.append(d->activeTask);
+    allTasks.append(d->activeTasks);
 
     for (const AsynchronousTask *task : qAsConst(allTasks)) {
-        if (task && (task->id() == taskId))
+        if (task->id() == taskId)
             return AsynchronousTask::stateToString(task->state());
     }
     return QString();
@@ -792,8 +817,10 @@ bool ApplicationInstaller::cancelTask(const QString &taskId)
     AM_TRACE(LogInstaller, taskId)
     AM_AUTHENTICATE_DBUS(bool)
 
-    if (d->activeTask && d->activeTask->id() == taskId)
-        return d->activeTask->cancel();
+    for (AsynchronousTask *task : qAsConst(d->activeTasks)) {
+        if (task->id() == taskId)
+            return task->cancel();
+    }
 
     foreach (AsynchronousTask *task, d->taskQueue) {
         if (task->id() == taskId) {
@@ -1021,10 +1048,22 @@ void ApplicationInstaller::triggerExecuteNextTask()
 
 void ApplicationInstaller::executeNextTask()
 {
-    if (d->activeTask || d->taskQueue.isEmpty())
+    if ((d->activeTasks.size() >= d->maxConcurrentTasks) || d->taskQueue.isEmpty())
         return;
 
-    AsynchronousTask *task = d->taskQueue.dequeue();
+    // tasks that know their application up front (deinstallations) claim it right here: they
+    // stay queued while another task is working on the same application
+    auto it = d->taskQueue.begin();
+    for ( ; it != d->taskQueue.end(); ++it) {
+        AsynchronousTask *t = *it;
+        if (t->hasFailed() || t->applicationId().isEmpty() || d->claimApplicationId(t, t->applicationId()))
+            break;
+    }
+    if (it == d->taskQueue.end())
+        return;
+
+    AsynchronousTask *task = *it;
+    d->taskQueue.erase(it);
 
     if (task->hasFailed()) {
         task->setState(AsynchronousTask::Failed);
@@ -1036,6 +1075,11 @@ void ApplicationInstaller::executeNextTask()
         return;
     }
 
+    // the task is started right after the connections below have been made
+    QElapsedTimer taskTimer;
+    taskTimer.start();
+    const QString taskType = qobject_cast<InstallationTask *>(task) ? qSL("installation") : qSL("deinstallation");
+
     connect(task, &AsynchronousTask::started, this, [this, task]() {
         emit taskStarted(task->id());
     });
@@ -1053,9 +1097,14 @@ void ApplicationInstaller::executeNextTask()
                                   Q_ARG(double, p));
     });
 
-    connect(task, &AsynchronousTask::finished, this, [this, task]() {
+    connect(task, &AsynchronousTask::finished, this, [this, task, taskTimer, taskType]() {
         task->setState(task->hasFailed() ? AsynchronousTask::Failed : AsynchronousTask::Finished);
 
+        MetricsExporter::instance()->observe(qSL("am_installer_task_seconds"),
+                                             { { qSL("type"), taskType },
+                                               { qSL("result"), task->hasFailed() ? qSL("failed") : qSL("finished") } },
+                                             qreal(taskTimer.elapsed()) / 1000);
+
         if (task->hasFailed()) {
             handleFailure(task);
         } else {
@@ -1063,25 +1112,31 @@ void ApplicationInstaller::executeNextTask()
             emit taskFinished(task->id());
         }
 
-        if (d->activeTask == task)
-            d->activeTask = 0;
+        d->activeTasks.removeOne(task);
 
         //task->deleteLater();
         delete task;
+        // the pointer is only used as a key here
+        d->releaseResources(task);
         triggerExecuteNextTask();
     });
 
     if (qobject_cast<InstallationTask *>(task)) {
-        connect(static_cast<InstallationTask *>(task), &InstallationTask::finishedPackageExtraction, this, [this, task]() {
+        connect(static_cast<InstallationTask *>(task), &InstallationTask::finishedPackageExtraction, this, [this, task, taskTimer]() {
+            MetricsExporter::instance()->observe(qSL("am_installer_extraction_seconds"), MetricsExporter::Labels(),
+                                                 qreal(taskTimer.elapsed()) / 1000);
             qCDebug(LogInstaller) << "emit blockingUntilInstallationAcknowledge" << task->id();
             emit taskBlockingUntilInstallationAcknowledge(task->id());
         });
     }
 
 
-    d->activeTask = task;
+    d->activeTasks.append(task);
     task->setState(AsynchronousTask::Executing);
     task->start();
+
+    // there might be room for more concurrent tasks
+    triggerExecuteNextTask();
 }
 
 void ApplicationInstaller::handleFailure(AsynchronousTask *task)
@@ -1091,6 +1146,63 @@ void ApplicationInstaller::handleFailure(AsynchronousTask *task)
 }
 
 
+// Fails right away, if another task has already claimed the application, unless a canceled
+// function is given: then it blocks until the claim is released or canceled() returns true
+// (see wakeApplicationIdWaiters()).
+bool ApplicationInstallerPrivate::claimApplicationId(const AsynchronousTask *task, const QString &id,
+                                                     const std::function<bool()> &canceled)
+{
+    QMutexLocker locker(&resourceLock);
+    forever {
+        const AsynchronousTask *owner = applicationIdClaims.value(id);
+        if (!owner || owner == task)
+            break;
+        if (!canceled || canceled())
+            return false;
+        applicationIdReleased.wait(&resourceLock);
+    }
+    applicationIdClaims.insert(id, task);
+    return true;
+}
+
+// Has to be called after a task waiting in claimApplicationId() has been canceled
+void ApplicationInstallerPrivate::wakeApplicationIdWaiters()
+{
+    QMutexLocker locker(&resourceLock);
+    applicationIdReleased.wakeAll();
+}
+
+// Reserves size bytes for task, if the space available on the installation location (minus
+// the reservations of all other tasks on this location) is big enough. Returns the space that
+// was left for the task in availableSize.
+bool ApplicationInstallerPrivate::reserveDiskSpace(const AsynchronousTask *task, const QString &installationLocationId,
+                                                   quint64 size, quint64 *availableSize)
+{
+    QMutexLocker locker(&resourceLock);
+    for (auto it = diskSpaceReservations.cbegin(); it != diskSpaceReservations.cend(); ++it) {
+        if ((it.key() != task) && (it->installationLocationId == installationLocationId))
+            *availableSize -= qMin(*availableSize, it->size);
+    }
+    if (*availableSize < size)
+        return false;
+    diskSpaceReservations.insert(task, { installationLocationId, size });
+    return true;
+}
+
+void ApplicationInstallerPrivate::releaseResources(const AsynchronousTask *task)
+{
+    QMutexLocker locker(&resourceLock);
+    for (auto it = applicationIdClaims.begin(); it != applicationIdClaims.end(); ) {
+        if (it.value() == task)
+            it = applicationIdClaims.erase(it);
+        else
+            ++it;
+    }
+    diskSpaceReservations.remove(task);
+    applicationIdReleased.wakeAll();
+}
+
+
 bool removeRecursiveHelper(const QString &path)
 {
     if (ApplicationInstaller::instance()->isApplicationUserIdSeparationEnabled() && SudoClient::instance())
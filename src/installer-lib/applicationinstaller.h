@@ -99,6 +99,9 @@ public:
 
     bool enableApplicationUserIdSeparation(uint minUserId, uint maxUserId, uint commonGroupId);
 
+    int maxConcurrentTasks() const;
+    void setMaxConcurrentTasks(int maxTasks);
+
     QDir manifestDirectory() const;
     QDir applicationImageMountDirectory() const;
 
@@ -41,7 +41,10 @@
 
 #pragma once
 
+#include <functional>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QMap>
 #include <QQueue>
 #include <QSet>
 #include <QThread>
@@ -76,7 +79,32 @@ public:
     QList<QByteArray> chainOfTrust;
 
     QQueue<AsynchronousTask *> taskQueue;
-    AsynchronousTask *activeTask = nullptr;
+    QList<AsynchronousTask *> activeTasks;
+    int maxConcurrentTasks = 1;
+
+    // concurrent tasks only serialize their final renames and the database update
+    QMutex finishLock;
+
+    // Concurrent tasks claim the application they are working on as well as the disk space they
+    // need on their installation location. Both are only released after the task (including
+    // its scoped clean-up helpers) has been deleted. Deinstallations claim their application
+    // before they are started, installations wait for the claim as soon as they know the id.
+    struct DiskSpaceReservation
+    {
+        QString installationLocationId;
+        quint64 size;
+    };
+    QMutex resourceLock;
+    QMap<QString, const AsynchronousTask *> applicationIdClaims;
+    QMap<const AsynchronousTask *, DiskSpaceReservation> diskSpaceReservations;
+    QWaitCondition applicationIdReleased;
+
+    bool claimApplicationId(const AsynchronousTask *task, const QString &id,
+                            const std::function<bool()> &canceled = std::function<bool()>());
+    void wakeApplicationIdWaiters();
+    bool reserveDiskSpace(const AsynchronousTask *task, const QString &installationLocationId,
+                          quint64 size, quint64 *availableSize);
+    void releaseResources(const AsynchronousTask *task);
 
     QMutex activationLock;
     QMap<QString, QString> activatedPackages; // id -> installationPath
@@ -43,6 +43,7 @@
 
 #include "global.h"
 #include "asynchronoustask.h"
+#include "trace.h"
 
 QT_BEGIN_NAMESPACE_AM
 
@@ -67,6 +68,7 @@ AsynchronousTask::State AsynchronousTask::state() const
 void AsynchronousTask::setState(AsynchronousTask::State state)
 {
     if (m_state != state) {
+        AM_TRACE_INSTANT("installer", "taskState", m_applicationId, state);
         m_state = state;
         emit stateChanged(m_state);
     }
@@ -130,6 +132,7 @@ void AsynchronousTask::setError(Error errorCode, const QString &errorString)
 
 void AsynchronousTask::run()
 {
+    AM_TRACE_SCOPE("installer", "executeTask", metaObject()->className());
     execute();
 }
 
@@ -71,8 +71,17 @@ void DeinstallationTask::execute()
     Q_ASSERT(m_installationLocation.isValid());
 
     bool managerApproval = false;
+    ApplicationInstallerPrivate *aiPrivate = ApplicationInstaller::instance()->d;
 
     try {
+        // concurrent tasks must never work on the same application: the claim has already been
+        // made when the task was dequeued (see ApplicationInstaller::executeNextTask())
+        if (!aiPrivate->claimApplicationId(this, m_app->id()))
+            throw Exception(Error::System, "the application %1 is already being installed or removed by another task").arg(m_app->id());
+
+        // the renames and the database update are serialized with the other concurrent tasks
+        QMutexLocker finishLocker(&aiPrivate->finishLock);
+
         // we need to call those ApplicationManager methods in the correct thread
         // this will also exclusively lock the application for us
         QMetaObject::invokeMethod(ApplicationManager::instance(),
@@ -82,6 +82,7 @@
   ======================
 
   PackageExtractor does its job
+  (delta packages: unchanged files are reflinked/copied from the installed version)
 
 
   Step 3 -- finishInstallation()
@@ -136,16 +137,21 @@ InstallationTask::~InstallationTask()
 
 bool InstallationTask::cancel()
 {
-    QMutexLocker locker(&m_mutex);
+    {
+        QMutexLocker locker(&m_mutex);
 
-    // we cannot cancel anymore after finishInstallation() has been called
-    if (m_installationAcknowledged)
-        return false;
+        // we cannot cancel anymore after finishInstallation() has been called
+        if (m_installationAcknowledged)
+            return false;
 
-    m_canceled = true;
-    if (m_extractor)
-        m_extractor->cancel();
-    m_installationAcknowledgeWaitCondition.wakeAll();
+        m_canceled = true;
+        if (m_extractor)
+            m_extractor->cancel();
+        m_installationAcknowledgeWaitCondition.wakeAll();
+    }
+    // we might be waiting for another task to release the application (m_mutex must not be
+    // locked here: claimApplicationId() locks it while holding the resourceLock)
+    m_ai->d->wakeApplicationIdWaiters();
     return true;
 }
 
@@ -226,7 +232,8 @@ void InstallationTask::execute()
 
         setState(Installing);
 
-        // if we would allow parallel installations - this would be the place to serialize them
+        // concurrent tasks only serialize the final renames and the database update
+        QMutexLocker finishLocker(&m_ai->d->finishLock);
 
         finishInstallation();
 
@@ -280,6 +287,11 @@ void InstallationTask::checkExtractedFile(const QString &file) throw(Exception)
         if (m_app->id() != m_extractor->installationReport().applicationId())
             throw Exception(Error::Package, "the application identifiers in --PACKAGE-HEADER--' and info.yaml do not match");
 
+        // concurrent tasks must never work on the same application: wait for the other task to
+        // finish, so that the checks below already see its result
+        if (!m_ai->d->claimApplicationId(this, m_app->id(), [this]() { QMutexLocker locker(&m_mutex); return m_canceled; }))
+            throw Exception(Error::Canceled, "canceled");
+
         InstallationLocation existingLocation = m_ai->installationLocationFromApplication(m_app->id());
 
         if (existingLocation.isValid() && (existingLocation != m_installationLocation)) {
@@ -287,6 +299,25 @@ void InstallationTask::checkExtractedFile(const QString &file) throw(Exception)
                 .arg(m_app->id(), m_installationLocation.id(), existingLocation.id());
         }
 
+        // delta packages take their unchanged files from the installed version, so we have to
+        // make sure that the exact version they were created against is available
+        if (m_extractor->isDeltaPackage()) {
+            QString baseVersion = m_extractor->deltaBaseVersion();
+
+            // the previous image would have to be mounted while the new one is being created
+            if (m_installationLocation.isRemovable())
+                throw Exception(Error::Package, "the delta package for %1 cannot be installed to the removable location %2")
+                    .arg(m_app->id(), m_installationLocation.id());
+            if (!existingLocation.isValid())
+                throw Exception(Error::Package, "the delta package for %1 needs version '%2' to be installed already")
+                    .arg(m_app->id(), baseVersion);
+
+            QScopedPointer<Application> installedApp(yas.scan(m_ai->manifestDirectory().absoluteFilePath(m_app->id() + qSL("/info.yaml"))));
+            if (installedApp->version() != baseVersion)
+                throw Exception(Error::Package, "the delta package for %1 needs version '%2' to be installed, but found version '%3'")
+                    .arg(m_app->id(), baseVersion, installedApp->version());
+        }
+
         m_app->m_builtIn = false;
         m_applicationId = m_app->id();
 
@@ -317,6 +348,12 @@ void InstallationTask::checkExtractedFile(const QString &file) throw(Exception)
             QMutexLocker locker(&m_mutex);
             m_extractor->setDestinationDirectory(m_extractionDir);
 
+            // delta packages take their unchanged files from the currently installed version.
+            // Hardlinks would also change the owner and permissions of the installed version
+            // (our backup, if the update fails), so we only allow them without uid separation
+            if (m_extractor->isDeltaPackage())
+                m_extractor->setReuseDirectory(m_applicationDir, !m_ai->isApplicationUserIdSeparationEnabled());
+
             QString path = m_extractionDir.absolutePath();
             path.chop(1); // remove the '+'
             m_app->setBaseDir(path); //TODO: this is not correct for Images!!!!
@@ -334,7 +371,11 @@ void InstallationTask::checkExtractedFile(const QString &file) throw(Exception)
             throw Exception(Error::System, "Application Manager declined the installation of %1").arg(m_app->id());
 
         // now that the Manager knows about the app object, we can try to find a free uid
-        m_app->m_uid = m_ai->findUnusedUserId();
+        {
+            // concurrent tasks must not end up with the same uid
+            QMutexLocker locker(&m_ai->d->resourceLock);
+            m_app->m_uid = m_ai->findUnusedUserId();
+        }
 
         // we're not interested in any other files from here on...
         m_extractor->setFileExtractedCallback(nullptr);
@@ -378,14 +419,7 @@ void InstallationTask::startInstallation() throw (Exception)
             throw Exception(Error::System, "could not create application image base directory %1").arg(installationDir);
 
         quint64 neededSize = qMax(m_extractor->installationReport().diskSpaceUsed(), quint64(70 * 1024));
-
-        quint64 availableSize = 0;
-        if (!diskUsage(installationDir.absolutePath(), 0, &availableSize) || availableSize < neededSize) {
-            throw Exception(Error::StorageSpace, "not enough storage space left on %1: %2 MB available, but %3 MB needed")
-                    .arg(m_installationLocation.id())
-                    .arg(double(availableSize) / (1024 * 1024), 0, 'f', 2)
-                    .arg(double(neededSize) / (1024 * 1024), 0, 'f', 2);
-        }
+        reserveDiskSpace(installationDir.absolutePath(), neededSize);
 
         m_extractionImageFile = installationDir.absoluteFilePath(installationTarget);
         m_applicationImageFile = installationDir.absoluteFilePath(m_applicationId + qSL(".appimg"));
@@ -420,6 +454,8 @@ void InstallationTask::startInstallation() throw (Exception)
     } else {
         if (!m_installationDirCreator.create(installationDir.absoluteFilePath(installationTarget)))
             throw Exception(Error::System, "could not create installation directory %1/%2").arg(installationDir).arg(installationTarget);
+        reserveDiskSpace(installationDir.absoluteFilePath(installationTarget),
+                         m_extractor->installationReport().diskSpaceUsed());
         m_extractionDir = installationDir;
         if (!m_extractionDir.cd(installationTarget))
             throw Exception(Error::System, "could not cd into installation directory %1/%2").arg(installationDir).arg(installationTarget);
@@ -427,6 +463,21 @@ void InstallationTask::startInstallation() throw (Exception)
     }
 }
 
+// Concurrent installations to the same location cannot overcommit its storage, since every
+// task has to reserve the space it needs. This is conservative: the files that other tasks have
+// already written are subtracted twice.
+void InstallationTask::reserveDiskSpace(const QString &path, quint64 neededSize) throw (Exception)
+{
+    quint64 availableSize = 0;
+    if (!diskUsage(path, 0, &availableSize)
+            || !m_ai->d->reserveDiskSpace(this, m_installationLocation.id(), neededSize, &availableSize)) {
+        throw Exception(Error::StorageSpace, "not enough storage space left on %1: %2 MB available, but %3 MB needed")
+                .arg(m_installationLocation.id())
+                .arg(double(availableSize) / (1024 * 1024), 0, 'f', 2)
+                .arg(double(neededSize) / (1024 * 1024), 0, 'f', 2);
+    }
+}
+
 void InstallationTask::finishInstallation() throw (Exception)
 {
     QDir documentDirectory(m_installationLocation.documentPath());
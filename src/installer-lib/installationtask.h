@@ -76,6 +76,7 @@ protected:
 
 private:
     void startInstallation() throw(Exception);
+    void reserveDiskSpace(const QString &path, quint64 neededSize) throw(Exception);
     void finishInstallation() throw(Exception);
     void checkExtractedFile(const QString &file) throw(Exception);
 
@@ -73,6 +73,11 @@ void AbstractContainer::setBaseDirectory(const QString &baseDirectory)
     m_baseDirectory = baseDirectory;
 }
 
+bool AbstractContainer::prepare()
+{
+    return true;
+}
+
 QString AbstractContainer::mapContainerPathToHost(const QString &containerPath) const
 {
     return containerPath;
@@ -88,6 +93,36 @@ AbstractContainerProcess *AbstractContainer::process() const
     return m_process;
 }
 
+QString AbstractContainer::accountingControlGroup() const
+{
+    return QString();
+}
+
+qint64 AbstractContainer::cpuTime() const
+{
+    return -1;
+}
+
+qint64 AbstractContainer::memoryUsage() const
+{
+    return -1;
+}
+
+bool AbstractContainer::ioCounters(quint64 *readBytes, quint64 *writtenBytes) const
+{
+    Q_UNUSED(readBytes)
+    Q_UNUSED(writtenBytes)
+    return false;
+}
+
+bool AbstractContainer::memoryStatistics(quint64 *anonymous, quint64 *file, quint64 *kernel) const
+{
+    Q_UNUSED(anonymous)
+    Q_UNUSED(file)
+    Q_UNUSED(kernel)
+    return false;
+}
+
 AbstractContainer::AbstractContainer(AbstractContainerManager *manager)
     : QObject(manager)
     , m_manager(manager)
@@ -122,6 +157,11 @@ bool AbstractContainerManager::supportsQuickLaunch() const
     return false;
 }
 
+bool AbstractContainerManager::supportsPreparation() const
+{
+    return false;
+}
+
 QVariantMap AbstractContainerManager::configuration() const
 {
     return m_configuration;
@@ -93,6 +93,7 @@ public:
 
     QString identifier() const;
     virtual bool supportsQuickLaunch() const;
+    virtual bool supportsPreparation() const;
 
     virtual AbstractContainer *create() = 0;
     virtual AbstractContainer *create(const ContainerDebugWrapper &debugWrapper) = 0;
@@ -140,6 +141,7 @@ public:
     virtual bool setProgram(const QString &program);
     virtual void setBaseDirectory(const QString &baseDirectory);
 
+    virtual bool prepare();
     virtual bool isReady() = 0;
 
     virtual QString mapContainerPathToHost(const QString &containerPath) const;
@@ -149,8 +151,17 @@ public:
 
     AbstractContainerProcess *process() const;
 
+    // the cgroup v2 (relative to the mount point) that only contains the container's processes:
+    // its interface files can be read on any thread, in contrast to the functions below
+    virtual QString accountingControlGroup() const;
+    virtual qint64 cpuTime() const;
+    virtual qint64 memoryUsage() const;
+    virtual bool ioCounters(quint64 *readBytes, quint64 *writtenBytes) const;
+    virtual bool memoryStatistics(quint64 *anonymous, quint64 *file, quint64 *kernel) const;
+
 signals:
     void ready();
+    void preparationFailed(const QString &errorString);
 
 protected:
     explicit AbstractContainer(AbstractContainerManager *manager);
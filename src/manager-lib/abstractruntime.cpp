@@ -113,6 +113,16 @@ bool AbstractRuntime::attachApplicationToQuickLauncher(const Application *app)
     return false;
 }
 
+void AbstractRuntime::terminate()
+{
+    stop(false);
+}
+
+void AbstractRuntime::kill()
+{
+    stop(true);
+}
+
 void AbstractRuntime::setInProcessQmlEngine(QQmlEngine *engine)
 {
     m_inProcessQmlEngine = engine;
@@ -125,6 +125,10 @@ public slots:
     virtual bool start() = 0;
     virtual void stop(bool forceKill = false) = 0;
 
+    // used by ApplicationManager::shutDown() to stop all runtimes in parallel
+    virtual void terminate();
+    virtual void kill();
+
 signals:
     void stateChanged(QT_PREPEND_NAMESPACE_AM(AbstractRuntime::State) newState);
     void finished(int exitCode, QProcess::ExitStatus status);
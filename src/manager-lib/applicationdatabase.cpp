@@ -48,6 +48,11 @@
 
 QT_BEGIN_NAMESPACE_AM
 
+// the serialization of Application objects is not versioned by itself, so the whole database
+// starts with a magic and a format version: bump the version, if the serialization changes
+static const quint32 DatabaseMagic = 0x414d4442; // 'AMDB'
+static const qint32 DatabaseFormatVersion = 2;   // 1 was the unversioned format without a header
+
 class ApplicationDatabasePrivate
 {
 public:
@@ -58,6 +63,14 @@ public:
     { }
     ~ApplicationDatabasePrivate()
     { delete file; }
+
+    bool hasValidHeader(QDataStream &ds)
+    {
+        quint32 magic = 0;
+        qint32 version = 0;
+        ds >> magic >> version;
+        return (ds.status() == QDataStream::Ok) && (magic == DatabaseMagic) && (version == DatabaseFormatVersion);
+    }
 };
 
 ApplicationDatabase::ApplicationDatabase(const QString &fileName)
@@ -89,6 +102,18 @@ bool ApplicationDatabase::isTemporary() const
     return qobject_cast<QTemporaryFile *>(d->file);
 }
 
+/*! \internal
+    Returns \c true, if the database was written in a different format and needs to be recreated.
+*/
+bool ApplicationDatabase::isOutdated() const
+{
+    if (!isValid() || !d->file->size() || !d->file->seek(0))
+        return false;
+
+    QDataStream ds(d->file);
+    return !d->hasValidHeader(ds);
+}
+
 QString ApplicationDatabase::errorString() const
 {
     return d->file->errorString();
@@ -103,9 +128,12 @@ QVector<const Application *> ApplicationDatabase::read() throw (Exception)
 {
     QVector<const Application *> apps;
 
-    if (d->file->seek(0)) {
+    if (d->file->size() && d->file->seek(0)) {
         QDataStream ds(d->file);
 
+        if (!d->hasValidHeader(ds))
+            throw Exception(Error::System, "application database %1 has an incompatible format").arg(d->file->fileName());
+
         forever {
             Application *app = Application::readFromDataStream(ds, apps);
 
@@ -131,6 +159,7 @@ void ApplicationDatabase::write(const QVector<const Application *> &apps) throw
         throw Exception(*d->file, "could not truncate the application database");
 
     QDataStream ds(d->file);
+    ds << DatabaseMagic << DatabaseFormatVersion;
     foreach (const Application *app, apps)
         app->writeToDataStream(ds, apps);
     if (ds.status() != QDataStream::Ok)
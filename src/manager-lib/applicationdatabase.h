@@ -60,6 +60,7 @@ public:
 
     bool isValid() const;
     bool isTemporary() const;
+    bool isOutdated() const;
     QString errorString() const;
     QString name() const;
 
@@ -57,6 +57,7 @@
 #include "application.h"
 #include "utilities.h"
 #include "dbus-utilities.h"
+#include "trace.h"
 #include "applicationipcinterface.h"
 #include "applicationipcinterface_p.h"
 
@@ -477,6 +478,7 @@ bool IpcProxyObject::handleMessage(const QDBusMessage &message, const QDBusConne
     QString interface = message.interface();
     QByteArray function = message.member().toLatin1();
     const QMetaObject *mo = m_object->metaObject();
+    AM_TRACE_SCOPE("ipc", "handleMessage", function);
 
     m_sender = m_connectionNamesToApplicationIds.value(connection.name());
     struct ClearSender {
@@ -45,7 +45,10 @@
 #include <QProcess>
 #include <QDir>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QSet>
 #include <QMimeDatabase>
+#include <QRegExp>
 #if defined(QT_GUI_LIB)
 #  include <QDesktopServices>
 #endif
@@ -58,11 +61,13 @@
 #include "runtimefactory.h"
 #include "containerfactory.h"
 #include "quicklauncher.h"
+#include "metricsexporter.h"
 #include "abstractruntime.h"
 #include "abstractcontainer.h"
 #include "dbus-policy.h"
 #include "qml-utilities.h"
 #include "utilities.h"
+#include "trace.h"
 #include "qtyaml.h"
 
 #if defined(Q_OS_UNIX)
@@ -166,11 +171,36 @@
         \li string
         \li The currently installed version of this application.
 
+    \row
+        \li \c restartCount
+        \li int
+        \li The number of times this application has been restarted automatically after it exited,
+            according to its restart policy.
+    \row
+        \li \c restartDelay
+        \li int
+        \li The back-off delay in milliseconds that was applied to the last automatic restart.
+
     \row
         \li \c application
         \li Application
         \li The underlying application object for quick access to the properties outside of a
             model delegate.
+
+    \row
+        \li \c memoryUsage
+        \li int
+        \li The memory in bytes that is charged to the application's control group (\c memory.current),
+            including all of its child processes. This is only available if the container places
+            the application into a control group of its own (see \c controlGroupPerProcess in the
+            \l {Container Configuration}) and is \c -1 otherwise. The value is updated on every
+            \l {SystemMonitor::reportingInterval} {reporting interval} of the SystemMonitor.
+    \row
+        \li \c memoryStatistics
+        \li object
+        \li The break-down of \c memoryUsage into \c anonymous, \c file (page cache) and \c kernel
+            memory in bytes, as found in the control group's \c memory.stat file. This object is
+            empty, if \c memoryUsage is not available.
     \endtable
 
     \note The index-based API is currently not available via DBus. However, the same functionality
@@ -266,6 +296,31 @@
     \endqml
 */
 
+/*!
+    \qmlsignal ApplicationManager::applicationRestartScheduled(string id, int delay)
+
+    This signal is emitted when the application identified by \a id exited and will be restarted
+    automatically after \a delay milliseconds, as requested by its \c restartPolicy. The delay
+    doubles with every consecutive restart, up to \e restart/maximumDelay.
+*/
+
+/*!
+    \qmlsignal ApplicationManager::applicationCrashLoopDetected(string id)
+
+    This signal is emitted when the application identified by \a id exited again after it has
+    already been restarted \e restart/maximumCount times in a row without running stable in
+    between. The application will not be restarted automatically anymore, until it is started
+    explicitly.
+*/
+
+/*!
+    \qmlsignal ApplicationManager::shutDownFinished(list<string> timedOutApplicationIds)
+
+    This signal is emitted when a shut-down requested via shutDown() has completed. The
+    \a timedOutApplicationIds list contains the ids of all applications that did not exit within
+    the given deadline and thus had to be killed; it is empty if all applications quit in time.
+*/
+
 enum Roles
 {
     Id = Qt::UserRole,
@@ -290,7 +345,11 @@ enum Roles
     Importance,
     Preload,
     Version,
-    ApplicationItem
+    RestartCount,
+    RestartDelay,
+    ApplicationItem,
+    MemoryUsage,
+    MemoryStatistics
 };
 
 QT_BEGIN_NAMESPACE_AM
@@ -313,8 +372,56 @@ public:
     QVector<IpcProxyObject *> interfaceExtensions;
 
     QVector<ContainerDebugWrapper> debugWrappers;
+    QVector<QPair<QString, QString>> containerSelection; // application id pattern -> container id
+
+    // coordinated shutdown of all applications
+    bool shuttingDown = false;
+    QHash<AbstractRuntime *, QString> shutDownPending;
+    QTimer *shutDownDeadline = nullptr;
+
+    // automatic restarts according to the application's restart policy
+    Application::RestartPolicy defaultRestartPolicy = Application::NeverRestart;
+    int restartInitialDelay = 500;     // msec
+    int restartMaximumDelay = 30000;   // msec
+    int restartMaximumCount = 5;       // consecutive restarts, before a crash loop is assumed
+    int restartStableTime = 60000;     // msec an application has to run to reset the back-off
+
+    struct RestartState
+    {
+        int consecutiveRestarts = 0;
+        bool stopRequested = false;
+        QElapsedTimer runTime;
+        QTimer *timer = nullptr;
+    };
+    QHash<QString, RestartState> restartStates; // non-aliased application id -> state
+
+    // launches that are still waiting for the first window of the application
+    struct PendingLaunch
+    {
+        QElapsedTimer timer;
+        MetricsExporter::Labels labels;
+    };
+    QHash<QString, PendingLaunch> pendingLaunches; // non-aliased application id -> launch
+
+    // memory usage of the applications' cgroups, sampled on the SystemMonitor's interval
+    struct MemoryUsage
+    {
+        qint64 used = -1;
+        qint64 anonymous = -1;
+        qint64 file = -1;
+        qint64 kernel = -1;
+
+        bool operator==(const MemoryUsage &other) const
+        {
+            return used == other.used && anonymous == other.anonymous
+                    && file == other.file && kernel == other.kernel;
+        }
+        bool operator!=(const MemoryUsage &other) const { return !(*this == other); }
+    };
+    QHash<QString, MemoryUsage> memoryUsage; // non-aliased application id -> usage
 
     ContainerDebugWrapper parseDebugWrapperSpecification(const QString &spec);
+    QString containerId(const Application *app) const;
 
     ApplicationManagerPrivate();
     ~ApplicationManagerPrivate();
@@ -344,7 +451,11 @@ ApplicationManagerPrivate::ApplicationManagerPrivate()
     roleNames.insert(Importance, "importance");
     roleNames.insert(Preload, "preload");
     roleNames.insert(Version, "version");
+    roleNames.insert(RestartCount, "restartCount");
+    roleNames.insert(RestartDelay, "restartDelay");
     roleNames.insert(ApplicationItem, "application");
+    roleNames.insert(MemoryUsage, "memoryUsage");
+    roleNames.insert(MemoryStatistics, "memoryStatistics");
 }
 
 ApplicationManagerPrivate::~ApplicationManagerPrivate()
@@ -418,6 +529,33 @@ ApplicationManager::ApplicationManager(ApplicationDatabase *adb, bool singleProc
     connect(this, &QAbstractItemModel::modelReset, this, &ApplicationManager::countChanged);
 
     QTimer::singleShot(0, this, &ApplicationManager::preload);
+
+    MetricsExporter *me = MetricsExporter::instance();
+    me->registerCounter(qSL("am_application_starts"), qSL("Applications started by the application-manager"));
+    me->registerCounter(qSL("am_application_exits"), qSL("Application exits by exit status"));
+    me->registerHistogram(qSL("am_application_launch_seconds"), qSL("Time from the start request until the first window of an application was mapped"),
+                          { 0.1, 0.25, 0.5, 0.75, 1, 1.5, 2, 3, 5, 10, 30 });
+    me->registerGauge(qSL("am_applications_running"), qSL("Number of running applications"));
+    me->registerGauge(qSL("am_application_cgroup_memory_bytes"), qSL("Memory charged to the cgroup of an application"));
+    me->registerCollector(this, [this, me]() {
+        int running = 0;
+        for (const Application *app : qAsConst(d->apps)) {
+            if (!app->isAlias() && app->currentRuntime() && (app->currentRuntime()->state() != AbstractRuntime::Inactive))
+                ++running;
+        }
+        me->setGauge(qSL("am_applications_running"), MetricsExporter::Labels(), running);
+
+        const QString memoryMetric = qSL("am_application_cgroup_memory_bytes");
+        me->clearSeries(memoryMetric);
+        for (auto it = d->memoryUsage.cbegin(); it != d->memoryUsage.cend(); ++it) {
+            if (it->anonymous < 0)
+                continue;
+            const QString &id = it.key();
+            me->setGauge(memoryMetric, { { qSL("app"), id }, { qSL("type"), qSL("anonymous") } }, it->anonymous);
+            me->setGauge(memoryMetric, { { qSL("app"), id }, { qSL("type"), qSL("file") } }, it->file);
+            me->setGauge(memoryMetric, { { qSL("app"), id }, { qSL("type"), qSL("kernel") } }, it->kernel);
+        }
+    });
 }
 
 ApplicationManager::~ApplicationManager()
@@ -484,6 +622,71 @@ void ApplicationManager::setDebugWrapperConfiguration(const QVariantList &debugW
     d->debugWrappers.append(internalDw);
 }
 
+void ApplicationManager::setRestartConfiguration(const QVariantMap &config)
+{
+    // Example:
+    //    restart:
+    //      policy: on-failure
+    //      initialDelay: 500
+    //      maximumDelay: 30000
+    //      maximumCount: 5
+    //      stableTime: 60000
+
+    bool ok;
+    Application::RestartPolicy policy = Application::restartPolicyFromString(config.value(qSL("policy")).toString(), &ok);
+    if (!ok)
+        qCWarning(LogSystem) << "Ignoring the invalid restart policy" << config.value(qSL("policy")).toString();
+    else if (policy != Application::DefaultRestart)
+        d->defaultRestartPolicy = policy;
+
+    d->restartInitialDelay = qMax(0, config.value(qSL("initialDelay"), d->restartInitialDelay).toInt());
+    d->restartMaximumDelay = qMax(d->restartInitialDelay, config.value(qSL("maximumDelay"), d->restartMaximumDelay).toInt());
+    d->restartMaximumCount = qMax(0, config.value(qSL("maximumCount"), d->restartMaximumCount).toInt());
+    d->restartStableTime = qMax(0, config.value(qSL("stableTime"), d->restartStableTime).toInt());
+}
+
+void ApplicationManager::setContainerSelectionConfiguration(const QVariantList &config)
+{
+    // Example:
+    //    containers:
+    //      selection:
+    //      - 'com.pelagicore.*': softwarecontainer
+    //      - '*': process
+
+    d->containerSelection.clear();
+    for (const QVariant &v : config) {
+        const QVariantMap map = v.toMap();
+        for (auto it = map.cbegin(); it != map.cend(); ++it)
+            d->containerSelection.append(qMakePair(it.key(), it.value().toString()));
+    }
+}
+
+/*! \internal
+    Returns the ids of all containers that applications can be started in, according to the
+    container selection configuration.
+*/
+QStringList ApplicationManager::selectableContainerIds() const
+{
+    QStringList ids;
+    for (const auto &selection : qAsConst(d->containerSelection)) {
+        if (!ids.contains(selection.second))
+            ids << selection.second;
+    }
+    if (!ids.contains(qSL("process")))
+        ids << qSL("process"); // the fallback for applications without a match
+    return ids;
+}
+
+QString ApplicationManagerPrivate::containerId(const Application *app) const
+{
+    const QString id = app->isAlias() ? app->nonAliased()->id() : app->id();
+    for (const auto &selection : containerSelection) {
+        if (QRegExp(selection.first, Qt::CaseSensitive, QRegExp::Wildcard).exactMatch(id))
+            return selection.second;
+    }
+    return qSL("process");
+}
+
 ContainerDebugWrapper ApplicationManagerPrivate::parseDebugWrapperSpecification(const QString &spec)
 {
     // Example:
@@ -669,10 +872,16 @@ bool ApplicationManager::startApplication(const Application *app, const QString
         qCWarning(LogSystem) << "Cannot start an invalid application";
         return false;
     }
+    AM_TRACE_SCOPE("am", "startApplication", app->id());
+
     if (app->isLocked()) {
         qCWarning(LogSystem) << "Application" << app->id() << "is blocked - cannot start";
         return false;
     }
+    if (d->shuttingDown) {
+        qCWarning(LogSystem) << "Application" << app->id() << "cannot be started while the application-manager is shutting down";
+        return false;
+    }
     AbstractRuntime *runtime = app->currentRuntime();
 
     ContainerDebugWrapper debugWrapper;
@@ -710,6 +919,9 @@ bool ApplicationManager::startApplication(const Application *app, const QString
         }
     }
 
+    QElapsedTimer launchTimer;
+    launchTimer.start();
+
     auto runtimeManager = RuntimeFactory::instance()->manager(app->runtimeName());
     if (!runtimeManager) {
         qCWarning(LogSystem) << "No RuntimeManager found for runtime:" << app->runtimeName();
@@ -718,7 +930,7 @@ bool ApplicationManager::startApplication(const Application *app, const QString
 
     bool inProcess = runtimeManager->inProcess();
     AbstractContainer *container = nullptr;
-    QString containerId = qSL("process"); //TODO: ask SystemUI or use config file
+    QString containerId = d->containerId(app);
     bool attachRuntime = false;
 
     if (debugWrapper.isValid()) {
@@ -760,6 +972,14 @@ bool ApplicationManager::startApplication(const Application *app, const QString
                     container = ContainerFactory::instance()->create(containerId, debugWrapper);
                 else
                     container = ContainerFactory::instance()->create(containerId);
+
+                // containers from the quick-launch pool have been prepared already (or are
+                // still being prepared), but new ones need to start their setup now
+                if (container && !container->prepare()) {
+                    qCCritical(LogSystem) << "ERROR: Couldn't prepare Container for Application (" << app->id() <<")!";
+                    delete container;
+                    return false;
+                }
             }
             if (!container) {
                 qCCritical(LogSystem) << "ERROR: Couldn't create Container for Application (" << app->id() <<")!";
@@ -782,13 +1002,15 @@ bool ApplicationManager::startApplication(const Application *app, const QString
         return false;
     }
 
-    connect(runtime, &AbstractRuntime::stateChanged, this, [this, app]() {
+    connect(runtime, &AbstractRuntime::stateChanged, this, [this, app, runtime]() {
+        Q_UNUSED(runtime) // only needed for the trace point, which might not be compiled in
+        AM_TRACE_INSTANT("runtime", "stateChanged", app->id(), runtime->state());
         emit applicationRunStateChanged(app->isAlias() ? app->nonAliased()->id() : app->id(),
                                         applicationRunState(app->id()));
     });
 
     connect(runtime, static_cast<void(AbstractRuntime::*)(int, QProcess::ExitStatus)>
-            (&AbstractRuntime::finished), this, [app](int code, QProcess::ExitStatus status) {
+            (&AbstractRuntime::finished), this, [this, app](int code, QProcess::ExitStatus status) {
         app->m_lastExitCode = code;
         if (status == QProcess::CrashExit) {
 #if defined(Q_OS_UNIX)
@@ -800,8 +1022,36 @@ bool ApplicationManager::startApplication(const Application *app, const QString
         } else {
             app->m_lastExitStatus = Application::NormalExit;
         }
+
+        static const char *exitStatusNames[] = { "normal", "crash", "forced" };
+        const QString nonAliasedId = app->isAlias() ? app->nonAliased()->id() : app->id();
+        d->pendingLaunches.remove(nonAliasedId);
+        MetricsExporter::instance()->incrementCounter(qSL("am_application_exits"),
+                                                      { { qSL("app"), nonAliasedId },
+                                                        { qSL("status"), qL1S(exitStatusNames[app->m_lastExitStatus]) } });
+        scheduleRestart(app->isAlias() ? app->nonAliased() : app,
+                        (app->m_lastExitStatus != Application::NormalExit) || (code != 0));
     });
 
+    {
+        ApplicationManagerPrivate::RestartState &rs = d->restartStates[app->isAlias() ? app->nonAliased()->id() : app->id()];
+        if (rs.timer)
+            rs.timer->stop();
+        rs.stopRequested = false;
+        rs.runTime.start();
+    }
+
+    {
+        const QString nonAliasedId = app->isAlias() ? app->nonAliased()->id() : app->id();
+        MetricsExporter::instance()->incrementCounter(qSL("am_application_starts"), { { qSL("app"), nonAliasedId } });
+
+        ApplicationManagerPrivate::PendingLaunch &launch = d->pendingLaunches[nonAliasedId];
+        launch.timer = launchTimer;
+        launch.labels = { { qSL("app"), nonAliasedId },
+                          { qSL("runtime"), app->runtimeName() },
+                          { qSL("quicklaunch"), attachRuntime ? qSL("true") : qSL("false") } };
+    }
+
     if (!documentUrl.isNull())
         runtime->openDocument(documentUrl);
     else if (!app->documentUrl().isNull())
@@ -818,6 +1068,7 @@ bool ApplicationManager::startApplication(const Application *app, const QString
         return ok;
     } else {
         auto f = [=]() {
+            AM_TRACE_SCOPE("am", "startRuntime", app->id());
             qCDebug(LogSystem) << "Container ready for app (" << app->id() <<")!";
             bool successfullyStarted = attachRuntime ? runtime->attachApplicationToQuickLauncher(app)
                                                      : runtime->start();
@@ -832,8 +1083,21 @@ bool ApplicationManager::startApplication(const Application *app, const QString
             return f();
         }
         else {
-            // We postpone the starting of the application to a later point in time since the container is not ready yet
-            connect(container, &AbstractContainer::ready, f);
+            // We postpone the starting of the application to a later point in time since the
+            // container is not ready yet: only the outstanding part of its preparation is waited for.
+            // The guard object makes sure that only one of the two signals is handled.
+            QObject *guard = new QObject(runtime);
+            connect(container, &AbstractContainer::ready, guard, [container, guard, f]() {
+                QObject::disconnect(container, nullptr, guard, nullptr);
+                guard->deleteLater();
+                f();
+            });
+            connect(container, &AbstractContainer::preparationFailed, guard, [container, guard, runtime, app](const QString &errorString) {
+                QObject::disconnect(container, nullptr, guard, nullptr);
+                guard->deleteLater();
+                qCCritical(LogSystem) << "ERROR: Couldn't prepare Container for Application (" << app->id() <<"):" << errorString;
+                runtime->deleteLater();
+            });
             return true;       // we return true for now, since we don't know at this point in time whether the container will be able to start the application. TODO : fix
         }
     }
@@ -843,13 +1107,87 @@ void ApplicationManager::stopApplication(const Application *app, bool forceKill)
 {
     if (!app)
         return;
+
+    auto it = d->restartStates.find(app->isAlias() ? app->nonAliased()->id() : app->id());
+    if (it != d->restartStates.end()) {
+        it->stopRequested = true;
+        if (it->timer)
+            it->timer->stop();
+    }
+
     AbstractRuntime *rt = app->currentRuntime();
     if (rt)
         rt->stop(forceKill);
 }
 
+/*! \internal
+    Called by the SystemMonitor on every reporting interval with the memory \a usage of the
+    applications' cgroups, which is read on its sampling thread. Applications that are missing
+    in \a usage have no cgroup of their own (anymore).
+*/
+void ApplicationManager::updateMemoryUsage(const QVariantMap &usage)
+{
+    QSet<QString> changedIds;
+
+    for (const Application *app : qAsConst(d->apps)) {
+        if (app->isAlias())
+            continue;
+
+        ApplicationManagerPrivate::MemoryUsage appUsage;
+        const QVariantMap sample = usage.value(app->id()).toMap();
+        if (!sample.isEmpty()) {
+            appUsage.used = sample.value(qSL("used")).toLongLong();
+            if (sample.contains(qSL("anonymous"))) {
+                appUsage.anonymous = sample.value(qSL("anonymous")).toLongLong();
+                appUsage.file = sample.value(qSL("file")).toLongLong();
+                appUsage.kernel = sample.value(qSL("kernel")).toLongLong();
+            }
+        }
+
+        auto it = d->memoryUsage.find(app->id());
+        if (it == d->memoryUsage.end()) {
+            if (appUsage == ApplicationManagerPrivate::MemoryUsage())
+                continue;
+            it = d->memoryUsage.insert(app->id(), appUsage);
+        } else if (*it == appUsage) {
+            continue;
+        } else {
+            *it = appUsage;
+        }
+        changedIds.insert(app->id());
+    }
+
+    if (changedIds.isEmpty())
+        return;
+    for (const Application *app : qAsConst(d->apps)) {
+        if (changedIds.contains(app->isAlias() ? app->nonAliased()->id() : app->id()))
+            emitDataChanged(app, QVector<int> { MemoryUsage, MemoryStatistics });
+    }
+}
+
+/*! \internal
+    Called by the WindowManager for every window that is mapped. The first window after a start
+    request completes the launch, which is then reported to the MetricsExporter.
+*/
+void ApplicationManager::applicationWindowMapped(const Application *app)
+{
+    if (!app)
+        return;
+    auto it = d->pendingLaunches.find(app->isAlias() ? app->nonAliased()->id() : app->id());
+    if (it == d->pendingLaunches.end())
+        return;
+    MetricsExporter::instance()->observe(qSL("am_application_launch_seconds"), it->labels,
+                                         qreal(it->timer.nsecsElapsed()) / 1000000000);
+    d->pendingLaunches.erase(it);
+}
+
 void ApplicationManager::killAll()
 {
+    for (auto it = d->restartStates.begin(); it != d->restartStates.end(); ++it) {
+        it->stopRequested = true;
+        if (it->timer)
+            it->timer->stop();
+    }
     for (const Application *app : qAsConst(d->apps)) {
         AbstractRuntime *rt = app->currentRuntime();
         if (rt)
@@ -858,6 +1196,170 @@ void ApplicationManager::killAll()
     QuickLauncher::instance()->killAll();
 }
 
+/*!
+    \qmlmethod ApplicationManager::shutDown(int timeout)
+
+    Stops all running applications in parallel: every application is asked to quit at the same
+    time and is then given \a timeout milliseconds in total to exit. All applications that are
+    still running after this single, global deadline are killed together.
+
+    The shutDownFinished() signal is emitted as soon as all applications have exited or the
+    deadline was reached. No applications can be started while a shut-down is in progress.
+
+    This is meant to be used by the System-UI right before it quits the application-manager,
+    e.g. when the device has a hard time budget for powering down.
+*/
+void ApplicationManager::shutDown(int timeout)
+{
+    if (d->shuttingDown)
+        return;
+    d->shuttingDown = true;
+
+    for (const ApplicationManagerPrivate::RestartState &rs : qAsConst(d->restartStates)) {
+        if (rs.timer)
+            rs.timer->stop();
+    }
+
+    // quick-launchers have no state to save, so there is no need for a grace period
+    QuickLauncher::instance()->killAll();
+
+    for (const Application *app : qAsConst(d->apps)) {
+        AbstractRuntime *rt = app->currentRuntime();
+        if (!rt || rt->state() == AbstractRuntime::Inactive || d->shutDownPending.contains(rt))
+            continue;
+
+        d->shutDownPending.insert(rt, app->isAlias() ? app->nonAliased()->id() : app->id());
+
+        connect(rt, static_cast<void(AbstractRuntime::*)(int, QProcess::ExitStatus)>(&AbstractRuntime::finished),
+                this, [this, rt]() { shutDownRuntimeFinished(rt); });
+        connect(rt, &QObject::destroyed,
+                this, [this, rt]() { shutDownRuntimeFinished(rt); });
+    }
+
+    qCDebug(LogSystem) << "Shutting down" << d->shutDownPending.size() << "application(s) with a timeout of"
+                       << timeout << "msec";
+
+    if (d->shutDownPending.isEmpty()) {
+        QTimer::singleShot(0, this, &ApplicationManager::shutDownDeadlineReached);
+        return;
+    }
+
+    if (!d->shutDownDeadline) {
+        d->shutDownDeadline = new QTimer(this);
+        d->shutDownDeadline->setSingleShot(true);
+        connect(d->shutDownDeadline, &QTimer::timeout, this, &ApplicationManager::shutDownDeadlineReached);
+    }
+    d->shutDownDeadline->start(qMax(0, timeout));
+
+    // the runtimes might remove themselves from the pending list while we are iterating
+    const auto runtimes = d->shutDownPending.keys();
+    for (AbstractRuntime *rt : runtimes)
+        rt->terminate();
+}
+
+bool ApplicationManager::isShuttingDown() const
+{
+    return d->shuttingDown;
+}
+
+void ApplicationManager::scheduleRestart(const Application *app, bool failed)
+{
+    ApplicationManagerPrivate::RestartState &rs = d->restartStates[app->id()];
+
+    bool stopRequested = rs.stopRequested;
+    rs.stopRequested = false;
+    if (stopRequested || d->shuttingDown)
+        return;
+
+    Application::RestartPolicy policy = app->restartPolicy();
+    if (policy == Application::DefaultRestart)
+        policy = d->defaultRestartPolicy;
+    if ((policy == Application::NeverRestart) || (policy == Application::RestartOnFailure && !failed))
+        return;
+
+    // an application that ran long enough is not part of a crash loop
+    if (rs.runTime.isValid() && rs.runTime.elapsed() >= d->restartStableTime)
+        rs.consecutiveRestarts = 0;
+
+    if (rs.consecutiveRestarts >= d->restartMaximumCount) {
+        qCWarning(LogSystem) << "WARNING: application" << app->id() << "exited" << (rs.consecutiveRestarts + 1)
+                             << "times in a row - giving up on restarting it";
+        rs.consecutiveRestarts = 0;
+        emit applicationCrashLoopDetected(app->id());
+        return;
+    }
+
+    // exponential back-off: initialDelay * 2^n, capped at maximumDelay
+    qint64 delay = d->restartInitialDelay;
+    for (int i = 0; i < rs.consecutiveRestarts && delay < d->restartMaximumDelay; ++i)
+        delay *= 2;
+    delay = qMin(delay, qint64(d->restartMaximumDelay));
+
+    ++rs.consecutiveRestarts;
+    ++app->m_restartCount;
+    app->m_restartDelay = int(delay);
+
+    if (!rs.timer) {
+        rs.timer = new QTimer(this);
+        rs.timer->setSingleShot(true);
+        const QString id = app->id();
+        connect(rs.timer, &QTimer::timeout, this, [this, id]() { restartApplication(id); });
+    }
+    rs.timer->start(int(delay));
+
+    qCDebug(LogSystem) << "Restarting application" << app->id() << "in" << delay << "msec (restart #"
+                       << app->m_restartCount << ")";
+
+    emitDataChanged(app, QVector<int> { RestartCount, RestartDelay });
+    emit applicationRestartScheduled(app->id(), int(delay));
+}
+
+void ApplicationManager::restartApplication(const QString &id)
+{
+    const Application *app = fromId(id);
+    if (!app || d->shuttingDown)
+        return;
+
+    if (app->currentRuntime()) {
+        // the old runtime has not been deleted yet: any explicit start would have stopped the timer.
+        // Try again after the back-off delay instead of spinning on the event loop
+        d->restartStates[id].timer->start(qMax(1, app->restartDelay()));
+        return;
+    }
+
+    // startApplication() will pick up a ready quick-launcher, if one is available
+    if (!startApplication(app))
+        qCWarning(LogSystem) << "WARNING: could not restart application" << id;
+}
+
+void ApplicationManager::shutDownRuntimeFinished(AbstractRuntime *runtime)
+{
+    if (!d->shutDownPending.remove(runtime) || !d->shutDownPending.isEmpty())
+        return;
+
+    if (d->shutDownDeadline && d->shutDownDeadline->isActive()) {
+        d->shutDownDeadline->stop();
+        shutDownDeadlineReached();
+    }
+}
+
+void ApplicationManager::shutDownDeadlineReached()
+{
+    QStringList timedOut = d->shutDownPending.values();
+    timedOut.sort();
+
+    if (!timedOut.isEmpty()) {
+        qCWarning(LogSystem) << "WARNING: the following applications did not quit within the shut-down deadline and will be killed:"
+                             << timedOut;
+
+        const auto runtimes = d->shutDownPending.keys();
+        d->shutDownPending.clear();
+        for (AbstractRuntime *rt : runtimes)
+            rt->kill();
+    }
+    emit shutDownFinished(timedOut);
+}
+
 /*!
     \qmlmethod bool ApplicationManager::startApplication(string id, string document)
 
@@ -1322,8 +1824,24 @@ QVariant ApplicationManager::data(const QModelIndex &index, int role) const
         return app->isPreloaded();
     case Version:
         return app->version();
+    case RestartCount:
+        return app->restartCount();
+    case RestartDelay:
+        return app->restartDelay();
     case ApplicationItem:
         return QVariant::fromValue(app);
+    case MemoryUsage:
+        return d->memoryUsage.value(app->isAlias() ? app->nonAliased()->id() : app->id()).used;
+    case MemoryStatistics: {
+        const auto usage = d->memoryUsage.value(app->isAlias() ? app->nonAliased()->id() : app->id());
+        QVariantMap map;
+        if (usage.anonymous >= 0) {
+            map[qSL("anonymous")] = usage.anonymous;
+            map[qSL("file")] = usage.file;
+            map[qSL("kernel")] = usage.kernel;
+        }
+        return map;
+    }
     }
     return QVariant();
 }
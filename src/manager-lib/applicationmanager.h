@@ -98,6 +98,9 @@ public:
     void setAdditionalConfiguration(const QVariantMap &map);
 
     void setDebugWrapperConfiguration(const QVariantList &debugWrappers);
+    void setRestartConfiguration(const QVariantMap &config);
+    void setContainerSelectionConfiguration(const QVariantList &config);
+    QStringList selectableContainerIds() const;
 
     QVector<const Application *> applications() const;
 
@@ -109,7 +112,11 @@ public:
 
     bool startApplication(const Application *app, const QString &documentUrl = QString(), const QString &debugWrapperSpecification = QString(), const QVector<int> &stdRedirections = QVector<int>());
     void stopApplication(const Application *app, bool forceKill = false);
+    void applicationWindowMapped(const Application *app);
+    void updateMemoryUsage(const QVariantMap &usage);
     void killAll();
+    Q_INVOKABLE void shutDown(int timeout);
+    bool isShuttingDown() const;
 
     // only use these two functions for development!
     bool securityChecksEnabled() const;
@@ -156,6 +163,11 @@ signals:
 
     void memoryLowWarning();
 
+    Q_SCRIPTABLE void applicationRestartScheduled(const QString &id, int delay);
+    Q_SCRIPTABLE void applicationCrashLoopDetected(const QString &id);
+
+    void shutDownFinished(const QStringList &timedOutApplicationIds);
+
 private slots:
     void preload();
     void openUrlRelay(const QUrl &url);
@@ -179,6 +191,10 @@ private slots:
 private:
     void emitDataChanged(const Application *app, const QVector<int> &roles = QVector<int>());
     void registerMimeTypes();
+    void scheduleRestart(const Application *app, bool failed);
+    void restartApplication(const QString &id);
+    void shutDownRuntimeFinished(AbstractRuntime *runtime);
+    void shutDownDeadlineReached();
 
     ApplicationManager(ApplicationDatabase *adb, bool singleProcess, QObject *parent = nullptr);
     ApplicationManager(const ApplicationManager &);
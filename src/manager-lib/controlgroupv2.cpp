@@ -0,0 +1,323 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include "global.h"
+#include "controlgroupv2.h"
+
+#include <sys/vfs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#if !defined(CGROUP2_SUPER_MAGIC)
+#  define CGROUP2_SUPER_MAGIC 0x63677270
+#endif
+
+QT_BEGIN_NAMESPACE_AM
+
+bool ControlGroupV2::isAvailable()
+{
+    // this is called from the sampling thread as well: the initialization is thread-safe
+    static const bool available = []() {
+        struct statfs sfs;
+        return (::statfs(QFile::encodeName(mountPoint()).constData(), &sfs) == 0)
+                && (sfs.f_type == CGROUP2_SUPER_MAGIC);
+    }();
+    return available;
+}
+
+static QString s_mountPoint = qSL("/sys/fs/cgroup");
+
+QString ControlGroupV2::mountPoint()
+{
+    return s_mountPoint;
+}
+
+void ControlGroupV2::setMountPoint(const QString &mountPoint)
+{
+    s_mountPoint = mountPoint;
+}
+
+/*! \internal
+    Returns the cgroup of the application-manager itself, relative to the cgroup2 mount point.
+    This is the subtree that was delegated to us (e.g. by systemd) and the only place where we
+    are allowed to create our own cgroups.
+*/
+QString ControlGroupV2::ownPath()
+{
+    static QString path;
+    static bool once = false;
+    if (!once) {
+        QFile f(qSL("/proc/self/cgroup"));
+        if (f.open(QFile::ReadOnly)) {
+            // the unified hierarchy is the one with the id 0 and no controller list: "0::/path"
+            foreach (const QByteArray &line, f.readAll().split('\n')) {
+                if (line.startsWith("0::")) {
+                    path = QString::fromLocal8Bit(line.mid(3).trimmed());
+                    while (path.startsWith(qL1C('/')))
+                        path.remove(0, 1);
+                    break;
+                }
+            }
+        }
+        once = true;
+    }
+    return path;
+}
+
+// Returns the controllers needed for the interface files (e.g. "cpu" for cpu.weight)
+QStringList ControlGroupV2::controllers(const QVariantMap &interfaceFiles)
+{
+    QStringList controllers;
+    for (auto it = interfaceFiles.cbegin(); it != interfaceFiles.cend(); ++it) {
+        QString controller = it.key().section(qL1C('.'), 0, 0);
+        if (!controller.startsWith(qSL("cgroup")) && !controllers.contains(controller))
+            controllers << controller;
+    }
+    return controllers;
+}
+
+/*! \internal
+    Creates the cgroup \a path including all its parents and enables the controllers needed for
+    the \a interfaceFiles (e.g. \c cpu.weight or \c memory.max) in all ancestors. Afterwards
+    the \a interfaceFiles are written to the new cgroup.
+    The \a subtreeControllers are additionally enabled for the children of the new cgroup (and
+    therefore in all ancestors as well).
+*/
+bool ControlGroupV2::create(const QString &path, const QVariantMap &interfaceFiles,
+                            const QStringList &subtreeControllers)
+{
+    QDir root(mountPoint());
+    if (!root.mkpath(path)) {
+        qCWarning(LogSystem) << "Could not create the cgroup" << path;
+        return false;
+    }
+
+    QStringList controllers = ControlGroupV2::controllers(interfaceFiles);
+    for (const QString &controller : subtreeControllers) {
+        if (!controllers.contains(controller))
+            controllers << controller;
+    }
+
+    // the controllers have to be enabled top-down in the subtree_control of each ancestor
+    if (!controllers.isEmpty()) {
+        const QStringList parts = path.split(qL1C('/'), QString::SkipEmptyParts);
+        QString parent;
+        for (int i = 0; i < parts.size(); ++i) {
+            if (!enableControllers(parent, controllers))
+                return false;
+            parent = parent.isEmpty() ? parts.at(i) : parent + qL1C('/') + parts.at(i);
+        }
+    }
+
+    bool ok = subtreeControllers.isEmpty() || enableControllers(path, subtreeControllers);
+    for (auto it = interfaceFiles.cbegin(); it != interfaceFiles.cend(); ++it)
+        ok = writeFile(path, it.key(), it.value().toString().toLatin1()) && ok;
+    return ok;
+}
+
+bool ControlGroupV2::remove(const QString &path)
+{
+    // only possible if there are no processes and no children left in this cgroup
+    return QDir(mountPoint()).rmdir(path);
+}
+
+bool ControlGroupV2::addProcess(const QString &path, qint64 pid)
+{
+    return writeFile(path, qSL("cgroup.procs"), QByteArray::number(pid));
+}
+
+/*! \internal
+    Moves all processes of the cgroup \a fromPath to the cgroup \a toPath. Controllers can only
+    be enabled for the children of a cgroup, if the cgroup itself does not contain any processes.
+*/
+bool ControlGroupV2::moveAllProcesses(const QString &fromPath, const QString &toPath)
+{
+    bool ok = true;
+    foreach (const QByteArray &pid, readFile(fromPath, qSL("cgroup.procs")).simplified().split(' ')) {
+        if (!pid.isEmpty())
+            ok = writeFile(toPath, qSL("cgroup.procs"), pid) && ok;
+    }
+    return ok;
+}
+
+/*! \internal
+    Returns a file descriptor for the cgroup \a path, that can be used with \c clone3()'s
+    \c CLONE_INTO_CGROUP. The caller has to close it.
+*/
+int ControlGroupV2::openDirectory(const QString &path)
+{
+    QByteArray fullPath = QFile::encodeName(mountPoint() + qL1C('/') + path);
+    int fd = ::open(fullPath.constData(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        qCWarning(LogSystem) << "Could not open the cgroup" << path << ":" << strerror(errno);
+    return fd;
+}
+
+QByteArray ControlGroupV2::readFile(const QString &path, const QString &file)
+{
+    QFile f(mountPoint() + qL1C('/') + path + qL1C('/') + file);
+    if (!f.open(QFile::ReadOnly))
+        return QByteArray();
+    return f.readAll();
+}
+
+// Returns the value of \a key in a "flat keyed" interface file (e.g. cpu.stat) or -1
+qint64 ControlGroupV2::keyedValue(const QByteArray &content, const QByteArray &key)
+{
+    int pos = 0;
+    while (pos < content.size()) {
+        int eol = content.indexOf('\n', pos);
+        if (eol < 0)
+            eol = content.size();
+        if ((pos + key.size() < eol) && (content.at(pos + key.size()) == ' ')
+                && !qstrncmp(content.constData() + pos, key.constData(), key.size())) {
+            bool ok;
+            qint64 value = content.mid(pos + key.size() + 1, eol - pos - key.size() - 1).trimmed().toLongLong(&ok);
+            return ok ? value : -1;
+        }
+        pos = eol + 1;
+    }
+    return -1;
+}
+
+bool ControlGroupV2::enableControllers(const QString &path, const QStringList &controllers)
+{
+    QFile available(mountPoint() + qL1C('/') + path + qSL("/cgroup.controllers"));
+    QFile enabled(mountPoint() + qL1C('/') + path + qSL("/cgroup.subtree_control"));
+    if (!available.open(QFile::ReadOnly) || !enabled.open(QFile::ReadOnly)) {
+        qCWarning(LogSystem) << "Could not read the available controllers of the cgroup" << path;
+        return false;
+    }
+    const QList<QByteArray> availableList = available.readAll().simplified().split(' ');
+    const QList<QByteArray> enabledList = enabled.readAll().simplified().split(' ');
+    enabled.close();
+
+    QByteArray change;
+    for (const QString &controller : controllers) {
+        QByteArray c = controller.toLatin1();
+        if (enabledList.contains(c))
+            continue;
+        if (!availableList.contains(c)) {
+            qCWarning(LogSystem) << "The cgroup controller" << controller << "is not available in" << path;
+            continue;
+        }
+        change.append('+').append(c).append(' ');
+    }
+    return change.isEmpty() || writeFile(path, qSL("cgroup.subtree_control"), change.trimmed());
+}
+
+qint64 ControlGroupV2::cpuTime(const QString &path)
+{
+    return keyedValue(readFile(path, qSL("cpu.stat")), "usage_usec");
+}
+
+qint64 ControlGroupV2::memoryUsage(const QString &path)
+{
+    bool ok;
+    qint64 value = readFile(path, qSL("memory.current")).trimmed().toLongLong(&ok);
+    return ok ? value : -1;
+}
+
+bool ControlGroupV2::ioCounters(const QString &path, quint64 *readBytes, quint64 *writtenBytes)
+{
+    QByteArray ioStat = readFile(path, qSL("io.stat"));
+    if (ioStat.isNull())
+        return false;
+
+    // one line per device: "<major>:<minor> rbytes=<n> wbytes=<n> rios=<n> ..."
+    quint64 r = 0, w = 0;
+    foreach (const QByteArray &line, ioStat.split('\n')) {
+        foreach (const QByteArray &field, line.split(' ')) {
+            if (field.startsWith("rbytes="))
+                r += field.mid(7).toULongLong();
+            else if (field.startsWith("wbytes="))
+                w += field.mid(7).toULongLong();
+        }
+    }
+    if (readBytes)
+        *readBytes = r;
+    if (writtenBytes)
+        *writtenBytes = w;
+    return true;
+}
+
+bool ControlGroupV2::memoryStatistics(const QString &path, quint64 *anonymous, quint64 *file, quint64 *kernel)
+{
+    QByteArray memoryStat = readFile(path, qSL("memory.stat"));
+    qint64 a = keyedValue(memoryStat, "anon");
+    qint64 f = keyedValue(memoryStat, "file");
+    if (a < 0 || f < 0)
+        return false;
+
+    // the "kernel" sum is only available since Linux 5.18
+    qint64 k = keyedValue(memoryStat, "kernel");
+    if (k < 0) {
+        static const char *kernelKeys[] = { "kernel_stack", "pagetables", "percpu", "sock", "slab" };
+        k = 0;
+        for (const char *key : kernelKeys)
+            k += qMax(Q_INT64_C(0), keyedValue(memoryStat, key));
+    }
+    if (anonymous)
+        *anonymous = quint64(a);
+    if (file)
+        *file = quint64(f);
+    if (kernel)
+        *kernel = quint64(k);
+    return true;
+}
+
+bool ControlGroupV2::writeFile(const QString &path, const QString &file, const QByteArray &value)
+{
+    QFile f(mountPoint() + qL1C('/') + path + qL1C('/') + file);
+    if (!f.open(QFile::WriteOnly | QFile::Unbuffered) || (f.write(value) != value.size())) {
+        qCWarning(LogSystem) << "Could not write" << value << "to" << f.fileName() << ":" << f.errorString();
+        return false;
+    }
+    return true;
+}
+
+QT_END_NAMESPACE_AM
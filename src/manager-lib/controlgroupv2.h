@@ -0,0 +1,83 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QString>
+#include <QVariantMap>
+#include <QtAppManCommon/global.h>
+
+QT_BEGIN_NAMESPACE_AM
+
+// Helper functions for the cgroup v2 "unified hierarchy". All paths are relative to the
+// cgroup2 mount point.
+class ControlGroupV2
+{
+public:
+    static bool isAvailable();
+    static QString mountPoint();
+    static void setMountPoint(const QString &mountPoint); // a fake hierarchy for the unit tests
+    static QString ownPath();
+
+    static QStringList controllers(const QVariantMap &interfaceFiles);
+    static bool create(const QString &path, const QVariantMap &interfaceFiles = QVariantMap(),
+                       const QStringList &subtreeControllers = QStringList());
+    static bool remove(const QString &path);
+    static bool addProcess(const QString &path, qint64 pid);
+    static bool moveAllProcesses(const QString &fromPath, const QString &toPath);
+    static int openDirectory(const QString &path);
+
+    static QByteArray readFile(const QString &path, const QString &file);
+    static qint64 keyedValue(const QByteArray &content, const QByteArray &key);
+
+    static bool enableControllers(const QString &path, const QStringList &controllers);
+
+    // the accounting of all the processes in a cgroup: these can be used on any thread
+    static qint64 cpuTime(const QString &path);
+    static qint64 memoryUsage(const QString &path);
+    static bool ioCounters(const QString &path, quint64 *readBytes, quint64 *writtenBytes);
+    static bool memoryStatistics(const QString &path, quint64 *anonymous, quint64 *file, quint64 *kernel);
+
+private:
+    static bool writeFile(const QString &path, const QString &file, const QByteArray &value);
+};
+
+QT_END_NAMESPACE_AM
@@ -0,0 +1,463 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#include <QDebug>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include "global.h"
+#include "cpumonitor.h"
+#include "spscqueue.h"
+
+#if defined(Q_OS_LINUX)
+#  include <QDir>
+#  include <QFile>
+#  include <unistd.h>
+#  include "sysfsreader.h"
+#endif
+
+QT_BEGIN_NAMESPACE_AM
+
+namespace {
+// All counters are deltas for the last reporting interval
+enum Roles {
+    CpuLoad = Qt::UserRole + 1,
+    MinorPageFaults,
+    MajorPageFaults,
+    VoluntaryContextSwitches,
+    InvoluntaryContextSwitches
+};
+
+#if defined(Q_OS_LINUX)
+static QByteArray readProcFile(const QString &path)
+{
+    QFile f(path);
+    return f.open(QFile::ReadOnly) ? f.readAll() : QByteArray();
+}
+
+// Returns the fields of a /proc/<pid>/stat file, starting at field 3 ("state"): the command name
+// in field 2 can contain spaces and parentheses, so we have to skip to the last ')'.
+static QList<QByteArray> statFields(const QByteArray &stat)
+{
+    int pos = stat.lastIndexOf(')');
+    if (pos < 0)
+        return QList<QByteArray>();
+    return stat.mid(pos + 2).split(' ');
+}
+
+static qint64 ticksToUsec(qint64 ticks)
+{
+    static const qint64 ticksPerSecond = sysconf(_SC_CLK_TCK);
+    return ticks * 1000000 / ticksPerSecond;
+}
+
+static QStringList taskIds(quint64 pid)
+{
+    return QDir(qSL("/proc/%1/task").arg(pid)).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+}
+#endif
+}
+
+class CpuMonitorPrivate
+{
+public:
+    CpuMonitorPrivate(CpuMonitor *q)
+        : q_ptr(q)
+    { }
+
+    CpuMonitor *q_ptr;
+    Q_DECLARE_PUBLIC(CpuMonitor)
+
+    struct CpuSample {
+        qreal cpuLoad = 0;
+        quint64 minorPageFaults = 0;
+        quint64 majorPageFaults = 0;
+        quint64 voluntaryContextSwitches = 0;
+        quint64 involuntaryContextSwitches = 0;
+    };
+    QVector<CpuSample> samples;
+
+    struct Counters {
+        qint64 cpuTime = -1; // usec
+        quint64 minorPageFaults = 0;
+        quint64 majorPageFaults = 0;
+        quint64 voluntaryContextSwitches = 0;
+        quint64 involuntaryContextSwitches = 0;
+    };
+    Counters m_last;
+
+    QHash<int, QByteArray> m_roles;
+
+    // the container's CPU time is read on the GUI thread
+    qint64 m_lastContainerCpuTime = -1;
+    QElapsedTimer m_containerElapsed;
+
+    // everything below is owned by the sampling thread, unless m_sampleMutex is locked
+    QMutex m_sampleMutex;
+    QAtomicInteger<quint64> m_requestedPid;
+    SpscQueue<CpuSample, 8> m_samples; // sampling thread -> GUI thread
+    quint64 m_pid = 0;
+    QElapsedTimer m_elapsed;
+
+    QHash<quint64, qint64> m_lastThreadTimes; // tid -> usec
+    QElapsedTimer m_threadElapsed;
+
+    int m_reportPos = 0;
+    int modelSize = 25;
+
+    const CpuSample &sampleForRow(int row) const
+    {
+        // convert a visual row position to an index into the internal ringbuffer
+
+        int pos = row + m_reportPos;
+        if (pos >= samples.size())
+            pos -= samples.size();
+
+        if (pos < 0 || pos >= samples.size())
+            return samples.first();
+        return samples.at(pos);
+    }
+
+    void updatePid(quint64 pid)
+    {
+        if (m_pid == pid)
+            return;
+        m_pid = pid;
+        m_last = Counters();
+        m_elapsed.invalidate();
+        m_lastThreadTimes.clear();
+        m_threadElapsed.invalidate();
+    }
+
+    void updateModel()
+    {
+        Q_Q(CpuMonitor);
+
+        const bool resized = (samples.size() != modelSize);
+
+        q->beginResetModel();
+        samples.resize(modelSize);
+        q->endResetModel();
+        if (resized)
+            emit q->countChanged();
+    }
+
+#if defined(Q_OS_LINUX)
+    Counters readCounters(ProcFsPrefetcher *prefetched) const
+    {
+        Counters c;
+        const QVector<quint64> pids = prefetched ? prefetched->processTree(m_pid) : processTree(m_pid);
+        foreach (quint64 pid, pids) {
+            const QByteArray stat = prefetched ? prefetched->read(pid, ProcFsPrefetcher::Stat)
+                                               : readProcFile(qSL("/proc/%1/stat").arg(pid));
+            const QList<QByteArray> fields = statFields(stat);
+            if (fields.size() <= 14)
+                continue;
+
+            // utime + stime + the times of all children that already have been waited for
+            qint64 ticks = fields.at(11).toLongLong() + fields.at(12).toLongLong()
+                    + fields.at(13).toLongLong() + fields.at(14).toLongLong();
+            c.cpuTime = qMax(c.cpuTime, qint64(0)) + ticksToUsec(ticks);
+            c.minorPageFaults += fields.at(7).toULongLong();
+            c.majorPageFaults += fields.at(9).toULongLong();
+
+            // the context switches in /proc/<pid>/status are only counted for the main thread
+            foreach (const QString &tid, taskIds(pid)) {
+                const QByteArray status = readProcFile(qSL("/proc/%1/task/%2/status").arg(pid).arg(tid));
+                foreach (const QByteArray &line, status.split('\n')) {
+                    if (line.startsWith("voluntary_ctxt_switches:"))
+                        c.voluntaryContextSwitches += line.mid(24).trimmed().toULongLong();
+                    else if (line.startsWith("nonvoluntary_ctxt_switches:"))
+                        c.involuntaryContextSwitches += line.mid(27).trimmed().toULongLong();
+                }
+            }
+        }
+        return c;
+    }
+#endif
+
+    // sampling thread
+    void sampleData(ProcFsPrefetcher *prefetched)
+    {
+#if defined(Q_OS_LINUX)
+        QMutexLocker locker(&m_sampleMutex);
+        updatePid(m_requestedPid.loadAcquire());
+        if (!m_pid)
+            return;
+
+        Counters c = readCounters(prefetched);
+
+        qint64 elapsed = m_elapsed.isValid() ? m_elapsed.nsecsElapsed() / 1000 : 0;
+        m_elapsed.start();
+
+        static const int cores = qMax(1, QThread::idealThreadCount());
+
+        // all counters can go backwards, if processes of the application exit
+        auto delta = [](quint64 now, quint64 last) { return now > last ? now - last : 0; };
+
+        CpuSample s;
+        if (m_last.cpuTime >= 0 && c.cpuTime > m_last.cpuTime && elapsed > 0)
+            s.cpuLoad = qBound(qreal(0), qreal(c.cpuTime - m_last.cpuTime) / (elapsed * cores), qreal(1));
+        if (m_last.cpuTime >= 0) {
+            s.minorPageFaults = delta(c.minorPageFaults, m_last.minorPageFaults);
+            s.majorPageFaults = delta(c.majorPageFaults, m_last.majorPageFaults);
+            s.voluntaryContextSwitches = delta(c.voluntaryContextSwitches, m_last.voluntaryContextSwitches);
+            s.involuntaryContextSwitches = delta(c.involuntaryContextSwitches, m_last.involuntaryContextSwitches);
+        }
+        m_last = c;
+        m_samples.push(s);
+#else
+        Q_UNUSED(prefetched)
+#endif
+    }
+
+    // GUI thread
+    void readData(qint64 containerCpuTime)
+    {
+        Q_Q(CpuMonitor);
+
+        QVector<CpuSample> newSamples;
+        CpuSample s;
+        while (m_samples.pop(&s))
+            newSamples << s;
+        if (newSamples.isEmpty())
+            return;
+
+        // the container might be able to account for processes we cannot see (e.g. cgroups)
+        if (containerCpuTime >= 0) {
+            static const int cores = qMax(1, QThread::idealThreadCount());
+            qint64 elapsed = m_containerElapsed.isValid() ? m_containerElapsed.nsecsElapsed() / 1000 : 0;
+            m_containerElapsed.start();
+
+            qreal load = 0;
+            if (m_lastContainerCpuTime >= 0 && containerCpuTime > m_lastContainerCpuTime && elapsed > 0)
+                load = qBound(qreal(0), qreal(containerCpuTime - m_lastContainerCpuTime) / (elapsed * cores), qreal(1));
+            newSamples.last().cpuLoad = load;
+            m_lastContainerCpuTime = containerCpuTime;
+        }
+
+        for (const CpuSample &sample : qAsConst(newSamples)) {
+            // ring buffer handling
+            // optimization: instead of sending a dataChanged for every item, we always move the
+            // first item to the end and change its data only
+            QVector<int> roles;
+            roles << CpuLoad << MinorPageFaults << MajorPageFaults << VoluntaryContextSwitches
+                  << InvoluntaryContextSwitches;
+
+            int size = samples.size();
+            q->beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), size);
+            samples[m_reportPos++] = sample;
+            if (m_reportPos >= samples.size())
+                m_reportPos = 0;
+            q->endMoveRows();
+            q->dataChanged(q->index(size - 1), q->index(size - 1), roles);
+
+            int sentIndex = size - m_reportPos;
+            if (sentIndex < 0)
+                sentIndex = 0;
+            else if (sentIndex > (modelSize - 1))
+                sentIndex = modelSize - 1;
+
+            emit q->cpuLoadReportingChanged(sentIndex);
+        }
+    }
+
+    QList<QVariant> readThreadList()
+    {
+        QList<QVariant> threads;
+#if defined(Q_OS_LINUX)
+        QMutexLocker locker(&m_sampleMutex);
+        updatePid(m_requestedPid.loadAcquire());
+        if (!m_pid)
+            return threads;
+
+        // the load is calculated relative to the last call of this function
+        qint64 elapsed = m_threadElapsed.isValid() ? m_threadElapsed.nsecsElapsed() / 1000 : 0;
+        m_threadElapsed.start();
+
+        QHash<quint64, qint64> threadTimes;
+        foreach (const QString &tid, taskIds(m_pid)) {
+            const QByteArray stat = readProcFile(qSL("/proc/%1/task/%2/stat").arg(m_pid).arg(tid));
+            const QList<QByteArray> fields = statFields(stat);
+            if (fields.size() <= 12)
+                continue;
+
+            quint64 id = tid.toULongLong();
+            qint64 time = ticksToUsec(fields.at(11).toLongLong() + fields.at(12).toLongLong());
+            threadTimes.insert(id, time);
+
+            int nameStart = stat.indexOf('(') + 1;
+            qreal load = 0;
+            auto last = m_lastThreadTimes.constFind(id);
+            if (last != m_lastThreadTimes.constEnd() && elapsed > 0 && time > *last)
+                load = qMin(qreal(1), qreal(time - *last) / elapsed); // relative to one core
+
+            QVariantMap map;
+            map[qSL("tid")] = id;
+            map[qSL("name")] = QString::fromLocal8Bit(stat.mid(nameStart, stat.lastIndexOf(')') - nameStart));
+            map[qSL("cpuTime")] = time;
+            map[qSL("cpuLoad")] = load;
+            threads.append(map);
+        }
+        m_lastThreadTimes = threadTimes;
+#endif
+        return threads;
+    }
+};
+
+CpuMonitor::CpuMonitor()
+    : d_ptr(new CpuMonitorPrivate(this))
+{
+    Q_D(CpuMonitor);
+
+    d->m_roles[CpuLoad] = "cpuLoad";
+    d->m_roles[MinorPageFaults] = "minorPageFaults";
+    d->m_roles[MajorPageFaults] = "majorPageFaults";
+    d->m_roles[VoluntaryContextSwitches] = "voluntaryContextSwitches";
+    d->m_roles[InvoluntaryContextSwitches] = "involuntaryContextSwitches";
+
+    d->updateModel();
+}
+
+CpuMonitor::~CpuMonitor()
+{
+    Q_D(CpuMonitor);
+    delete d;
+}
+
+int CpuMonitor::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    Q_D(const CpuMonitor);
+    return d->samples.size();
+}
+
+int CpuMonitor::count() const
+{
+    Q_D(const CpuMonitor);
+    return d->samples.size();
+}
+
+QVariant CpuMonitor::data(const QModelIndex &index, int role) const
+{
+    Q_D(const CpuMonitor);
+    if (!index.isValid() || index.row() < 0 || index.row() >= d->samples.size())
+        return QVariant();
+
+    const CpuMonitorPrivate::CpuSample &s = d->sampleForRow(index.row());
+
+    switch (role) {
+    case CpuLoad:
+        return s.cpuLoad;
+    case MinorPageFaults:
+        return s.minorPageFaults;
+    case MajorPageFaults:
+        return s.majorPageFaults;
+    case VoluntaryContextSwitches:
+        return s.voluntaryContextSwitches;
+    case InvoluntaryContextSwitches:
+        return s.involuntaryContextSwitches;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> CpuMonitor::roleNames() const
+{
+    Q_D(const CpuMonitor);
+    return d->m_roles;
+}
+
+QVariantMap CpuMonitor::get(int row) const
+{
+    if (row < 0 || row >= count()) {
+        qDebug() << Q_FUNC_INFO <<"Invalid row:" << row << "count:" << rowCount();
+        return QVariantMap();
+    }
+
+    QVariantMap map;
+    QHash<int, QByteArray> roles = roleNames();
+    for (auto it = roles.cbegin(); it != roles.cend(); ++it) {
+        map.insert(qL1S(it.value()), data(index(row), it.key()));
+    }
+
+    return map;
+}
+
+// Returns the CPU load of each thread of the application's main process since the last call
+QList<QVariant> CpuMonitor::getThreadList()
+{
+    Q_D(CpuMonitor);
+    return d->readThreadList();
+}
+
+void CpuMonitor::prefetch(ProcFsPrefetcher *prefetcher)
+{
+#if defined(Q_OS_LINUX)
+    Q_D(CpuMonitor);
+    prefetcher->addProcessTree(d->m_requestedPid.loadAcquire(), ProcFsPrefetcher::Stat);
+#else
+    Q_UNUSED(prefetcher)
+#endif
+}
+
+void CpuMonitor::sampleData(ProcFsPrefetcher *prefetched)
+{
+    Q_D(CpuMonitor);
+    d->sampleData(prefetched);
+}
+
+void CpuMonitor::readData(qint64 containerCpuTime)
+{
+    Q_D(CpuMonitor);
+    d->readData(containerCpuTime);
+}
+
+void CpuMonitor::setPid(quint64 pid)
+{
+    Q_D(CpuMonitor);
+    // picked up by the sampling thread
+    d->m_requestedPid.storeRelease(pid);
+}
+
+QT_END_NAMESPACE_AM
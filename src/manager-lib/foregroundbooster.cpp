@@ -0,0 +1,196 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#include <QCoreApplication>
+#include <QTimer>
+#include <QFile>
+
+#include "global.h"
+#include "application.h"
+#include "applicationmanager.h"
+#include "abstractruntime.h"
+#include "abstractcontainer.h"
+#include "foregroundbooster.h"
+#if defined(Q_OS_LINUX)
+#  include "sysfsreader.h"
+#endif
+
+QT_BEGIN_NAMESPACE_AM
+
+/*!
+    \class ForegroundBooster
+    \internal
+
+    Moves the application that was activated or focused last into the foreground control group and lowers
+    its OOM score, while the previous foreground application is moved into the background
+    control group. To avoid moving processes back and forth when the user is quickly switching
+    between applications, the demotion only happens after \c demotionDelay milliseconds: an
+    application that is activated again within this time never leaves the foreground group.
+*/
+
+ForegroundBooster *ForegroundBooster::s_instance = 0;
+
+ForegroundBooster *ForegroundBooster::instance()
+{
+    if (!s_instance)
+        s_instance = new ForegroundBooster(QCoreApplication::instance());
+    return s_instance;
+}
+
+ForegroundBooster::ForegroundBooster(QObject *parent)
+    : QObject(parent)
+{ }
+
+ForegroundBooster::~ForegroundBooster()
+{
+    s_instance = 0;
+}
+
+void ForegroundBooster::initialize(const QVariantMap &configuration)
+{
+    m_foregroundControlGroup = configuration.value(qSL("foregroundControlGroup")).toString();
+    m_backgroundControlGroup = configuration.value(qSL("backgroundControlGroup")).toString();
+
+    bool fgOk, bgOk;
+    m_foregroundOomScoreAdjust = qBound(-1000, configuration.value(qSL("foregroundOomScoreAdjust")).toInt(&fgOk), 1000);
+    m_backgroundOomScoreAdjust = qBound(-1000, configuration.value(qSL("backgroundOomScoreAdjust")).toInt(&bgOk), 1000);
+    m_adjustOomScore = fgOk && bgOk;
+
+    bool ok;
+    int delay = configuration.value(qSL("demotionDelay")).toInt(&ok);
+    if (ok && delay >= 0)
+        m_demotionDelay = delay;
+
+    m_enabled = !m_foregroundControlGroup.isEmpty() || m_adjustOomScore;
+}
+
+bool ForegroundBooster::isEnabled() const
+{
+    return m_enabled;
+}
+
+QString ForegroundBooster::foregroundApplication() const
+{
+    return m_foregroundId;
+}
+
+void ForegroundBooster::activateApplication(const QString &id)
+{
+    if (!m_enabled)
+        return;
+
+    const Application *app = ApplicationManager::instance()->fromId(id);
+    if (!app)
+        return;
+    if (app->isAlias())
+        app = app->nonAliased();
+
+    // the application was demoted before it could be moved to the background: just keep it
+    delete m_pendingDemotions.take(app->id());
+
+    // the process might not be running yet: the activation will be repeated when its window
+    // gets the focus
+    if (!classify(app, true))
+        return;
+
+    if (m_foregroundId == app->id())
+        return;
+
+    if (!m_foregroundId.isEmpty()) {
+        const QString previousId = m_foregroundId;
+        QTimer *t = new QTimer(this);
+        t->setSingleShot(true);
+        connect(t, &QTimer::timeout, this, [this, previousId]() { demoteApplication(previousId); });
+        t->start(m_demotionDelay);
+        delete m_pendingDemotions.take(previousId);
+        m_pendingDemotions.insert(previousId, t);
+    }
+    m_foregroundId = app->id();
+    emit applicationBoosted(m_foregroundId);
+}
+
+void ForegroundBooster::demoteApplication(const QString &id)
+{
+    if (QTimer *t = m_pendingDemotions.take(id))
+        t->deleteLater();
+    if (id == m_foregroundId)
+        return;
+
+    const Application *app = ApplicationManager::instance()->fromId(id);
+    if (app && classify(app, false))
+        emit applicationDemoted(id);
+}
+
+bool ForegroundBooster::classify(const Application *app, bool foreground)
+{
+    AbstractRuntime *rt = app->currentRuntime();
+    if (!rt || rt->manager()->inProcess())
+        return false;
+
+    qint64 pid = rt->applicationProcessId();
+    if (pid <= 0)
+        return false;
+
+    qCDebug(LogSystem) << (foreground ? "Boosting" : "Demoting") << "application" << app->id() << "( pid" << pid << ")";
+
+    const QString &group = foreground ? m_foregroundControlGroup : m_backgroundControlGroup;
+    if (!group.isEmpty() && rt->container() && !rt->container()->setControlGroup(group))
+        qCWarning(LogSystem) << "Could not move application" << app->id() << "into the control group" << group;
+
+#if defined(Q_OS_LINUX)
+    if (m_adjustOomScore) {
+        QByteArray value = QByteArray::number(foreground ? m_foregroundOomScoreAdjust : m_backgroundOomScoreAdjust);
+
+        // the score is per process, so the helper processes of the application need it as well
+        foreach (quint64 childPid, processTree(pid)) {
+            QFile f(qSL("/proc/%1/oom_score_adj").arg(childPid));
+            if (!f.open(QFile::WriteOnly | QFile::Unbuffered) || (f.write(value) != value.size())) {
+                // lowering the score below the initial value needs CAP_SYS_RESOURCE
+                qCWarning(LogSystem) << "Could not set the OOM score of application" << app->id()
+                                     << "( pid" << childPid << ") :" << f.errorString();
+            }
+        }
+    }
+#endif
+    return true;
+}
+
+QT_END_NAMESPACE_AM
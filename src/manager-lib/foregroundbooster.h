@@ -0,0 +1,96 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QVariantMap>
+#include <QtAppManCommon/global.h>
+
+QT_FORWARD_DECLARE_CLASS(QTimer)
+
+QT_BEGIN_NAMESPACE_AM
+
+class Application;
+
+class ForegroundBooster : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ForegroundBooster *instance();
+    ~ForegroundBooster();
+
+    void initialize(const QVariantMap &configuration);
+    bool isEnabled() const;
+
+    QString foregroundApplication() const;
+
+public slots:
+    void activateApplication(const QString &id);
+
+signals:
+    void applicationBoosted(const QString &id);
+    void applicationDemoted(const QString &id);
+
+private:
+    ForegroundBooster(QObject *parent = 0);
+    ForegroundBooster(const ForegroundBooster &);
+    ForegroundBooster &operator=(const ForegroundBooster &);
+    static ForegroundBooster *s_instance;
+
+    void demoteApplication(const QString &id);
+    bool classify(const Application *app, bool foreground);
+
+    bool m_enabled = false;
+    QString m_foregroundControlGroup;
+    QString m_backgroundControlGroup;
+    int m_foregroundOomScoreAdjust = 0;
+    int m_backgroundOomScoreAdjust = 0;
+    bool m_adjustOomScore = false;
+    int m_demotionDelay = 3000;
+
+    QString m_foregroundId;
+    QHash<QString, QTimer *> m_pendingDemotions; // id -> delayed demotion (the hysteresis)
+};
+
+QT_END_NAMESPACE_AM
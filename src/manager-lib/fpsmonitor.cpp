@@ -39,11 +39,238 @@
 **
 ****************************************************************************/
 
+#include <QDebug>
+#include <QVector>
+#include "global.h"
+#include "frametimer.h"
 #include "fpsmonitor.h"
 
 QT_BEGIN_NAMESPACE_AM
 
-FpsMonitor::FpsMonitor()
-{ }
+namespace {
+enum Roles
+{
+    AverageFps = Qt::UserRole + 1,
+    MinimumFps,
+    MaximumFps,
+    FpsJitter,
+    FrameTimeP50,
+    FrameTimeP95,
+    FrameTimeP99,
+    DroppedFrames,
+    LongestFrameTime
+};
+}
+
+class FpsMonitorPrivate
+{
+public:
+    FpsMonitorPrivate(FpsMonitor *q)
+        : q_ptr(q)
+    { }
+
+    FpsMonitor *q_ptr;
+    Q_DECLARE_PUBLIC(FpsMonitor)
+
+    struct FpsSample {
+        qreal averageFps = 0;
+        qreal minimumFps = 0;
+        qreal maximumFps = 0;
+        qreal fpsJitter = 0;
+        qreal frameTimeP50 = 0; // msec
+        qreal frameTimeP95 = 0;
+        qreal frameTimeP99 = 0;
+        int droppedFrames = 0;
+        qreal longestFrameTime = 0;
+    };
+    QVector<FpsSample> samples;
+
+    QHash<int, QByteArray> m_roles;
+    QPointer<QObject> m_window;
+    FrameTimer m_frameTimer;
+
+    int m_reportPos = 0;
+    int modelSize = 25;
+
+    const FpsSample &sampleForRow(int row) const
+    {
+        // convert a visual row position to an index into the internal ringbuffer
+
+        int pos = row + m_reportPos;
+        if (pos >= samples.size())
+            pos -= samples.size();
+
+        if (pos < 0 || pos >= samples.size())
+            return samples.first();
+        return samples.at(pos);
+    }
+
+    void updateModel()
+    {
+        Q_Q(FpsMonitor);
+
+        const bool resized = (samples.size() != modelSize);
+
+        q->beginResetModel();
+        samples.resize(modelSize);
+        q->endResetModel();
+        if (resized)
+            emit q->countChanged();
+    }
+
+    void readData()
+    {
+        Q_Q(FpsMonitor);
+
+        FpsSample s;
+        s.averageFps = m_frameTimer.averageFps();
+        s.minimumFps = m_frameTimer.minimumFps();
+        s.maximumFps = m_frameTimer.maximumFps();
+        s.fpsJitter = m_frameTimer.jitterFps();
+        s.frameTimeP50 = m_frameTimer.frameTimePercentile(qreal(0.5));
+        s.frameTimeP95 = m_frameTimer.frameTimePercentile(qreal(0.95));
+        s.frameTimeP99 = m_frameTimer.frameTimePercentile(qreal(0.99));
+        s.droppedFrames = m_frameTimer.droppedFrames();
+        s.longestFrameTime = m_frameTimer.longestFrameTime();
+        m_frameTimer.reset();
+
+        // ring buffer handling
+        // optimization: instead of sending a dataChanged for every item, we always move the
+        // first item to the end and change its data only
+        QVector<int> roles;
+        roles << AverageFps << MinimumFps << MaximumFps << FpsJitter << FrameTimeP50 << FrameTimeP95
+              << FrameTimeP99 << DroppedFrames << LongestFrameTime;
+
+        int size = samples.size();
+        q->beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), size);
+        samples[m_reportPos++] = s;
+        if (m_reportPos >= samples.size())
+            m_reportPos = 0;
+        q->endMoveRows();
+        q->dataChanged(q->index(size - 1), q->index(size - 1), roles);
+
+        int sentIndex = size - m_reportPos;
+        if (sentIndex < 0)
+            sentIndex = 0;
+        else if (sentIndex > (modelSize - 1))
+            sentIndex = modelSize - 1;
+
+        emit q->fpsReportingChanged(sentIndex);
+    }
+};
+
+FpsMonitor::FpsMonitor(QObject *window)
+    : d_ptr(new FpsMonitorPrivate(this))
+{
+    Q_D(FpsMonitor);
+
+    d->m_window = window;
+    // clients only commit on change: longer gaps between two commits are idle time
+    d->m_frameTimer.setIdleThreshold(3);
+
+    d->m_roles[AverageFps] = "averageFps";
+    d->m_roles[MinimumFps] = "minimumFps";
+    d->m_roles[MaximumFps] = "maximumFps";
+    d->m_roles[FpsJitter] = "fpsJitter";
+    d->m_roles[FrameTimeP50] = "frameTimeP50";
+    d->m_roles[FrameTimeP95] = "frameTimeP95";
+    d->m_roles[FrameTimeP99] = "frameTimeP99";
+    d->m_roles[DroppedFrames] = "droppedFrames";
+    d->m_roles[LongestFrameTime] = "longestFrameTime";
+
+    d->updateModel();
+}
+
+FpsMonitor::~FpsMonitor()
+{
+    Q_D(FpsMonitor);
+    delete d;
+}
+
+int FpsMonitor::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    Q_D(const FpsMonitor);
+    return d->samples.size();
+}
+
+int FpsMonitor::count() const
+{
+    Q_D(const FpsMonitor);
+    return d->samples.size();
+}
+
+QVariant FpsMonitor::data(const QModelIndex &index, int role) const
+{
+    Q_D(const FpsMonitor);
+    if (!index.isValid() || index.row() < 0 || index.row() >= d->samples.size())
+        return QVariant();
+
+    const FpsMonitorPrivate::FpsSample &s = d->sampleForRow(index.row());
+
+    switch (role) {
+    case AverageFps:
+        return s.averageFps;
+    case MinimumFps:
+        return s.minimumFps;
+    case MaximumFps:
+        return s.maximumFps;
+    case FpsJitter:
+        return s.fpsJitter;
+    case FrameTimeP50:
+        return s.frameTimeP50;
+    case FrameTimeP95:
+        return s.frameTimeP95;
+    case FrameTimeP99:
+        return s.frameTimeP99;
+    case DroppedFrames:
+        return s.droppedFrames;
+    case LongestFrameTime:
+        return s.longestFrameTime;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> FpsMonitor::roleNames() const
+{
+    Q_D(const FpsMonitor);
+    return d->m_roles;
+}
+
+QVariantMap FpsMonitor::get(int row) const
+{
+    if (row < 0 || row >= count()) {
+        qDebug() << Q_FUNC_INFO <<"Invalid row:" << row << "count:" << rowCount();
+        return QVariantMap();
+    }
+
+    QVariantMap map;
+    QHash<int, QByteArray> roles = roleNames();
+    for (auto it = roles.cbegin(); it != roles.cend(); ++it) {
+        map.insert(qL1S(it.value()), data(index(row), it.key()));
+    }
+
+    return map;
+}
+
+QObject *FpsMonitor::window() const
+{
+    Q_D(const FpsMonitor);
+    return d->m_window;
+}
+
+void FpsMonitor::newFrame(qreal refreshRate)
+{
+    Q_D(FpsMonitor);
+    d->m_frameTimer.setRefreshRate(refreshRate);
+    d->m_frameTimer.newFrame();
+}
+
+void FpsMonitor::readData()
+{
+    Q_D(FpsMonitor);
+    d->readData();
+}
 
 QT_END_NAMESPACE_AM
@@ -42,15 +42,45 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QPointer>
 #include <QtAppManCommon/global.h>
 
 QT_BEGIN_NAMESPACE_AM
 
+class FpsMonitorPrivate;
+
+// The frame rate of a single window of an application, as a ring-buffer model
 class FpsMonitor : public QAbstractListModel
 {
     Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(QObject *window READ window CONSTANT)
+
 public:
-    FpsMonitor();
+    FpsMonitor(QObject *window = nullptr);
+    ~FpsMonitor();
+
+    // the item model part
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role) const;
+    QHash<int, QByteArray> roleNames() const;
+
+    int count() const;
+    Q_INVOKABLE QVariantMap get(int index) const;
+
+    QObject *window() const;
+
+signals:
+    void countChanged();
+    void fpsReportingChanged(int modelIndex);
+
+private:
+    friend class ProcessMonitor;
+    void newFrame(qreal refreshRate = 0);
+    void readData();
+
+    FpsMonitorPrivate *d_ptr;
+    Q_DECLARE_PRIVATE(FpsMonitor)
 };
 
 QT_END_NAMESPACE_AM
@@ -0,0 +1,154 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#include <algorithm>
+
+#include "frametimer.h"
+
+QT_BEGIN_NAMESPACE_AM
+
+void FrameTimer::frameStarted()
+{
+    // only the first start after a swap counts: a frame can be requested multiple times
+    if (m_timer.isValid() && m_frameStart < 0)
+        m_frameStart = m_timer.nsecsElapsed();
+}
+
+void FrameTimer::newFrame()
+{
+    int frameTime = m_idealFrameTime;
+    if (m_timer.isValid()) {
+        qint64 elapsed = m_timer.nsecsElapsed();
+        if (m_frameStart >= 0) {
+            elapsed -= m_frameStart; // the window was idle up to the frame start
+        } else if (m_idleThreshold > 0
+                   && elapsed / 1000 > qint64(m_idleThreshold) * m_idealFrameTime) {
+            // the window was idle in between: this swap only starts a new measurement
+            m_timer.restart();
+            return;
+        }
+        frameTime = int(qBound(qint64(1), elapsed / 1000, qint64(INT_MAX)));
+    }
+    m_timer.restart();
+    m_frameStart = -1;
+
+    addFrameTime(frameTime);
+}
+
+void FrameTimer::addFrameTime(int frameTime)
+{
+    frameTime = qMax(1, frameTime);
+
+    m_count++;
+    m_sum += frameTime;
+    m_min = qMin(m_min, frameTime);
+    m_max = qMax(m_max, frameTime);
+    m_jitter += qAbs(frameTime - m_idealFrameTime);
+    m_histogram[bucketIndex(frameTime)]++;
+
+    // anything more than half a frame late has missed at least one vsync
+    int missed = int((qint64(frameTime) + m_idealFrameTime / 2) / m_idealFrameTime) - 1;
+    if (missed > 0)
+        m_dropped += missed;
+}
+
+void FrameTimer::reset()
+{
+    m_count = m_max = m_dropped = 0;
+    m_sum = m_jitter = 0;
+    m_min = INT_MAX;
+    std::fill(m_histogram, m_histogram + BucketCount, 0);
+}
+
+void FrameTimer::setRefreshRate(qreal refreshRate)
+{
+    if (refreshRate > 0)
+        m_idealFrameTime = qMax(1, qRound(1000000 / refreshRate));
+}
+
+qreal FrameTimer::frameTimePercentile(qreal p) const
+{
+    if (!m_count)
+        return 0;
+
+    qreal rank = qBound(qreal(0), p, qreal(1)) * m_count;
+    int cumulative = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        if (!m_histogram[i])
+            continue;
+        if (cumulative + m_histogram[i] >= rank) {
+            int lower = i ? bucketUpperBound(i - 1) : 0;
+            int upper = qMin(bucketUpperBound(i), m_max);
+            lower = qMax(lower, qMin(m_min, upper));
+            qreal value = lower + (upper - lower) * (rank - cumulative) / m_histogram[i];
+            return value / 1000;
+        }
+        cumulative += m_histogram[i];
+    }
+    return longestFrameTime();
+}
+
+int FrameTimer::bucketIndex(int frameTime)
+{
+    int ms = (frameTime - 1) / 1000; // a frame time of exactly 1ms is in bucket 0
+    if (ms < FineBuckets)
+        return ms;
+    if (ms < FineBuckets + MediumBuckets * 10)
+        return FineBuckets + (ms - FineBuckets) / 10;
+    if (ms < FineBuckets + MediumBuckets * 10 + CoarseBuckets * 100)
+        return FineBuckets + MediumBuckets + (ms - FineBuckets - MediumBuckets * 10) / 100;
+    return BucketCount - 1;
+}
+
+int FrameTimer::bucketUpperBound(int index)
+{
+    if (index < FineBuckets)
+        return (index + 1) * 1000;
+    index -= FineBuckets;
+    if (index < MediumBuckets)
+        return (FineBuckets + (index + 1) * 10) * 1000;
+    index -= MediumBuckets;
+    if (index < CoarseBuckets)
+        return (FineBuckets + MediumBuckets * 10 + (index + 1) * 100) * 1000;
+    return INT_MAX;
+}
+
+QT_END_NAMESPACE_AM
@@ -0,0 +1,137 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <climits>
+#include <QtAppManCommon/global.h>
+
+QT_BEGIN_NAMESPACE_AM
+
+// Accumulates frame times between two calls to reset()
+class FrameTimer
+{
+public:
+    FrameTimer()
+    {
+        reset();
+    }
+
+    // Called whenever the window starts to work on a new frame (e.g. on
+    // QQuickWindow::afterAnimating). Windows that are only redrawn on demand are idle between
+    // a frame swap and the start of the next frame: this time is not counted as frame time.
+    // Windows that never report the frame start are measured from swap to swap.
+    void frameStarted();
+    void newFrame();
+    void reset();
+
+    // adds a single frame time in usec (newFrame() measures it with the internal timer)
+    void addFrameTime(int frameTime);
+
+    // the ideal frame time is derived from the refresh rate of the screen the window is on
+    void setRefreshRate(qreal refreshRate);
+    inline int idealFrameTime() const { return m_idealFrameTime; }
+
+    // For windows that never report the frame start (e.g. Wayland clients that only commit
+    // on change), swap-to-swap intervals longer than this many ideal frame times are treated
+    // as idle time and not counted as a frame. 0 (the default) counts every interval.
+    inline void setIdleThreshold(int frames) { m_idleThreshold = qMax(0, frames); }
+    inline int idleThreshold() const { return m_idleThreshold; }
+
+    inline qreal averageFps() const
+    {
+        return m_sum ? qreal(1000000) * m_count / m_sum : qreal(0);
+    }
+
+    inline qreal minimumFps() const
+    {
+        return m_max ? qreal(1000000) / m_max : qreal(0);
+    }
+
+    inline qreal maximumFps() const
+    {
+        return m_min ? qreal(1000000) / m_min : qreal(0);
+    }
+
+    inline qreal jitterFps() const
+    {
+        return m_jitter ? qreal(1000000) * m_count / m_jitter : qreal(0);
+
+    }
+
+    // frame time percentile (0 < p <= 1) in msec, interpolated within the histogram bucket
+    qreal frameTimePercentile(qreal p) const;
+
+    // the number of missed vsyncs, as derived from the ideal frame time
+    inline int droppedFrames() const { return m_dropped; }
+
+    // the longest frame time in msec
+    inline qreal longestFrameTime() const { return qreal(m_max) / 1000; }
+
+private:
+    // fixed frame time buckets: 1ms steps up to 50ms, 10ms steps up to 200ms, 100ms steps up
+    // to 1s and one for everything above
+    enum {
+        FineBuckets = 50,
+        MediumBuckets = 15,
+        CoarseBuckets = 8,
+        BucketCount = FineBuckets + MediumBuckets + CoarseBuckets + 1
+    };
+    static int bucketIndex(int frameTime);
+    static int bucketUpperBound(int index);
+
+    int m_count = 0;
+    qint64 m_sum = 0;
+    int m_min = INT_MAX;
+    int m_max = 0;
+    qint64 m_jitter = 0;
+    int m_dropped = 0;
+    int m_histogram[BucketCount];
+
+    QElapsedTimer m_timer; // restarted on every frame swap
+    qint64 m_frameStart = -1; // nsec since the last swap, -1 if the frame start was not reported
+
+    int m_idealFrameTime = 16666; // usec
+    int m_idleThreshold = 0; // in ideal frame times
+};
+
+QT_END_NAMESPACE_AM
@@ -0,0 +1,382 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#include <QDebug>
+#include <QVector>
+#include <QMutex>
+#include <QMutexLocker>
+#include "global.h"
+#include "iomonitor.h"
+#include "spscqueue.h"
+
+#if defined(Q_OS_LINUX)
+#  include <QFile>
+#  include "sysfsreader.h"
+#endif
+
+QT_BEGIN_NAMESPACE_AM
+
+namespace {
+// All counters are deltas for the last reporting interval
+enum Roles {
+    ReadBytes = Qt::UserRole + 1,
+    WrittenBytes,
+    ReadCharacters,
+    WrittenCharacters,
+    ReadCalls,
+    WriteCalls
+};
+}
+
+class IoMonitorPrivate
+{
+public:
+    IoMonitorPrivate(IoMonitor *q)
+        : q_ptr(q)
+    { }
+
+    IoMonitor *q_ptr;
+    Q_DECLARE_PUBLIC(IoMonitor)
+
+    struct IoSample {
+        quint64 readBytes = 0;         // read_bytes: actually fetched from the storage layer
+        quint64 writtenBytes = 0;      // write_bytes minus cancelled_write_bytes
+        quint64 readCharacters = 0;    // rchar: all read() calls, including pipes and the page cache
+        quint64 writtenCharacters = 0; // wchar
+        quint64 readCalls = 0;         // syscr
+        quint64 writeCalls = 0;        // syscw
+    };
+    QVector<IoSample> samples;
+
+    QHash<int, QByteArray> m_roles;
+
+    // the container's counters are read on the GUI thread
+    qint64 m_lastContainerReadBytes = -1;
+    qint64 m_lastContainerWrittenBytes = -1;
+
+    // everything below is owned by the sampling thread, unless m_sampleMutex is locked
+    QMutex m_sampleMutex;
+    QAtomicInteger<quint64> m_requestedPid;
+    SpscQueue<IoSample, 8> m_samples; // sampling thread -> GUI thread
+    quint64 m_pid = 0;
+    IoSample m_last;
+    bool m_hasLast = false;
+
+    int m_reportPos = 0;
+    int modelSize = 25;
+
+    const IoSample &sampleForRow(int row) const
+    {
+        // convert a visual row position to an index into the internal ringbuffer
+
+        int pos = row + m_reportPos;
+        if (pos >= samples.size())
+            pos -= samples.size();
+
+        if (pos < 0 || pos >= samples.size())
+            return samples.first();
+        return samples.at(pos);
+    }
+
+    void updateModel()
+    {
+        Q_Q(IoMonitor);
+
+        const bool resized = (samples.size() != modelSize);
+
+        q->beginResetModel();
+        samples.resize(modelSize);
+        q->endResetModel();
+        if (resized)
+            emit q->countChanged();
+    }
+
+#if defined(Q_OS_LINUX)
+    // The totals of the application's process and all its descendants. /proc/<pid>/io is only
+    // readable by the owner of the process (or with CAP_SYS_PTRACE).
+    bool readCounters(IoSample *c, ProcFsPrefetcher *prefetched) const
+    {
+        bool found = false;
+        const QVector<quint64> pids = prefetched ? prefetched->processTree(m_pid) : processTree(m_pid);
+        foreach (quint64 pid, pids) {
+            QByteArray io;
+            if (prefetched) {
+                io = prefetched->read(pid, ProcFsPrefetcher::Io);
+            } else {
+                QFile f(qSL("/proc/%1/io").arg(pid));
+                if (f.open(QFile::ReadOnly))
+                    io = f.readAll();
+            }
+            if (io.isEmpty())
+                continue;
+            quint64 writeBytes = 0, cancelledWriteBytes = 0;
+            foreach (const QByteArray &line, io.split('\n')) {
+                int colon = line.indexOf(':');
+                if (colon < 0)
+                    continue;
+                const QByteArray key = line.left(colon);
+                quint64 value = line.mid(colon + 1).trimmed().toULongLong();
+                if (key == "read_bytes")
+                    c->readBytes += value;
+                else if (key == "write_bytes")
+                    writeBytes = value;
+                else if (key == "cancelled_write_bytes")
+                    cancelledWriteBytes = value;
+                else if (key == "rchar")
+                    c->readCharacters += value;
+                else if (key == "wchar")
+                    c->writtenCharacters += value;
+                else if (key == "syscr")
+                    c->readCalls += value;
+                else if (key == "syscw")
+                    c->writeCalls += value;
+            }
+            // data that was truncated before it ever reached the storage
+            c->writtenBytes += writeBytes - qMin(writeBytes, cancelledWriteBytes);
+            found = true;
+        }
+        return found;
+    }
+#endif
+
+    void setPid(quint64 pid)
+    {
+        if (m_pid == pid)
+            return;
+        m_pid = pid;
+        m_hasLast = false;
+    }
+
+    // sampling thread
+    void sampleData(ProcFsPrefetcher *prefetched)
+    {
+#if defined(Q_OS_LINUX)
+        QMutexLocker locker(&m_sampleMutex);
+        setPid(m_requestedPid.loadAcquire());
+        if (!m_pid)
+            return;
+
+        IoSample c;
+        if (!readCounters(&c, prefetched))
+            return;
+
+        // all counters can go backwards, if processes of the application exit
+        auto delta = [](quint64 now, quint64 last) { return now > last ? now - last : 0; };
+
+        IoSample s;
+        if (m_hasLast) {
+            s.readBytes = delta(c.readBytes, m_last.readBytes);
+            s.writtenBytes = delta(c.writtenBytes, m_last.writtenBytes);
+            s.readCharacters = delta(c.readCharacters, m_last.readCharacters);
+            s.writtenCharacters = delta(c.writtenCharacters, m_last.writtenCharacters);
+            s.readCalls = delta(c.readCalls, m_last.readCalls);
+            s.writeCalls = delta(c.writeCalls, m_last.writeCalls);
+        }
+        m_last = c;
+        m_hasLast = true;
+        m_samples.push(s);
+#else
+        Q_UNUSED(prefetched)
+#endif
+    }
+
+    // GUI thread
+    void readData(qint64 containerReadBytes, qint64 containerWrittenBytes)
+    {
+        Q_Q(IoMonitor);
+
+        QVector<IoSample> newSamples;
+        IoSample s;
+        while (m_samples.pop(&s))
+            newSamples << s;
+
+        // the container's cgroup also accounts for processes we cannot see or read: its byte
+        // counters replace the ones from procfs
+        if (containerReadBytes >= 0 && containerWrittenBytes >= 0) {
+            if (newSamples.isEmpty())
+                newSamples.resize(1);
+            IoSample &last = newSamples.last();
+            last.readBytes = (m_lastContainerReadBytes >= 0 && containerReadBytes > m_lastContainerReadBytes)
+                    ? quint64(containerReadBytes - m_lastContainerReadBytes) : 0;
+            last.writtenBytes = (m_lastContainerWrittenBytes >= 0 && containerWrittenBytes > m_lastContainerWrittenBytes)
+                    ? quint64(containerWrittenBytes - m_lastContainerWrittenBytes) : 0;
+            m_lastContainerReadBytes = containerReadBytes;
+            m_lastContainerWrittenBytes = containerWrittenBytes;
+        }
+
+        for (const IoSample &sample : qAsConst(newSamples)) {
+            // ring buffer handling
+            // optimization: instead of sending a dataChanged for every item, we always move the
+            // first item to the end and change its data only
+            QVector<int> roles;
+            roles << ReadBytes << WrittenBytes << ReadCharacters << WrittenCharacters << ReadCalls << WriteCalls;
+
+            int size = samples.size();
+            q->beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), size);
+            samples[m_reportPos++] = sample;
+            if (m_reportPos >= samples.size())
+                m_reportPos = 0;
+            q->endMoveRows();
+            q->dataChanged(q->index(size - 1), q->index(size - 1), roles);
+
+            int sentIndex = size - m_reportPos;
+            if (sentIndex < 0)
+                sentIndex = 0;
+            else if (sentIndex > (modelSize - 1))
+                sentIndex = modelSize - 1;
+
+            emit q->ioReportingChanged(sentIndex);
+        }
+    }
+};
+
+IoMonitor::IoMonitor()
+    : d_ptr(new IoMonitorPrivate(this))
+{
+    Q_D(IoMonitor);
+
+    d->m_roles[ReadBytes] = "readBytes";
+    d->m_roles[WrittenBytes] = "writtenBytes";
+    d->m_roles[ReadCharacters] = "readCharacters";
+    d->m_roles[WrittenCharacters] = "writtenCharacters";
+    d->m_roles[ReadCalls] = "readCalls";
+    d->m_roles[WriteCalls] = "writeCalls";
+
+    d->updateModel();
+}
+
+IoMonitor::~IoMonitor()
+{
+    Q_D(IoMonitor);
+    delete d;
+}
+
+int IoMonitor::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    Q_D(const IoMonitor);
+    return d->samples.size();
+}
+
+int IoMonitor::count() const
+{
+    Q_D(const IoMonitor);
+    return d->samples.size();
+}
+
+QVariant IoMonitor::data(const QModelIndex &index, int role) const
+{
+    Q_D(const IoMonitor);
+    if (!index.isValid() || index.row() < 0 || index.row() >= d->samples.size())
+        return QVariant();
+
+    const IoMonitorPrivate::IoSample &s = d->sampleForRow(index.row());
+
+    switch (role) {
+    case ReadBytes:
+        return s.readBytes;
+    case WrittenBytes:
+        return s.writtenBytes;
+    case ReadCharacters:
+        return s.readCharacters;
+    case WrittenCharacters:
+        return s.writtenCharacters;
+    case ReadCalls:
+        return s.readCalls;
+    case WriteCalls:
+        return s.writeCalls;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> IoMonitor::roleNames() const
+{
+    Q_D(const IoMonitor);
+    return d->m_roles;
+}
+
+QVariantMap IoMonitor::get(int row) const
+{
+    if (row < 0 || row >= count()) {
+        qDebug() << Q_FUNC_INFO <<"Invalid row:" << row << "count:" << rowCount();
+        return QVariantMap();
+    }
+
+    QVariantMap map;
+    QHash<int, QByteArray> roles = roleNames();
+    for (auto it = roles.cbegin(); it != roles.cend(); ++it) {
+        map.insert(qL1S(it.value()), data(index(row), it.key()));
+    }
+
+    return map;
+}
+
+void IoMonitor::prefetch(ProcFsPrefetcher *prefetcher)
+{
+#if defined(Q_OS_LINUX)
+    Q_D(IoMonitor);
+    prefetcher->addProcessTree(d->m_requestedPid.loadAcquire(), ProcFsPrefetcher::Io);
+#else
+    Q_UNUSED(prefetcher)
+#endif
+}
+
+void IoMonitor::sampleData(ProcFsPrefetcher *prefetched)
+{
+    Q_D(IoMonitor);
+    d->sampleData(prefetched);
+}
+
+void IoMonitor::readData(qint64 containerReadBytes, qint64 containerWrittenBytes)
+{
+    Q_D(IoMonitor);
+    d->readData(containerReadBytes, containerWrittenBytes);
+}
+
+void IoMonitor::setPid(quint64 pid)
+{
+    Q_D(IoMonitor);
+    // picked up by the sampling thread
+    d->m_requestedPid.storeRelease(pid);
+}
+
+QT_END_NAMESPACE_AM
@@ -31,14 +31,21 @@ HEADERS += \
     abstractruntime.h \
     runtimefactory.h \
     quicklauncher.h \
+    foregroundbooster.h \
+    metricsexporter.h \
     applicationipcmanager.h \
     applicationipcinterface.h \
     applicationipcinterface_p.h \
     systemmonitor.h \
     systemmonitor_p.h \
+    systemmonitorhistory.h \
     processmonitor.h \
     memorymonitor.h \
+    cpumonitor.h \
+    iomonitor.h \
     fpsmonitor.h \
+    frametimer.h \
+    spscqueue.h \
 
 !headless:HEADERS += \
     fakeapplicationmanagerwindow.h \
@@ -50,6 +57,7 @@ multi-process:HEADERS += \
 
 linux:HEADERS += \
     sysfsreader.h \
+    controlgroupv2.h \
 
 qtHaveModule(qml):HEADERS += \
     qmlinprocessruntime.h \
@@ -67,13 +75,19 @@ SOURCES += \
     abstractruntime.cpp \
     runtimefactory.cpp \
     quicklauncher.cpp \
+    foregroundbooster.cpp \
+    metricsexporter.cpp \
     applicationipcmanager.cpp \
     applicationipcinterface.cpp \
     systemmonitor.cpp \
     systemmonitor_p.cpp \
+    systemmonitorhistory.cpp \
     processmonitor.cpp \
     memorymonitor.cpp \
+    cpumonitor.cpp \
+    iomonitor.cpp \
     fpsmonitor.cpp \
+    frametimer.cpp \
 
 !headless:SOURCES += \
     fakeapplicationmanagerwindow.cpp \
@@ -84,6 +98,7 @@ multi-process:SOURCES += \
 
 linux:SOURCES += \
     sysfsreader.cpp \
+    controlgroupv2.cpp \
 
 qtHaveModule(qml):SOURCES += \
     qmlinprocessruntime.cpp \
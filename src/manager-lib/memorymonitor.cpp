@@ -42,12 +42,19 @@
 #include <QDebug>
 #include <QFile>
 #include <QVector>
+#include <QMutex>
+#include <QMutexLocker>
 #include "global.h"
 #include "memorymonitor.h"
+#include "spscqueue.h"
 
 #if defined(Q_OS_OSX)
 #  include <mach/mach.h>
 #elif defined(Q_OS_LINUX)
+#  include <QMap>
+#  include <cstdlib>
+#  include <cstring>
+#  include <unistd.h>
 #  include "sysfsreader.h"
 #endif
 
@@ -80,30 +87,23 @@ public:
 
     struct smaps_sizes {
         quint64 vmSize = 0;
-        int rss = 0;
-        int pss = 0;
-        int sharedV = 0;
-        int sharedR = 0;
-        int sharedP = 0;
-        int ROV = 0;
-        int ROR = 0;
-        int ROP = 0;
-        int heapV = 0;
-        int heapR = 0;
-        int heapP = 0;
-        int stackV = 0;
-        int stackR = 0;
-        int stackP = 0;
-        int threadStackV = 0;
-        int threadStackR = 0;
-        int threadStackP = 0;
-        int codeV = 0;
-        int codeR = 0;
-        int codeP = 0;
+        quint64 rss = 0;
+        quint64 pss = 0;
+        quint64 heapV = 0;
+        quint64 heapR = 0;
+        quint64 heapP = 0;
+        quint64 stackV = 0;
+        quint64 stackR = 0;
+        quint64 stackP = 0;
     };
     QVector<smaps_sizes> smapSizes;
 
     QHash<int, QByteArray> m_roles;
+
+    // everything below is owned by the sampling thread, unless m_sampleMutex is locked
+    QMutex m_sampleMutex;
+    QAtomicInteger<quint64> m_requestedPid { quint64(-1) };
+    SpscQueue<smaps_sizes, 8> m_samples; // sampling thread -> GUI thread
     quint64 m_pid = -1;
 
     int m_reportPos = 0;
@@ -113,6 +113,37 @@ public:
 
 #if defined(Q_OS_LINUX)
     QScopedPointer<SysFsReader> s_smapsFs;
+    QScopedPointer<SysFsReader> m_smapsRollupFs;
+    QScopedPointer<SysFsReader> m_statmFs;
+
+    // The per-mapping view in smaps is expensive to generate for the kernel, so the heap and
+    // stack break-down is only updated every DetailedInterval samples, if smaps_rollup is
+    // available for the totals.
+    static const int DetailedInterval = 5;
+    int m_samplesUntilDetailed = 0;
+    smaps_sizes m_lastDetailed;
+
+    // state of the streaming smaps parser
+    struct Mapping {
+        quint64 size = 0;
+        quint64 rss = 0;
+        quint64 pss = 0;
+        char perms[5] = { 0 };
+        bool anonymous = false;
+        QByteArray path;
+    };
+    Mapping m_current;
+    Mapping m_previous;
+    bool m_inMapping = false;
+    smaps_sizes *m_sizes = nullptr;
+    QByteArray m_readBuffer;
+
+    struct LibrarySizes {
+        quint64 vSize = 0;
+        quint64 rSize = 0;
+        quint64 pSize = 0;
+    };
+    QMap<QByteArray, LibrarySizes> m_librarySizes;
 #endif
 
     const smaps_sizes &smapsForRow(int row) const
@@ -137,13 +168,24 @@ public:
 
         QByteArray filePath = "/proc/";
         filePath.append(QByteArray::number(m_pid));
-        filePath.append("/smaps");
 
-        // Tricky part. smaps has dynamic size
-        s_smapsFs.reset(new SysFsReader(filePath.constData(), 614400));
+        // smaps has a dynamic size, but we are parsing it in chunks
+        s_smapsFs.reset(new SysFsReader(filePath + "/smaps", 0));
         if (!s_smapsFs->isOpen())
-            qCWarning(LogSystem) << "WARNING: could not read CPU statistics from" << s_smapsFs->fileName();
-
+            qCWarning(LogSystem) << "WARNING: could not read memory statistics from" << s_smapsFs->fileName();
+
+        // only available since Linux 4.14
+        m_smapsRollupFs.reset(new SysFsReader(filePath + "/smaps_rollup", 0));
+        if (!m_smapsRollupFs->isOpen())
+            m_smapsRollupFs.reset();
+        m_statmFs.reset(new SysFsReader(filePath + "/statm", 128));
+
+        m_samplesUntilDetailed = 0;
+        m_lastDetailed = smaps_sizes();
+        if (m_readBuffer.isEmpty()) {
+            m_readBuffer.resize(64 * 1024);
+            m_current.path.reserve(1024);
+        }
 #endif
     }
 
@@ -151,163 +193,218 @@ public:
     {
         Q_Q(MemoryMonitor);
 
+        const bool resized = (smapSizes.size() != modelSize);
+
         q->beginResetModel();
         // we need at least 2 items, otherwise we cannot move rows
         smapSizes.resize(modelSize);
         q->endResetModel();
+        if (resized)
+            emit q->countChanged();
     }
 
-    void readData()
-    {
-        Q_Q(MemoryMonitor);
-        QVector<int> roles;
-        smaps_sizes t;
 #if defined(Q_OS_LINUX)
-        QByteArray str = s_smapsFs->readValue();
-        QList<QByteArray> lines = str.split('\n');
-
-        // Range as number of lines for each allocation in the memory
-        int range = 19;
-        QList<QByteArray> header;
-        QList<QByteArray> lastHeader;
-
-        for (int i = 0; i < lines.size()/range; i++) {
-            lastHeader = header;
-            int listIndex = i*range;
-
-            // First line - header
-            header = lines.at(listIndex).split(' ');
-
-            if (i == 0)
-                lastHeader = header;
-
-            // Second line virtual size
-            QList<QByteArray> vmSize = lines.at(listIndex + 1).split(' ');
-            // Third line resident size
-            QList<QByteArray> rss = lines.at(listIndex + 2).split(' ');
-            // Fourth line proportional size
-            QList<QByteArray> pss = lines.at(listIndex + 3).split(' ');
-
-            //Avoid \x00 or reading data error
-            // Header line should have memory address, flags
-            // and library name
-            if ((vmSize.size() < 3) || (pss.size() < 3) || (rss.size() < 3) || (header.size() < 5))
-                break;
-
-            int v = vmSize.at(vmSize.size() - 2).toInt() * 1000;
-            t.vmSize = t.vmSize + v;
-
-            int r = rss.at(rss.size() - 2).toInt() * 1000;
-            t.rss = t.rss + r;
+    static quint64 parseKiloBytes(const char *str, const char *end)
+    {
+        quint64 value = 0;
+        while (str < end && *str == ' ')
+            ++str;
+        while (str < end && *str >= '0' && *str <= '9')
+            value = value * 10 + quint64(*str++ - '0');
+        return value * 1024;
+    }
 
-            int p = pss.at(pss.size() - 2).toInt() * 1000;
-            t.pss = t.pss + p;
+    // Called for every line of an smaps (or smaps_rollup) file: no allocations, as long as the
+    // path names fit into the capacity of m_current.path
+    void parseSmapsLine(const char *line, int length)
+    {
+        const char *end = line + length;
+        const char *colon = static_cast<const char *>(memchr(line, ':', length));
+        const char *space = static_cast<const char *>(memchr(line, ' ', length));
+
+        if (colon && (!space || colon < space)) {
+            // a "Key:   <value> kB" line: the fields and their order vary between kernel versions
+            if (!m_inMapping)
+                return;
+            int keyLength = int(colon - line);
+            quint64 *value = nullptr;
+            if (keyLength == 4 && !memcmp(line, "Size", 4))
+                value = &m_current.size;
+            else if (keyLength == 3 && !memcmp(line, "Rss", 3))
+                value = &m_current.rss;
+            else if (keyLength == 3 && !memcmp(line, "Pss", 3))
+                value = &m_current.pss;
+            if (value)
+                *value = parseKiloBytes(colon + 1, end);
+            return;
+        }
 
-            QString libName = QString::fromLocal8Bit(header.at(header.size()-1));
+        // a mapping header: "<start>-<end> <perms> <offset> <dev> <inode> [<path>]"
+        finishMapping();
+
+        const char *fields[5];
+        int fieldLengths[5];
+        const char *pos = line;
+        for (int i = 0; i < 5; ++i) {
+            while (pos < end && *pos == ' ')
+                ++pos;
+            fields[i] = pos;
+            while (pos < end && *pos != ' ')
+                ++pos;
+            fieldLengths[i] = int(pos - fields[i]);
+        }
+        while (pos < end && *pos == ' ')
+            ++pos;
+
+        m_current.size = m_current.rss = m_current.pss = 0;
+        memset(m_current.perms, 0, sizeof(m_current.perms));
+        memcpy(m_current.perms, fields[1], qMin(fieldLengths[1], 4));
+        m_current.anonymous = (fieldLengths[3] == 5) && !memcmp(fields[3], "00:00", 5)
+                && (fieldLengths[4] == 1) && (*fields[4] == '0');
+        m_current.path.truncate(0);
+        m_current.path.append(pos, int(end - pos));
+        m_inMapping = true;
+    }
 
-            if (readLibraryList) {
-                if (!libName.isEmpty()) {
-                    QVariantMap map;
-                    map[qSL("lib")] = libName;
-                    map[qSL("vSize")] = v;
-                    map[qSL("rSize")] = r;
-                    map[qSL("pSize")] = p;
-                    libraries.append(QVariant::fromValue(map));
-                }
+    void finishMapping()
+    {
+        if (!m_inMapping)
+            return;
+        m_inMapping = false;
+
+        smaps_sizes &t = *m_sizes;
+        const Mapping &m = m_current;
+
+        t.vmSize += m.size;
+        t.rss += m.rss;
+        t.pss += m.pss;
+
+        if (m.path == "[heap]") {
+            t.heapV += m.size;
+            t.heapR += m.rss;
+            t.heapP += m.pss;
+        } else if (m.path.startsWith("[stack")) {
+            t.stackV += m.size;
+            t.stackR += m.rss;
+            t.stackP += m.pss;
+        } else if (m.anonymous && !qstrcmp(m.perms, "rw-p")) {
+            // thread stacks are anonymous mappings directly above an inaccessible guard page
+            if (m_previous.anonymous && !qstrcmp(m_previous.perms, "---p")) {
+                t.stackV += m.size;
+                t.stackR += m.rss;
+                t.stackP += m.pss;
+            } else {
+                t.heapV += m.size;
+                t.heapR += m.rss;
+                t.heapP += m.pss;
             }
+        }
+
+        if (readLibraryList && !m.path.isEmpty() && !m.path.startsWith('[')) {
+            LibrarySizes &lib = m_librarySizes[m.path];
+            lib.vSize += m.size;
+            lib.rSize += m.rss;
+            lib.pSize += m.pss;
+        }
 
-            QByteArray type = header.at(header.size() - 1);
-            QByteArray flags = header.at(1);
-            QByteArray lastFlags = lastHeader.at(1);
-            QByteArray temp = header.at(3);
+        m_previous.anonymous = m.anonymous;
+        memcpy(m_previous.perms, m.perms, sizeof(m.perms));
+    }
 
-            if (type == "[heap]") {
-                t.heapV = t.heapV + v;
-                t.heapR = t.heapR + r;
-                t.heapP = t.heapP + p;
-            }
-            else if (type == "[stack]") {
-                t.stackV = t.stackV + v;
-                t.stackR = t.stackR + r;
-                t.stackP = t.stackP + p;
-            }
-            else if (flags == "rw-p") {
-                if (v == 8192 && temp == "00:00" && lastFlags == "---p") {
-                    /*
-                     * thread stack we skip for now
-                    t.threadStackV = t.threadStackV + v;
-                    t.threadStackR = t.threadStackR + r;
-                    t.threadStackP = t.threadStackP + p;
-                    */
-
-                    t.stackV = t.stackV + v;
-                    t.stackR = t.stackR + r;
-                    t.stackP = t.stackP + p;
-                }
-                else if (temp == "00:00") {
-                    t.heapV = t.heapV + v;
-                    t.heapR = t.heapR + r;
-                    t.heapP = t.heapP + p;
-                }
-                /*
-                 * Can be added by the need
-                else {
-                    t.sharedV = t.sharedV + v;
-                    t.sharedR = t.sharedR + r;
-                    t.sharedP = t.sharedP + p;
-                }
-                */
+    // Parses the complete file in a single pass through a fixed buffer
+    bool parseSmaps(SysFsReader *reader, smaps_sizes &t)
+    {
+        if (!reader || !reader->rewind())
+            return false;
+
+        m_sizes = &t;
+        m_inMapping = false;
+        m_previous = Mapping();
+
+        char *buffer = m_readBuffer.data();
+        const int bufferSize = m_readBuffer.size();
+        int filled = 0;
+
+        forever {
+            int bytesRead = reader->read(buffer + filled, bufferSize - filled);
+            if (bytesRead < 0)
+                return false;
+            if (bytesRead == 0) {
+                if (filled)
+                    parseSmapsLine(buffer, filled);
+                break;
             }
+            filled += bytesRead;
 
-            /*
-             * Can be added by the need
-            else if (flags == "rw-s" && temp != "00:00") {
-                t.sharedV = t.sharedV + v;
-                t.sharedR = t.sharedR + r;
-                t.sharedP = t.sharedP + p;
-            }
-            else if (flags == "r--p" || flags == "r--s") {
-                t.ROV = t.ROV + v;
-                t.ROR = t.ROR + r;
-                t.ROP = t.ROP + p;
-            }
-            else if (flags == "r-xp") {
-                t.codeV = t.codeV + v;
-                t.codeR = t.codeR + r;
-                t.codeP = t.codeP + p;
+            int pos = 0;
+            while (const char *eol = static_cast<const char *>(memchr(buffer + pos, '\n', filled - pos))) {
+                int lineEnd = int(eol - buffer);
+                parseSmapsLine(buffer + pos, lineEnd - pos);
+                pos = lineEnd + 1;
             }
-            */
+            filled -= pos;
+            if (filled == bufferSize) // a single line that does not fit into the buffer: skip it
+                filled = 0;
+            else if (pos && filled)
+                memmove(buffer, buffer + pos, filled);
+        }
+        finishMapping();
+        m_sizes = nullptr;
+        return true;
+    }
+
+    bool readLinuxData(smaps_sizes &t)
+    {
+        if (!s_smapsFs || !s_smapsFs->isOpen())
+            return false;
+
+        if (!m_smapsRollupFs || readLibraryList || (--m_samplesUntilDetailed <= 0)) {
+            if (!parseSmaps(s_smapsFs.data(), t))
+                return false;
+            m_lastDetailed = t;
+            m_samplesUntilDetailed = DetailedInterval;
+            return true;
+        }
 
+        // fast path: the kernel sums up all mappings for us
+        smaps_sizes rollup;
+        if (!parseSmaps(m_smapsRollupFs.data(), rollup))
+            return false;
+
+        t = m_lastDetailed;
+        t.rss = rollup.rss;
+        t.pss = rollup.pss;
+        if (m_statmFs && m_statmFs->isOpen()) {
+            static const quint64 pageSize = sysconf(_SC_PAGESIZE);
+            t.vmSize = ::strtoull(m_statmFs->readValue().constData(), 0, 10) * pageSize;
         }
+        return true;
+    }
+#endif
 
-        // ring buffer handling
-        // optimization: instead of sending a dataChanged for every item, we always move the
-        // first item to the end and change its data only
-        roles.append(VmSize);
-        roles.append(Rss);
-        roles.append(Pss);
-        roles.append(HeapV);
-        roles.append(HeapR);
-        roles.append(HeapP);
-        roles.append(StackV);
-        roles.append(StackR);
-        roles.append(StackP);
-
-        int size = smapSizes.size();
-        q->beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), size);
-        smapSizes[m_reportPos++] = t;
-        if (m_reportPos >= smapSizes.size())
-            m_reportPos = 0;
-        q->endMoveRows();
-        q->dataChanged(q->index(size - 1), q->index(size - 1), roles);
-
-        int sentIndex = size - m_reportPos;
-        if (sentIndex < 0)
-            sentIndex = 0;
-        else if (sentIndex > (modelSize - 1))
-            sentIndex = modelSize - 1;
-
-        emit q->memoryReportingChanged(sentIndex);
+    // called with m_sampleMutex locked
+    bool sample(smaps_sizes &t)
+    {
+        updatePid(m_requestedPid.loadAcquire());
+#if defined(Q_OS_LINUX)
+        if (readLibraryList)
+            m_librarySizes.clear();
+
+        if (!readLinuxData(t))
+            return false;
+
+        if (readLibraryList) {
+            for (auto it = m_librarySizes.cbegin(); it != m_librarySizes.cend(); ++it) {
+                QVariantMap map;
+                map[qSL("lib")] = QString::fromLocal8Bit(it.key());
+                map[qSL("vSize")] = it->vSize;
+                map[qSL("rSize")] = it->rSize;
+                map[qSL("pSize")] = it->pSize;
+                libraries.append(QVariant::fromValue(map));
+            }
+            m_librarySizes.clear();
+        }
+        return true;
 
 #elif defined(Q_OS_OSX)
 
@@ -319,41 +416,65 @@ public:
                                       &t_info_count))
         {
             qCWarning(LogSystem) << "WARNING Could not read the memory data";
-            return;
+            return false;
         }
 
-        roles.append(VmSize);
-        roles.append(Rss);
-        roles.append(Pss);
-        roles.append(HeapV);
-        roles.append(HeapR);
-        roles.append(HeapP);
-        roles.append(StackV);
-        roles.append(StackR);
-        roles.append(StackP);
-
         t.rss = t_info.resident_size;
         t.vmSize = t_info.virtual_size;
+        return true;
 
-        int size = smapSizes.size();
-        q->beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), size);
-        smapSizes[m_reportPos++] = t;
-        if (m_reportPos >= smapSizes.size())
-            m_reportPos = 0;
-        q->endMoveRows();
-        q->dataChanged(q->index(size - 1), q->index(size - 1), roles);
+#else
+        Q_UNUSED(t)
+        return false;
+#endif
+    }
 
-        int sentIndex = size - m_reportPos;
-        if (sentIndex < 0)
-            sentIndex = 0;
-        else if (sentIndex > (modelSize - 1))
-            sentIndex = modelSize - 1;
+    // sampling thread
+    void sampleData()
+    {
+        QMutexLocker locker(&m_sampleMutex);
+        smaps_sizes t;
+        if (sample(t))
+            m_samples.push(t);
+    }
 
-        emit q->memoryReportingChanged(sentIndex);
+    // GUI thread
+    void readData()
+    {
+        Q_Q(MemoryMonitor);
 
-#else
-    Q_UNUSED(q)
-#endif
+        smaps_sizes t;
+        while (m_samples.pop(&t)) {
+            // ring buffer handling
+            // optimization: instead of sending a dataChanged for every item, we always move the
+            // first item to the end and change its data only
+            QVector<int> roles;
+            roles.append(VmSize);
+            roles.append(Rss);
+            roles.append(Pss);
+            roles.append(HeapV);
+            roles.append(HeapR);
+            roles.append(HeapP);
+            roles.append(StackV);
+            roles.append(StackR);
+            roles.append(StackP);
+
+            int size = smapSizes.size();
+            q->beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), size);
+            smapSizes[m_reportPos++] = t;
+            if (m_reportPos >= smapSizes.size())
+                m_reportPos = 0;
+            q->endMoveRows();
+            q->dataChanged(q->index(size - 1), q->index(size - 1), roles);
+
+            int sentIndex = size - m_reportPos;
+            if (sentIndex < 0)
+                sentIndex = 0;
+            else if (sentIndex > (modelSize - 1))
+                sentIndex = modelSize - 1;
+
+            emit q->memoryReportingChanged(sentIndex);
+        }
     }
 
 };
@@ -451,6 +572,12 @@ QVariantMap MemoryMonitor::get(int row) const
     return map;
 }
 
+void MemoryMonitor::sampleData()
+{
+    Q_D(MemoryMonitor);
+    d->sampleData();
+}
+
 void MemoryMonitor::readData()
 {
     Q_D(MemoryMonitor);
@@ -460,15 +587,19 @@ void MemoryMonitor::readData()
 void MemoryMonitor::setPid(quint64 pid)
 {
     Q_D(MemoryMonitor);
-    d->updatePid(pid);
+    // picked up by the sampling thread
+    d->m_requestedPid.storeRelease(pid);
 }
 
 QList<QVariant> MemoryMonitor::getLibraryList()
 {
     Q_D(MemoryMonitor);
+    // this is an explicit request, so we have to do the (expensive) reading on this thread
+    QMutexLocker locker(&d->m_sampleMutex);
+    MemoryMonitorPrivate::smaps_sizes t;
     d->libraries.clear();
     d->readLibraryList = true;
-    d->readData();
+    d->sample(t);
     d->readLibraryList = false;
     return d->libraries;
 }
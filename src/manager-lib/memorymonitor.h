@@ -74,6 +74,7 @@ signals:
 
 private:
     friend class ProcessMonitor;
+    void sampleData();
     void readData();
     void setPid(quint64 pid);
 
@@ -0,0 +1,368 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#include <QCoreApplication>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTimer>
+#include <qnumeric.h>
+#include <algorithm>
+
+#include "global.h"
+#include "metricsexporter.h"
+
+QT_BEGIN_NAMESPACE_AM
+
+/*!
+    \class MetricsExporter
+    \internal
+
+    Serves the metrics registered by the various subsystems in the OpenMetrics text format on a
+    unix-domain socket, so that they can be scraped by external monitoring agents.
+
+    Clients can either send a plain HTTP GET request (e.g. \c{curl --unix-socket}), or just
+    connect and read until the socket is closed.
+
+    All functions have to be called from the main thread.
+*/
+
+namespace {
+enum { RequestTimeout = 100 }; // msec to wait for a HTTP request, before sending the raw data
+
+QByteArray formatValue(qreal value)
+{
+    if (qIsNaN(value))
+        return "NaN";
+    if (qIsInf(value))
+        return value > 0 ? "+Inf" : "-Inf";
+    return QByteArray::number(value, 'g', 16);
+}
+
+QString renderLabels(const MetricsExporter::Labels &labels)
+{
+    if (labels.isEmpty())
+        return QString();
+
+    QString str = qSL("{");
+    for (auto it = labels.cbegin(); it != labels.cend(); ++it) {
+        if (it != labels.cbegin())
+            str.append(qL1C(','));
+        QString value = it.value();
+        value.replace(qL1C('\\'), qSL("\\\\")).replace(qL1C('"'), qSL("\\\"")).replace(qL1C('\n'), qSL("\\n"));
+        str.append(it.key() + qSL("=\"") + value + qL1C('"'));
+    }
+    str.append(qL1C('}'));
+    return str;
+}
+
+QByteArray addLabel(const QByteArray &labels, const QByteArray &name, const QByteArray &value)
+{
+    QByteArray label = name + "=\"" + value + '"';
+    if (labels.isEmpty())
+        return '{' + label + '}';
+    return labels.left(labels.size() - 1) + ',' + label + '}';
+}
+}
+
+MetricsExporter *MetricsExporter::s_instance = 0;
+
+MetricsExporter *MetricsExporter::instance()
+{
+    if (!s_instance)
+        s_instance = new MetricsExporter(QCoreApplication::instance());
+    return s_instance;
+}
+
+MetricsExporter::MetricsExporter(QObject *parent)
+    : QObject(parent)
+{ }
+
+MetricsExporter::~MetricsExporter()
+{
+    s_instance = 0;
+}
+
+void MetricsExporter::initialize(const QVariantMap &configuration)
+{
+    const QString socketName = configuration.value(qSL("socket")).toString();
+    if (socketName.isEmpty() || m_server)
+        return;
+
+    QLocalServer::SocketOptions options = QLocalServer::UserAccessOption;
+    const QString access = configuration.value(qSL("socketAccess")).toString();
+    if (access == qL1S("group"))
+        options |= QLocalServer::GroupAccessOption;
+    else if (access == qL1S("world"))
+        options = QLocalServer::WorldAccessOption;
+
+    m_server = new QLocalServer(this);
+    m_server->setSocketOptions(options);
+
+    bool listening = m_server->listen(socketName);
+    if (!listening && (m_server->serverError() == QAbstractSocket::AddressInUseError)) {
+        // a stale socket from a crashed instance would make listen() fail, but we must not
+        // take over the socket of an instance that is still running
+        QLocalSocket probe;
+        probe.connectToServer(socketName);
+        if (probe.waitForConnected(RequestTimeout)) {
+            probe.abort();
+        } else {
+            QLocalServer::removeServer(socketName);
+            listening = m_server->listen(socketName);
+        }
+    }
+    if (!listening) {
+        qCWarning(LogSystem) << "ERROR: Could not export metrics on" << socketName << ":"
+                             << m_server->errorString();
+        delete m_server;
+        m_server = nullptr;
+        return;
+    }
+    connect(m_server, &QLocalServer::newConnection, this, &MetricsExporter::handleConnections);
+
+    qCDebug(LogSystem) << "Exporting metrics on" << m_server->fullServerName();
+    m_enabled = true;
+}
+
+bool MetricsExporter::isEnabled() const
+{
+    return m_enabled;
+}
+
+// The name of a counter must not have the "_total" suffix: it is added to the samples only.
+void MetricsExporter::registerCounter(const QString &name, const QString &help)
+{
+    registerFamily(name, Counter, help);
+}
+
+void MetricsExporter::registerGauge(const QString &name, const QString &help)
+{
+    registerFamily(name, Gauge, help);
+}
+
+void MetricsExporter::registerHistogram(const QString &name, const QString &help, const QVector<qreal> &buckets)
+{
+    QVector<qreal> sortedBuckets = buckets;
+    std::sort(sortedBuckets.begin(), sortedBuckets.end());
+    registerFamily(name, Histogram, help, sortedBuckets);
+}
+
+void MetricsExporter::registerFamily(const QString &name, Type type, const QString &help, const QVector<qreal> &buckets)
+{
+    auto it = m_families.find(name);
+    if (it != m_families.end()) {
+        if (it->type != type || it->buckets != buckets)
+            qCWarning(LogSystem) << "WARNING: metric" << name << "was already registered with a different type";
+        return;
+    }
+    Family family;
+    family.type = type;
+    family.help = help;
+    family.buckets = buckets;
+    m_families.insert(name, family);
+}
+
+MetricsExporter::Series *MetricsExporter::series(const QString &name, Type type, const Labels &labels)
+{
+    auto it = m_families.find(name);
+    if (it == m_families.end() || it->type != type) {
+        qCWarning(LogSystem) << "WARNING: metric" << name << "is not registered or has a different type";
+        return nullptr;
+    }
+    const QString key = renderLabels(labels);
+    auto sit = it->series.find(key);
+    if (sit == it->series.end()) {
+        sit = it->series.insert(key, Series());
+        if (type == Histogram)
+            sit->bucketCounts.fill(0, it->buckets.size() + 1);
+    }
+    return &sit.value();
+}
+
+void MetricsExporter::incrementCounter(const QString &name, const Labels &labels, qreal delta)
+{
+    if (!m_enabled || delta < 0)
+        return;
+    if (Series *s = series(name, Counter, labels))
+        s->value += delta;
+}
+
+// Counters that are maintained elsewhere (e.g. CPU time in the kernel) are set directly.
+void MetricsExporter::setCounter(const QString &name, const Labels &labels, qreal value)
+{
+    if (!m_enabled)
+        return;
+    if (Series *s = series(name, Counter, labels))
+        s->value = value;
+}
+
+void MetricsExporter::setGauge(const QString &name, const Labels &labels, qreal value)
+{
+    if (!m_enabled)
+        return;
+    if (Series *s = series(name, Gauge, labels))
+        s->value = value;
+}
+
+void MetricsExporter::observe(const QString &name, const Labels &labels, qreal value)
+{
+    if (!m_enabled)
+        return;
+    auto it = m_families.constFind(name);
+    if (Series *s = series(name, Histogram, labels)) {
+        // the buckets' upper bounds are inclusive
+        int bucket = int(std::lower_bound(it->buckets.cbegin(), it->buckets.cend(), value) - it->buckets.cbegin());
+        ++s->bucketCounts[bucket];
+        ++s->count;
+        s->sum += value;
+    }
+}
+
+// Removes all series of a metric, e.g. before a collector is re-creating the ones that still exist.
+void MetricsExporter::clearSeries(const QString &name)
+{
+    auto it = m_families.find(name);
+    if (it != m_families.end())
+        it->series.clear();
+}
+
+void MetricsExporter::registerCollector(QObject *context, const std::function<void()> &collector)
+{
+    m_collectors.append(qMakePair(QPointer<QObject>(context), collector));
+}
+
+QByteArray MetricsExporter::exposition()
+{
+    for (int i = 0; i < m_collectors.size(); ) {
+        if (!m_collectors.at(i).first) {
+            m_collectors.removeAt(i);
+            continue;
+        }
+        m_collectors.at(i).second();
+        ++i;
+    }
+
+    QByteArray out;
+    for (auto it = m_families.cbegin(); it != m_families.cend(); ++it) {
+        const QByteArray name = it.key().toUtf8();
+        const Family &family = it.value();
+
+        static const char *typeNames[] = { "counter", "gauge", "histogram" };
+        out += "# TYPE " + name + ' ' + typeNames[family.type] + '\n';
+        if (!family.help.isEmpty()) {
+            QByteArray help = family.help.toUtf8();
+            help.replace('\\', "\\\\").replace('\n', "\\n");
+            out += "# HELP " + name + ' ' + help + '\n';
+        }
+
+        for (auto sit = family.series.cbegin(); sit != family.series.cend(); ++sit) {
+            const QByteArray labels = sit.key().toUtf8();
+            const Series &s = sit.value();
+
+            switch (family.type) {
+            case Counter:
+                out += name + "_total" + labels + ' ' + formatValue(s.value) + '\n';
+                break;
+            case Gauge:
+                out += name + labels + ' ' + formatValue(s.value) + '\n';
+                break;
+            case Histogram: {
+                quint64 cumulative = 0;
+                for (int i = 0; i < s.bucketCounts.size(); ++i) {
+                    cumulative += s.bucketCounts.at(i);
+                    QByteArray le = (i < family.buckets.size()) ? formatValue(family.buckets.at(i)) : "+Inf";
+                    out += name + "_bucket" + addLabel(labels, "le", le) + ' ' + QByteArray::number(cumulative) + '\n';
+                }
+                out += name + "_count" + labels + ' ' + QByteArray::number(s.count) + '\n';
+                out += name + "_sum" + labels + ' ' + formatValue(s.sum) + '\n';
+                break;
+            }
+            }
+        }
+    }
+    out += "# EOF\n";
+    return out;
+}
+
+void MetricsExporter::handleConnections()
+{
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        m_pendingRequests.insert(socket);
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QObject::destroyed, this, [this, socket]() { m_pendingRequests.remove(socket); });
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { respond(socket, false); });
+        QTimer::singleShot(RequestTimeout, socket, [this, socket]() { respond(socket, true); });
+    }
+}
+
+void MetricsExporter::respond(QLocalSocket *socket, bool timedOut)
+{
+    if (!m_pendingRequests.contains(socket))
+        return;
+
+    // we only need to know whether this is a HTTP request: all the headers are ignored
+    const QByteArray request = socket->peek(16);
+    static const char *methods[] = { "GET ", "HEAD " };
+    bool isHttp = false;
+    for (const char *method : methods) {
+        if (request.startsWith(method))
+            isHttp = true;
+        else if (!timedOut && QByteArray(method).startsWith(request))
+            return; // not enough data yet
+    }
+    m_pendingRequests.remove(socket);
+
+    const QByteArray body = exposition();
+    if (isHttp) {
+        socket->write("HTTP/1.0 200 OK\r\n"
+                      "Content-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                      "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                      "Connection: close\r\n\r\n");
+        if (request.startsWith("GET "))
+            socket->write(body);
+    } else {
+        socket->write(body);
+    }
+    // this waits for the pending data to be written
+    socket->disconnectFromServer();
+}
+
+QT_END_NAMESPACE_AM
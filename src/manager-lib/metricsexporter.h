@@ -0,0 +1,123 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QVariantMap>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include <QPointer>
+#include <functional>
+#include <QtAppManCommon/global.h>
+
+QT_FORWARD_DECLARE_CLASS(QLocalServer)
+QT_FORWARD_DECLARE_CLASS(QLocalSocket)
+
+QT_BEGIN_NAMESPACE_AM
+
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QMap<QString, QString> Labels;
+
+    static MetricsExporter *instance();
+    ~MetricsExporter();
+
+    void initialize(const QVariantMap &configuration);
+    bool isEnabled() const;
+
+    // metric families have to be registered before their values can be changed
+    void registerCounter(const QString &name, const QString &help);
+    void registerGauge(const QString &name, const QString &help);
+    void registerHistogram(const QString &name, const QString &help, const QVector<qreal> &buckets);
+
+    void incrementCounter(const QString &name, const Labels &labels = Labels(), qreal delta = 1);
+    void setCounter(const QString &name, const Labels &labels, qreal value);
+    void setGauge(const QString &name, const Labels &labels, qreal value);
+    void observe(const QString &name, const Labels &labels, qreal value);
+    void clearSeries(const QString &name);
+
+    // called right before every scrape, so gauges can be updated lazily
+    void registerCollector(QObject *context, const std::function<void()> &collector);
+
+    QByteArray exposition();
+
+private:
+    MetricsExporter(QObject *parent = 0);
+    MetricsExporter(const MetricsExporter &);
+    MetricsExporter &operator=(const MetricsExporter &);
+    static MetricsExporter *s_instance;
+
+    enum Type { Counter, Gauge, Histogram };
+
+    struct Series
+    {
+        qreal value = 0;               // counter and gauge
+        QVector<quint64> bucketCounts; // histogram only: non-cumulative, the last one is +Inf
+        quint64 count = 0;
+        qreal sum = 0;
+    };
+
+    struct Family
+    {
+        Type type = Gauge;
+        QString help;
+        QVector<qreal> buckets;
+        QMap<QString, Series> series; // rendered label set -> series
+    };
+
+    void registerFamily(const QString &name, Type type, const QString &help, const QVector<qreal> &buckets = QVector<qreal>());
+    Series *series(const QString &name, Type type, const Labels &labels);
+    void handleConnections();
+    void respond(QLocalSocket *socket, bool timedOut);
+
+    bool m_enabled = false;
+    QLocalServer *m_server = nullptr;
+    QSet<QLocalSocket *> m_pendingRequests;
+    QMap<QString, Family> m_families;
+    QVector<QPair<QPointer<QObject>, std::function<void()>>> m_collectors;
+};
+
+QT_END_NAMESPACE_AM
@@ -254,6 +254,38 @@ void NativeRuntime::stop(bool forceKill)
     }
 }
 
+void NativeRuntime::terminate()
+{
+    if (!m_process) {
+        // there is no process (anymore), so there is nothing to wait for
+        if (m_app)
+            m_app->setCurrentRuntime(0);
+        emit finished(0, QProcess::NormalExit);
+        deleteLater();
+        return;
+    }
+
+    if (!m_shutingDown) {
+        m_shutingDown = true;
+
+        emit aboutToStop();
+        emit stateChanged(state());
+    }
+
+    // in contrast to stop(), we do not delete ourselves here: the caller wants to know, when the
+    // process actually exited - shutdown() will take care of the deletion in this case.
+    m_process->terminate();
+}
+
+void NativeRuntime::kill()
+{
+    if (!m_process)
+        return;
+
+    m_shutingDown = true;
+    m_process->kill();
+}
+
 void NativeRuntime::onProcessStarted()
 {
     m_started = true;
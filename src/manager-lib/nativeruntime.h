@@ -101,6 +101,8 @@ public:
 public slots:
     bool start() override;
     void stop(bool forceKill = false) override;
+    void terminate() override;
+    void kill() override;
 
 signals:
     void aboutToStop(); // used for the ApplicationInterface
@@ -59,6 +59,11 @@ bool PluginContainerManager::supportsQuickLaunch() const
     return m_interface->supportsQuickLaunch();
 }
 
+bool PluginContainerManager::supportsPreparation() const
+{
+    return m_interface->supportsPreparation();
+}
+
 AbstractContainer *PluginContainerManager::create()
 {
     auto containerInterface = m_interface->create();
@@ -109,6 +114,11 @@ void PluginContainer::setBaseDirectory(const QString &baseDirectory)
     m_interface->setBaseDirectory(baseDirectory);
 }
 
+bool PluginContainer::prepare()
+{
+    return m_interface->prepare();
+}
+
 bool PluginContainer::isReady()
 {
     return m_interface->isReady();
@@ -136,6 +146,21 @@ AbstractContainerProcess *PluginContainer::start(const QStringList &arguments, c
     return nullptr;
 }
 
+qint64 PluginContainer::cpuTime() const
+{
+    return m_interface->cpuTime();
+}
+
+qint64 PluginContainer::memoryUsage() const
+{
+    return m_interface->memoryUsage();
+}
+
+bool PluginContainer::ioCounters(quint64 *readBytes, quint64 *writtenBytes) const
+{
+    return m_interface->ioCounters(readBytes, writtenBytes);
+}
+
 PluginContainer::PluginContainer(ContainerInterface *containerInterface, AbstractContainerManager *manager)
     : AbstractContainer(manager)
     , m_interface(containerInterface)
@@ -144,6 +169,7 @@ PluginContainer::PluginContainer(ContainerInterface *containerInterface, Abstrac
     m_process->setParent(this);
 
     connect(containerInterface, &ContainerInterface::ready, this, &PluginContainer::ready);
+    connect(containerInterface, &ContainerInterface::preparationFailed, this, &PluginContainer::preparationFailed);
     connect(containerInterface, &ContainerInterface::started, m_process, &PluginContainerProcess::started);
     connect(containerInterface, &ContainerInterface::errorOccured, m_process, &PluginContainerProcess::errorOccured);
     connect(containerInterface, &ContainerInterface::finished, m_process, &PluginContainerProcess::finished);
@@ -54,6 +54,7 @@ public:
 
     static QString defaultIdentifier();
     bool supportsQuickLaunch() const override;
+    bool supportsPreparation() const override;
 
     AbstractContainer *create() override;
     AbstractContainer *create(const ContainerDebugWrapper &debugWrapper) override;
@@ -99,6 +100,7 @@ public:
     bool setProgram(const QString &program) override;
     void setBaseDirectory(const QString &baseDirectory) override;
 
+    bool prepare() override;
     bool isReady() override;
 
     QString mapContainerPathToHost(const QString &containerPath) const override;
@@ -106,6 +108,10 @@ public:
 
     AbstractContainerProcess *start(const QStringList &arguments, const QProcessEnvironment &env) override;
 
+    qint64 cpuTime() const override;
+    qint64 memoryUsage() const override;
+    bool ioCounters(quint64 *readBytes, quint64 *writtenBytes) const override;
+
 protected:
     explicit PluginContainer(ContainerInterface *containerInterface, AbstractContainerManager *manager);
     ContainerInterface *m_interface;
@@ -49,6 +49,31 @@
 #  include <unistd.h>
 #  include <fcntl.h>
 #endif
+#if defined(Q_OS_LINUX)
+#  include <QCoreApplication>
+#  include <QSocketNotifier>
+#  include <QStandardPaths>
+#  include <QTimer>
+#  include <cerrno>
+#  include <cstring>
+#  include <pthread.h>
+#  include <sys/syscall.h>
+#  include <sys/wait.h>
+#  if !defined(SYS_pidfd_open)
+#    define SYS_pidfd_open 434
+#  endif
+#  if !defined(SYS_clone3)
+#    define SYS_clone3 435
+#  endif
+#  if !defined(CLONE_PIDFD)
+#    define CLONE_PIDFD 0x00001000
+#  endif
+#  if !defined(CLONE_INTO_CGROUP)
+#    define CLONE_INTO_CGROUP 0x200000000ULL
+#  endif
+#  include "controlgroupv2.h"
+#  include "sysfsreader.h"
+#endif
 
 QT_BEGIN_NAMESPACE_AM
 
@@ -121,6 +146,346 @@ void HostProcess::setStopBeforeExec(bool stopBeforeExec)
 }
 
 
+#if defined(Q_OS_LINUX)
+
+static int pidfdOpen(pid_t pid)
+{
+    return int(::syscall(SYS_pidfd_open, pid, 0));
+}
+
+// struct clone_args from linux/sched.h (Linux 5.7)
+struct CloneArgs
+{
+    quint64 flags;
+    quint64 pidfd;
+    quint64 child_tid;
+    quint64 parent_tid;
+    quint64 exit_signal;
+    quint64 stack;
+    quint64 stack_size;
+    quint64 tls;
+    quint64 set_tid;
+    quint64 set_tid_size;
+    quint64 cgroup;
+};
+
+SpawnedHostProcess::SpawnedHostProcess()
+{ }
+
+SpawnedHostProcess::~SpawnedHostProcess()
+{
+    // just like QProcess: kill a still running process and do not leave a zombie behind
+    if (m_pid > 0) {
+        ::kill(pid_t(m_pid), SIGKILL);
+        int status;
+        while ((::waitpid(pid_t(m_pid), &status, 0) < 0) && (errno == EINTR))
+            ;
+    }
+    if (m_pidFd >= 0)
+        ::close(m_pidFd);
+}
+
+bool SpawnedHostProcess::isSupported()
+{
+    // pidfds are available since Linux 5.3
+    static int supported = -1;
+    if (supported < 0) {
+        int fd = pidfdOpen(::getpid());
+        supported = (fd >= 0) ? 1 : 0;
+        if (fd >= 0)
+            ::close(fd);
+    }
+    return (supported == 1);
+}
+
+void SpawnedHostProcess::start(const QString &program, const QStringList &arguments)
+{
+    if (m_state != QProcess::NotRunning)
+        return;
+    setState(QProcess::Starting);
+
+    // Everything the child needs has to be prepared up-front: after vfork() we are only
+    // allowed to call async-signal-safe functions.
+    QString executable = program;
+    if (!executable.contains(qL1C('/')))
+        executable = QStandardPaths::findExecutable(program);
+    if (executable.isEmpty()) {
+        qCWarning(LogSystem) << "Could not find the executable" << program;
+        failToStart();
+        return;
+    }
+
+    QVector<QByteArray> argStrings;
+    argStrings.reserve(arguments.size() + 1);
+    argStrings << QFile::encodeName(executable);
+    for (const QString &arg : arguments)
+        argStrings << arg.toLocal8Bit();
+    QVector<char *> argv;
+    argv.reserve(argStrings.size() + 1);
+    for (QByteArray &arg : argStrings)
+        argv << arg.data();
+    argv << nullptr;
+
+    QVector<QByteArray> envStrings;
+    const QStringList envList = m_environment.toStringList();
+    envStrings.reserve(envList.size());
+    for (const QString &env : envList)
+        envStrings << env.toLocal8Bit();
+    QVector<char *> envp;
+    envp.reserve(envStrings.size() + 1);
+    for (QByteArray &env : envStrings)
+        envp << env.data();
+    envp << nullptr;
+
+    const QByteArray workingDirectory = QFile::encodeName(m_workingDirectory);
+    const char *cwd = workingDirectory.isEmpty() ? nullptr : workingDirectory.constData();
+    int redirections[3];
+    for (int i = 0; i < 3; ++i)
+        redirections[i] = m_stdRedirections.value(i, -1);
+    char **argvData = argv.data();
+    char **envpData = envp.data();
+    const bool stopBeforeExec = m_stopBeforeExec;
+
+    // a failing chdir() or exec() in the child is reported back via this pipe - it is closed
+    // automatically by a successful exec()
+    int execPipe[2];
+    if (::pipe2(execPipe, O_CLOEXEC) < 0) {
+        qCWarning(LogSystem) << "Could not create a pipe to start" << program << ":" << strerror(errno);
+        failToStart();
+        return;
+    }
+
+    pid_t pid = -1;
+    int pidFd = -1;
+    m_startedInControlGroup = false;
+
+    // Just like QProcess/forkfd: the vfork()ed child shares our memory, so a signal arriving
+    // before exec() must not run one of our handlers in the child. All signals are blocked
+    // around the fork and the child resets the caught ones, before it restores the mask.
+    sigset_t allSignals;
+    sigset_t oldMask;
+    ::sigfillset(&allSignals);
+    ::pthread_sigmask(SIG_SETMASK, &allSignals, &oldMask);
+
+    // Start the child directly in its cgroup, so it never runs unconstrained. This needs
+    // clone3() with CLONE_INTO_CGROUP (Linux 5.7): there is no CLONE_VM, since that would
+    // require a separate stack, but CLONE_VFORK still saves us from waiting on the pipe.
+    if (m_controlGroupFd >= 0) {
+        CloneArgs args;
+        memset(&args, 0, sizeof(args));
+        args.flags = CLONE_INTO_CGROUP | CLONE_PIDFD | (stopBeforeExec ? 0 : CLONE_VFORK);
+        args.pidfd = quint64(quintptr(&pidFd));
+        args.exit_signal = SIGCHLD;
+        args.cgroup = quint64(m_controlGroupFd);
+
+        pid = pid_t(::syscall(SYS_clone3, &args, sizeof(args)));
+        if (pid > 0)
+            m_startedInControlGroup = true;
+        else if (pid < 0)
+            qCDebug(LogSystem) << "Could not start" << program << "via clone3 in its cgroup:" << strerror(errno);
+    }
+
+    // vfork() suspends us until the child called exec(), so we need a real fork(), if the child
+    // is supposed to stop itself before that
+    if (pid < 0)
+        pid = stopBeforeExec ? ::fork() : ::vfork();
+
+    if (pid == 0) {
+        for (int sig = 1; sig < NSIG; ++sig) {
+            struct sigaction sa;
+            if ((::sigaction(sig, nullptr, &sa) == 0) && !(sa.sa_flags & SA_SIGINFO)
+                    && ((sa.sa_handler == SIG_DFL) || (sa.sa_handler == SIG_IGN))) {
+                continue;
+            }
+            memset(&sa, 0, sizeof(sa));
+            sa.sa_handler = SIG_DFL;
+            ::sigaction(sig, &sa, nullptr);
+        }
+
+        if (stopBeforeExec) {
+            fprintf(stderr, "\n*** a 'process' container was started in stopped state ***\nthe process is suspended via SIGSTOP and you can attach a debugger to it via\n\n   gdb -p %d\n\n", getpid());
+            // not raise(): the thread-id cached by libc is not valid after a raw clone3()
+            ::kill(getpid(), SIGSTOP);
+        }
+        for (int i = 0; i < 3; ++i) {
+            if (redirections[i] >= 0)
+                ::dup2(redirections[i], i);
+        }
+        if (!cwd || (::chdir(cwd) == 0)) {
+            ::pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+            ::execve(argvData[0], argvData, envpData);
+        }
+
+        int error = errno;
+        if (::write(execPipe[1], &error, sizeof(error))) { }
+        ::_exit(127);
+    }
+
+    ::pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+    ::close(execPipe[1]);
+
+    if (pid < 0) {
+        qCWarning(LogSystem) << "Could not fork to start" << program << ":" << strerror(errno);
+        ::close(execPipe[0]);
+        failToStart();
+        return;
+    }
+
+    // with fork(), the child might wait for a debugger, so we cannot block on the pipe
+    if (!stopBeforeExec) {
+        int error = 0;
+        ssize_t bytesRead;
+        while (((bytesRead = ::read(execPipe[0], &error, sizeof(error))) < 0) && (errno == EINTR))
+            ;
+        if (bytesRead == sizeof(error)) {
+            qCWarning(LogSystem) << "Could not start" << program << ":" << strerror(error);
+            ::close(execPipe[0]);
+            if (pidFd >= 0)
+                ::close(pidFd);
+            int status;
+            while ((::waitpid(pid, &status, 0) < 0) && (errno == EINTR))
+                ;
+            failToStart();
+            return;
+        }
+    }
+    ::close(execPipe[0]);
+
+    m_pid = pid;
+    m_pidFd = (pidFd >= 0) ? pidFd : pidfdOpen(pid); // works even if the child already exited, since it is not reaped yet
+    if (m_pidFd < 0) {
+        qCWarning(LogSystem) << "Could not monitor process" << pid << ":" << strerror(errno);
+        ::kill(pid, SIGKILL);
+        int status;
+        while ((::waitpid(pid, &status, 0) < 0) && (errno == EINTR))
+            ;
+        m_pid = 0;
+        failToStart();
+        return;
+    }
+
+    // the runtime connects to our signals only after start() returned
+    QTimer::singleShot(0, this, [this]() {
+        if (m_state != QProcess::Starting)
+            return;
+        m_exitNotifier = new QSocketNotifier(m_pidFd, QSocketNotifier::Read, this);
+        connect(m_exitNotifier, &QSocketNotifier::activated, this, &SpawnedHostProcess::reap);
+        setState(QProcess::Running);
+        emit started();
+    });
+}
+
+void SpawnedHostProcess::failToStart()
+{
+    QTimer::singleShot(0, this, [this]() {
+        setState(QProcess::NotRunning);
+        emit errorOccured(QProcess::FailedToStart);
+    });
+}
+
+void SpawnedHostProcess::reap()
+{
+    int status = 0;
+    pid_t result;
+    while (((result = ::waitpid(pid_t(m_pid), &status, WNOHANG)) < 0) && (errno == EINTR))
+        ;
+    if (result == 0)
+        return; // still running
+
+    if (m_exitNotifier) {
+        m_exitNotifier->setEnabled(false);
+        m_exitNotifier->deleteLater();
+        m_exitNotifier = nullptr;
+    }
+    ::close(m_pidFd);
+    m_pidFd = -1;
+    m_pid = 0;
+
+    bool crashed = (result < 0) || WIFSIGNALED(status);
+    int exitCode = (result < 0) ? -1 : (crashed ? WTERMSIG(status) : WEXITSTATUS(status));
+
+    if (crashed)
+        emit errorOccured(QProcess::Crashed);
+    setState(QProcess::NotRunning);
+    emit finished(exitCode, crashed ? QProcess::CrashExit : QProcess::NormalExit);
+}
+
+void SpawnedHostProcess::setWorkingDirectory(const QString &dir)
+{
+    m_workingDirectory = dir;
+}
+
+void SpawnedHostProcess::setProcessEnvironment(const QProcessEnvironment &environment)
+{
+    m_environment = environment;
+}
+
+void SpawnedHostProcess::kill()
+{
+    if (m_pid > 0)
+        ::kill(pid_t(m_pid), SIGKILL);
+}
+
+void SpawnedHostProcess::terminate()
+{
+    if (m_pid > 0)
+        ::kill(pid_t(m_pid), SIGTERM);
+}
+
+qint64 SpawnedHostProcess::processId() const
+{
+    return m_pid;
+}
+
+QProcess::ProcessState SpawnedHostProcess::state() const
+{
+    return m_state;
+}
+
+void SpawnedHostProcess::setRedirections(const QVector<int> &stdRedirections)
+{
+    m_stdRedirections = stdRedirections;
+}
+
+void SpawnedHostProcess::setStopBeforeExec(bool stopBeforeExec)
+{
+    m_stopBeforeExec = stopBeforeExec;
+}
+
+void SpawnedHostProcess::setControlGroupDirectory(int fd)
+{
+    m_controlGroupFd = fd;
+}
+
+bool SpawnedHostProcess::startedInControlGroup() const
+{
+    return m_startedInControlGroup;
+}
+
+void SpawnedHostProcess::setState(QProcess::ProcessState state)
+{
+    if (state != m_state) {
+        m_state = state;
+        emit stateChanged(state);
+    }
+}
+
+#endif // Q_OS_LINUX
+
+template <typename T> static T *startHostProcess(T *process, const QString &command, const QStringList &arguments,
+                                                 const QString &workingDirectory, const QProcessEnvironment &environment,
+                                                 const QVector<int> &stdRedirections, bool stopBeforeExec)
+{
+    process->setWorkingDirectory(workingDirectory);
+    process->setProcessEnvironment(environment);
+    process->setStopBeforeExec(stopBeforeExec);
+    if (!stdRedirections.isEmpty())
+        process->setRedirections(stdRedirections);
+    process->start(command, arguments);
+    return process;
+}
+
+
 
 ProcessContainer::ProcessContainer(ProcessContainerManager *manager)
     : AbstractContainer(manager)
@@ -133,7 +498,12 @@ ProcessContainer::ProcessContainer(const ContainerDebugWrapper &debugWrapper, Pr
 { }
 
 ProcessContainer::~ProcessContainer()
-{ }
+{
+#if defined(Q_OS_LINUX)
+    if (!m_controlGroupV2Leaf.isEmpty() && !m_controlGroupV2Path.isEmpty())
+        ControlGroupV2::remove(m_controlGroupV2Path);
+#endif
+}
 
 QString ProcessContainer::controlGroup() const
 {
@@ -144,6 +514,13 @@ bool ProcessContainer::setControlGroup(const QString &groupName)
 {
     if (groupName == m_currentControlGroup)
         return true;
+    if (!m_process)
+        return false;
+
+#if defined(Q_OS_LINUX)
+    if (ControlGroupV2::isAvailable())
+        return setControlGroupV2(groupName);
+#endif
 
     QVariantMap map = m_manager->configuration().value(qSL("controlGroups")).toMap();
     auto git = map.constFind(groupName);
@@ -174,6 +551,82 @@ bool ProcessContainer::setControlGroup(const QString &groupName)
     return false;
 }
 
+#if defined(Q_OS_LINUX)
+
+QString ProcessContainer::controlGroupV2LeafPath(const QString &groupName)
+{
+    if (!configuration().value(qSL("controlGroupPerProcess")).toBool())
+        return static_cast<ProcessContainerManager *>(m_manager)->controlGroupV2Path(groupName);
+
+    // a process can only be moved between cgroups, so every container gets its own leaf in
+    // every class
+    if (m_controlGroupV2Leaf.isEmpty()) {
+        static int leafCounter = 0;
+        m_controlGroupV2Leaf = qSL("process-%1-%2").arg(QCoreApplication::applicationPid()).arg(++leafCounter);
+    }
+    return static_cast<ProcessContainerManager *>(m_manager)->controlGroupV2LeafPath(groupName, m_controlGroupV2Leaf);
+}
+
+bool ProcessContainer::setControlGroupV2(const QString &groupName)
+{
+    if (!m_process)
+        return false;
+
+    QString path = controlGroupV2LeafPath(groupName);
+    if (path.isEmpty())
+        return false;
+
+    // move the whole process tree: an application might have forked helpers already
+    foreach (quint64 pid, processTree(m_process->processId())) {
+        if (!ControlGroupV2::addProcess(path, pid) && (pid == quint64(m_process->processId()))) {
+            qCWarning(LogSystem) << "Failed setting cgroup for" << m_program << ", pid" << pid << "->" << path;
+            return false;
+        }
+    }
+    if (!m_controlGroupV2Leaf.isEmpty() && !m_controlGroupV2Path.isEmpty() && (m_controlGroupV2Path != path))
+        ControlGroupV2::remove(m_controlGroupV2Path);
+
+    m_controlGroupV2Path = path;
+    m_currentControlGroup = groupName;
+    return true;
+}
+
+// The cgroup can only be used for accounting, if the application is the only one in it: in all
+// other cases the ProcessMonitor falls back to the per-process values in /proc. Please note that
+// the counters start from 0 again, whenever the process is moved into the leaf of another group.
+// The SystemMonitor reads the files of the accountingControlGroup() on its sampling thread.
+
+QString ProcessContainer::accountingControlGroup() const
+{
+    return m_controlGroupV2Leaf.isEmpty() ? QString() : m_controlGroupV2Path;
+}
+
+qint64 ProcessContainer::cpuTime() const
+{
+    const QString path = accountingControlGroup();
+    return path.isEmpty() ? -1 : ControlGroupV2::cpuTime(path);
+}
+
+qint64 ProcessContainer::memoryUsage() const
+{
+    const QString path = accountingControlGroup();
+    return path.isEmpty() ? -1 : ControlGroupV2::memoryUsage(path);
+}
+
+bool ProcessContainer::ioCounters(quint64 *readBytes, quint64 *writtenBytes) const
+{
+    const QString path = accountingControlGroup();
+    return !path.isEmpty() && ControlGroupV2::ioCounters(path, readBytes, writtenBytes);
+}
+
+bool ProcessContainer::memoryStatistics(quint64 *anonymous, quint64 *file, quint64 *kernel) const
+{
+    const QString path = accountingControlGroup();
+    return !path.isEmpty() && ControlGroupV2::memoryStatistics(path, anonymous, file, kernel);
+}
+
+#endif // Q_OS_LINUX
+
 bool ProcessContainer::isReady()
 {
     return true;
@@ -192,28 +645,63 @@ AbstractContainerProcess *ProcessContainer::start(const QStringList &arguments,
     if (completeEnv.isEmpty())
         completeEnv = QProcessEnvironment::systemEnvironment();
 
-    HostProcess *process = new HostProcess();
-    process->setWorkingDirectory(m_baseDirectory);
-    process->setProcessEnvironment(completeEnv);
-    process->setStopBeforeExec(configuration().value(qSL("stopBeforeExec")).toBool());
-
     QString command = m_program;
     QStringList args = arguments;
+    QVector<int> stdRedirections;
+    bool stopBeforeExec = configuration().value(qSL("stopBeforeExec")).toBool();
 
     if (m_useDebugWrapper) {
         m_debugWrapper.resolveParameters(m_program, arguments);
-        process->setRedirections(m_debugWrapper.stdRedirections());
+        stdRedirections = m_debugWrapper.stdRedirections();
 
         command = m_debugWrapper.command().at(0);
         args = m_debugWrapper.command().mid(1);
     }
     qCDebug(LogSystem) << "Running command:" << command << args;
 
-    process->start(command, args);
-    m_process = process;
+    const QString defaultControlGroup = configuration().value(qSL("defaultControlGroup")).toString();
 
-    setControlGroup(configuration().value(qSL("defaultControlGroup")).toString());
-    return process;
+#if defined(Q_OS_LINUX)
+    if (configuration().value(qSL("processBackend")).toString() == qSL("spawn")) {
+        if (SpawnedHostProcess::isSupported()) {
+            SpawnedHostProcess *process = new SpawnedHostProcess();
+
+            // cgroup v2: try to create the process directly in its default cgroup
+            QString cgroupPath;
+            int cgroupFd = -1;
+            if (!defaultControlGroup.isEmpty() && ControlGroupV2::isAvailable()) {
+                cgroupPath = controlGroupV2LeafPath(defaultControlGroup);
+                if (!cgroupPath.isEmpty())
+                    cgroupFd = ControlGroupV2::openDirectory(cgroupPath);
+            }
+            process->setControlGroupDirectory(cgroupFd);
+
+            m_process = startHostProcess(process, command, args, m_baseDirectory,
+                                         completeEnv, stdRedirections, stopBeforeExec);
+            if (cgroupFd >= 0)
+                ::close(cgroupFd);
+
+            if (process->startedInControlGroup()) {
+                m_controlGroupV2Path = cgroupPath;
+                m_currentControlGroup = defaultControlGroup;
+                return m_process;
+            }
+        } else {
+            static bool once = false;
+            if (!once) {
+                qCWarning(LogSystem) << "The 'spawn' process backend needs pidfd support (Linux 5.3) - falling back to QProcess";
+                once = true;
+            }
+        }
+    }
+#endif
+    if (!m_process) {
+        m_process = startHostProcess(new HostProcess(), command, args, m_baseDirectory,
+                                     completeEnv, stdRedirections, stopBeforeExec);
+    }
+
+    setControlGroup(defaultControlGroup);
+    return m_process;
 }
 
 ProcessContainerManager::ProcessContainerManager(QObject *parent)
@@ -244,6 +732,99 @@ AbstractContainer *ProcessContainerManager::create(const ContainerDebugWrapper &
     return new ProcessContainer(debugWrapper, this);
 }
 
+#if defined(Q_OS_LINUX)
+
+/*! \internal
+    Returns the cgroup v2 path (relative to the cgroup2 mount point) for the control group class
+    \a groupName. The cgroup is created below \c controlGroupRoot the first time it is used and
+    all the interface files from its \c controlGroups entry (e.g. \c cpu.weight, \c memory.high,
+    \c memory.max or \c io.weight) are applied to it. Returns an empty string, if the class is
+    not configured.
+*/
+QString ProcessContainerManager::controlGroupV2Path(const QString &groupName)
+{
+    QVariantMap map = configuration().value(qSL("controlGroups")).toMap();
+    auto git = map.constFind(groupName);
+    if (git == map.constEnd())
+        return QString();
+
+    QString root = configuration().value(qSL("controlGroupRoot")).toString();
+    if (root.startsWith(qL1C('/'))) {
+        while (root.startsWith(qL1C('/')))
+            root.remove(0, 1);
+    } else {
+        // relative to our own (delegated) cgroup, instead of a top-level cgroup next to systemd's
+        const QString ownPath = ControlGroupV2::ownPath();
+        if (!ownPath.isEmpty())
+            root = root.isEmpty() ? ownPath : ownPath + qL1C('/') + root;
+
+        // the no-internal-processes rule: our own cgroup cannot have any processes, if we want to
+        // enable controllers for its children, so we move ourselves into a leaf first
+        if (!ownPath.isEmpty() && m_preparedControlGroups.isEmpty()) {
+            const QString managerPath = ownPath + qSL("/manager");
+            if (!ControlGroupV2::create(managerPath)
+                    || !ControlGroupV2::moveAllProcesses(ownPath, managerPath)) {
+                qCWarning(LogSystem) << "Could not move the application-manager into the cgroup" << managerPath;
+            }
+        }
+    }
+    QString path = root.isEmpty() ? groupName : root + qL1C('/') + groupName;
+
+    if (!m_preparedControlGroups.contains(groupName)) {
+        // the per-process leaves only get the controllers that are enabled in the class
+        QStringList subtreeControllers;
+        if (configuration().value(qSL("controlGroupPerProcess")).toBool())
+            subtreeControllers = controlGroupV2LeafControllers(groupName);
+
+        if (!ControlGroupV2::create(path, controlGroupV2InterfaceFiles(groupName), subtreeControllers))
+            qCWarning(LogSystem) << "Could not completely set up the cgroup" << path << "for control group" << groupName;
+        m_preparedControlGroups << groupName;
+    }
+    return path;
+}
+
+/*! \internal
+    Returns the cgroup v2 path of the per-process leaf \a leafName in the cgroup of the control
+    group class \a groupName and creates it, if needed. Returns an empty string on failure.
+*/
+QString ProcessContainerManager::controlGroupV2LeafPath(const QString &groupName, const QString &leafName)
+{
+    QString path = controlGroupV2Path(groupName);
+    if (path.isEmpty())
+        return path;
+    path = path + qL1C('/') + leafName;
+    return ControlGroupV2::create(path) ? path : QString();
+}
+
+/*! \internal
+    Returns the controllers that have to be enabled in the class cgroup \a groupName for its
+    per-process leaves: the ones the class uses, plus \c memory and \c io, since the accounting
+    of the ProcessMonitor needs the leaf's \c memory.current, \c memory.stat and \c io.stat.
+*/
+QStringList ProcessContainerManager::controlGroupV2LeafControllers(const QString &groupName) const
+{
+    QStringList controllers = ControlGroupV2::controllers(controlGroupV2InterfaceFiles(groupName));
+    for (const QString &controller : { qSL("memory"), qSL("io") }) {
+        if (!controllers.contains(controller))
+            controllers << controller;
+    }
+    return controllers;
+}
+
+QVariantMap ProcessContainerManager::controlGroupV2InterfaceFiles(const QString &groupName) const
+{
+    // v1 style entries (resource: class) are ignored - v2 entries are interface files
+    QVariantMap interfaceFiles;
+    const QVariantMap mapping = configuration().value(qSL("controlGroups")).toMap().value(groupName).toMap();
+    for (auto it = mapping.cbegin(); it != mapping.cend(); ++it) {
+        if (it.key().contains(qL1C('.')))
+            interfaceFiles.insert(it.key(), it.value());
+    }
+    return interfaceFiles;
+}
+
+#endif // Q_OS_LINUX
+
 void HostProcess::MyQProcess::setupChildProcess()
 {
 #if defined(Q_OS_UNIX)
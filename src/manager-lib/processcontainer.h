@@ -45,6 +45,8 @@
 
 #define AM_HOST_CONTAINER_AVAILABLE
 
+QT_FORWARD_DECLARE_CLASS(QSocketNotifier)
+
 QT_BEGIN_NAMESPACE_AM
 
 class ProcessContainerManager : public AbstractContainerManager
@@ -59,6 +61,17 @@ public:
 
     AbstractContainer *create() override;
     AbstractContainer *create(const ContainerDebugWrapper &debugWrapper) override;
+
+#if defined(Q_OS_LINUX)
+    QString controlGroupV2Path(const QString &groupName);
+    QString controlGroupV2LeafPath(const QString &groupName, const QString &leafName);
+    QStringList controlGroupV2LeafControllers(const QString &groupName) const;
+
+private:
+    QVariantMap controlGroupV2InterfaceFiles(const QString &groupName) const;
+
+    QStringList m_preparedControlGroups;
+#endif
 };
 
 class HostProcess : public AbstractContainerProcess
@@ -95,6 +108,56 @@ private:
     MyQProcess m_process;
 };
 
+#if defined(Q_OS_LINUX)
+
+// Starts the process directly via vfork/exec and monitors its exit via a pidfd, which avoids
+// most of QProcess' per-process overhead (channel setup, SIGCHLD pipes, environment handling)
+class SpawnedHostProcess : public AbstractContainerProcess
+{
+    Q_OBJECT
+
+public:
+    SpawnedHostProcess();
+    ~SpawnedHostProcess();
+
+    static bool isSupported();
+
+    virtual qint64 processId() const override;
+    virtual QProcess::ProcessState state() const override;
+
+    void setRedirections(const QVector<int> &stdRedirections);
+
+public slots:
+    void kill() override;
+    void terminate() override;
+
+    void start(const QString &program, const QStringList &arguments);
+    void setWorkingDirectory(const QString &dir) override;
+    void setProcessEnvironment(const QProcessEnvironment &environment) override;
+    void setStopBeforeExec(bool stopBeforeExec);
+    void setControlGroupDirectory(int fd);
+    bool startedInControlGroup() const;
+
+private:
+    void setState(QProcess::ProcessState state);
+    void failToStart();
+    void reap();
+
+    QString m_workingDirectory;
+    QProcessEnvironment m_environment;
+    QVector<int> m_stdRedirections;
+    bool m_stopBeforeExec = false;
+    int m_controlGroupFd = -1;
+    bool m_startedInControlGroup = false;
+
+    qint64 m_pid = 0;
+    int m_pidFd = -1;
+    QSocketNotifier *m_exitNotifier = nullptr;
+    QProcess::ProcessState m_state = QProcess::NotRunning;
+};
+
+#endif // Q_OS_LINUX
+
 class ProcessContainer : public AbstractContainer
 {
     Q_OBJECT
@@ -111,7 +174,22 @@ public:
 
     AbstractContainerProcess *start(const QStringList &arguments, const QProcessEnvironment &environment) override;
 
+#if defined(Q_OS_LINUX)
+    QString accountingControlGroup() const override;
+    qint64 cpuTime() const override;
+    qint64 memoryUsage() const override;
+    bool ioCounters(quint64 *readBytes, quint64 *writtenBytes) const override;
+    bool memoryStatistics(quint64 *anonymous, quint64 *file, quint64 *kernel) const override;
+#endif
+
 private:
+#if defined(Q_OS_LINUX)
+    QString controlGroupV2LeafPath(const QString &groupName);
+    bool setControlGroupV2(const QString &groupName);
+
+    QString m_controlGroupV2Path; // the cgroup v2 the process currently lives in
+    QString m_controlGroupV2Leaf; // only set, if every process gets its own cgroup
+#endif
     QString m_currentControlGroup;
     bool m_useDebugWrapper = false;
     ContainerDebugWrapper m_debugWrapper;
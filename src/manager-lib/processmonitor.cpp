@@ -43,20 +43,90 @@
 #include <QCoreApplication>
 #include "processmonitor.h"
 #include "memorymonitor.h"
+#include "cpumonitor.h"
+#include "iomonitor.h"
 #include "application.h"
 #include "applicationmanager.h"
 #include "abstractruntime.h"
+#include "abstractcontainer.h"
 
 #if defined(Q_OS_UNIX)
 #  include <unistd.h>
 #endif
+#if defined(Q_OS_LINUX)
+#  include <QFile>
+#  include "sysfsreader.h"
+#  include "controlgroupv2.h"
+#endif
 
 QT_BEGIN_NAMESPACE_AM
 
+#if defined(Q_OS_LINUX)
+// The fallbacks for the resource usage, if the container cannot account for it. Files that
+// have not been added to the ProcFsPrefetcher are just read synchronously.
+
+static qint64 procCpuTime(quint64 pid, ProcFsPrefetcher *procFs)
+{
+    // the command name can contain spaces and parentheses: skip to the last ')'
+    QByteArray stat = procFs->read(pid, ProcFsPrefetcher::Stat);
+    int pos = stat.lastIndexOf(')');
+    if (pos < 0)
+        return -1;
+    QList<QByteArray> fields = stat.mid(pos + 2).split(' ');
+    // utime and stime are fields 14 and 15, but we start counting at field 3 (state)
+    if (fields.size() > 12) {
+        static const qint64 ticksPerSecond = sysconf(_SC_CLK_TCK);
+        qint64 ticks = fields.at(11).toLongLong() + fields.at(12).toLongLong();
+        return ticks * 1000000 / ticksPerSecond;
+    }
+    return -1;
+}
+
+static qint64 procMemoryUsage(quint64 pid, ProcFsPrefetcher *procFs)
+{
+    QList<QByteArray> fields = procFs->read(pid, ProcFsPrefetcher::Statm).split(' ');
+    if (fields.size() > 1) {
+        static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+        return fields.at(1).toLongLong() * pageSize;
+    }
+    return -1;
+}
+
+// summed up over the whole process tree of the application
+static bool procIoCounters(quint64 pid, quint64 *readBytes, quint64 *writtenBytes, ProcFsPrefetcher *procFs)
+{
+    quint64 r = 0, w = 0;
+    bool found = false;
+    foreach (quint64 p, procFs->processTree(pid)) {
+        // only readable by the owner of the process
+        const QByteArray io = procFs->read(p, ProcFsPrefetcher::Io);
+        if (io.isEmpty())
+            continue;
+        foreach (const QByteArray &line, io.split('\n')) {
+            if (line.startsWith("read_bytes: "))
+                r += line.mid(12).toULongLong();
+            else if (line.startsWith("write_bytes: "))
+                w += line.mid(13).toULongLong();
+        }
+        found = true;
+    }
+    if (found) {
+        if (readBytes)
+            *readBytes = r;
+        if (writtenBytes)
+            *writtenBytes = w;
+    }
+    return found;
+}
+#endif
+
 ProcessMonitor::ProcessMonitor(const QString &appId, QObject *parent)
     : QObject(parent)
     , m_memoryMonitor(nullptr)
+    , m_cpuMonitor(nullptr)
     , m_memoryReportingEnabled(false)
+    , m_cpuReportingEnabled(false)
+    , m_fpsReportingEnabled(false)
     , m_appId(appId)
     , m_pid(0)
 {
@@ -66,6 +136,9 @@ ProcessMonitor::ProcessMonitor(const QString &appId, QObject *parent)
 ProcessMonitor::~ProcessMonitor()
 {
     delete m_memoryMonitor;
+    delete m_cpuMonitor;
+    delete m_ioMonitor;
+    qDeleteAll(m_fpsMonitors);
 }
 
 bool ProcessMonitor::isMemoryReportingEnabled() const
@@ -93,43 +166,267 @@ void ProcessMonitor::setMemoryReportingEnabled(bool memoryReportingEnabled)
         m_memoryMonitor->setPid(m_pid);
     }
 
+    m_sampledMemoryMonitor.storeRelease(memoryReportingEnabled ? m_memoryMonitor : nullptr);
     m_memoryReportingEnabled = memoryReportingEnabled;
     emit memoryReportingEnabledChanged();
 }
 
 bool ProcessMonitor::isCpuLoadReportingEnabled() const
 {
-    return false;
+    return m_cpuReportingEnabled;
 }
 
 void ProcessMonitor::setCpuLoadReportingEnabled(bool cpuReportingEnabled)
 {
-    Q_UNUSED(cpuReportingEnabled)
+    if (m_cpuReportingEnabled == cpuReportingEnabled)
+        return;
+
+    if (cpuReportingEnabled) {
+        obtainPid();
+        if (m_pid == 0) {
+            qCWarning(LogSystem) << "WARNING: could not get Pid for app:" << m_appId;
+            return;
+        }
+
+        if (!m_cpuMonitor) {
+            m_cpuMonitor = new CpuMonitor();
+            emit cpuMonitorChanged();
+        }
+
+        m_cpuMonitor->setPid(m_pid);
+        updateSampledProcess();
+    }
+
+    m_sampledCpuMonitor.storeRelease(cpuReportingEnabled ? m_cpuMonitor : nullptr);
+    m_cpuReportingEnabled = cpuReportingEnabled;
+    emit cpuLoadReportingEnabledChanged();
 }
 
 bool ProcessMonitor::isFpsReportingEnabled() const
 {
-    return false;
+    return m_fpsReportingEnabled;
 }
 
 void ProcessMonitor::setFpsReportingEnabled(bool fpsReportingEnabled)
 {
-    Q_UNUSED(fpsReportingEnabled)
+    if (m_fpsReportingEnabled == fpsReportingEnabled)
+        return;
+
+    m_fpsReportingEnabled = fpsReportingEnabled;
+    if (!fpsReportingEnabled && !m_fpsMonitors.isEmpty()) {
+        qDeleteAll(m_fpsMonitors);
+        m_fpsMonitors.clear();
+        emit fpsMonitorsChanged();
+    }
+    emit fpsReportingEnabledChanged();
 }
 
+bool ProcessMonitor::isIoReportingEnabled() const
+{
+    return m_ioReportingEnabled;
+}
+
+void ProcessMonitor::setIoReportingEnabled(bool ioReportingEnabled)
+{
+    if (m_ioReportingEnabled == ioReportingEnabled)
+        return;
+
+    if (ioReportingEnabled) {
+        obtainPid();
+        if (m_pid == 0) {
+            qCWarning(LogSystem) << "WARNING: could not get Pid for app:" << m_appId;
+            return;
+        }
+
+        if (!m_ioMonitor) {
+            m_ioMonitor = new IoMonitor();
+            emit ioMonitorChanged();
+        }
+
+        m_ioMonitor->setPid(m_pid);
+        updateSampledProcess();
+    }
+
+    m_sampledIoMonitor.storeRelease(ioReportingEnabled ? m_ioMonitor : nullptr);
+    m_ioReportingEnabled = ioReportingEnabled;
+    emit ioReportingEnabledChanged();
+}
+
+// Called by the SystemMonitor for every frame that one of the application's windows commits
+void ProcessMonitor::reportFrameSwap(QObject *window, qreal refreshRate)
+{
+    if (!m_fpsReportingEnabled || !window)
+        return;
+
+    FpsMonitor *fpsMonitor = nullptr;
+    for (FpsMonitor *m : qAsConst(m_fpsMonitors)) {
+        if (m->window() == window) {
+            fpsMonitor = m;
+            break;
+        }
+    }
+    if (!fpsMonitor) {
+        fpsMonitor = new FpsMonitor(window);
+        m_fpsMonitors.append(fpsMonitor);
+        connect(window, &QObject::destroyed, fpsMonitor, [this, fpsMonitor]() {
+            m_fpsMonitors.removeOne(fpsMonitor);
+            fpsMonitor->deleteLater();
+            emit fpsMonitorsChanged();
+        });
+        emit fpsMonitorsChanged();
+    }
+    fpsMonitor->newFrame(refreshRate);
+}
+
+// Called on the SystemMonitor's sampling thread: only the monitors' sampling functions, the
+// atomic pointers and the members guarded by m_sampledResourceUsageMutex may be touched here. The monitors are never deleted before the thread is gone.
+// Adds all the per-process files that sampleData() is going to read to the prefetcher.
+void ProcessMonitor::prefetch(ProcFsPrefetcher *prefetcher)
+{
+    if (CpuMonitor *m = m_sampledCpuMonitor.loadAcquire())
+        m->prefetch(prefetcher);
+    if (IoMonitor *m = m_sampledIoMonitor.loadAcquire())
+        m->prefetch(prefetcher);
+#if defined(Q_OS_LINUX)
+    if (m_resourceUsageSampled.loadAcquire()) {
+        quint64 pid = m_sampledPid.loadAcquire();
+        prefetcher->addProcess(pid, ProcFsPrefetcher::Stat | ProcFsPrefetcher::Statm);
+        prefetcher->addProcessTree(pid, ProcFsPrefetcher::Io);
+    }
+#endif
+}
+
+// Called on the SystemMonitor's sampling thread, see prefetch()
+void ProcessMonitor::sampleData(ProcFsPrefetcher *prefetched)
+{
+    if (MemoryMonitor *m = m_sampledMemoryMonitor.loadAcquire())
+        m->sampleData();
+    if (CpuMonitor *m = m_sampledCpuMonitor.loadAcquire())
+        m->sampleData(prefetched);
+    if (IoMonitor *m = m_sampledIoMonitor.loadAcquire())
+        m->sampleData(prefetched);
+
+#if defined(Q_OS_LINUX)
+    const bool resourceUsageSampled = m_resourceUsageSampled.loadAcquire();
+    QString controlGroup;
+    {
+        QMutexLocker locker(&m_sampledResourceUsageMutex);
+        controlGroup = m_sampledControlGroup;
+    }
+
+    // the container's cgroup files are read here as well: readData() just picks up the values
+    ResourceUsage containerUsage;
+    if (!controlGroup.isEmpty() && (resourceUsageSampled || m_sampledCpuMonitor.loadAcquire()
+                                    || m_sampledIoMonitor.loadAcquire())) {
+        containerUsage.cpuTime = ControlGroupV2::cpuTime(controlGroup);
+        containerUsage.memoryUsage = ControlGroupV2::memoryUsage(controlGroup);
+        containerUsage.hasIoCounters = ControlGroupV2::ioCounters(controlGroup, &containerUsage.ioReadBytes,
+                                                                  &containerUsage.ioWrittenBytes);
+    }
+
+    ResourceUsage usage;
+    if (resourceUsageSampled) {
+        if (quint64 pid = m_sampledPid.loadAcquire()) {
+            ProcFsPrefetcher direct;
+            ProcFsPrefetcher *procFs = prefetched ? prefetched : &direct;
+            usage.cpuTime = procCpuTime(pid, procFs);
+            usage.memoryUsage = procMemoryUsage(pid, procFs);
+            usage.hasIoCounters = procIoCounters(pid, &usage.ioReadBytes, &usage.ioWrittenBytes, procFs);
+        }
+    }
+
+    QMutexLocker locker(&m_sampledResourceUsageMutex);
+    m_sampledResourceUsage = usage;
+    m_sampledContainerUsage = containerUsage;
+#endif
+}
+
+// Called on the GUI thread, after sampleData() has finished: moves the new samples into the models
 void ProcessMonitor::readData()
 {
+    const bool resourceUsageSampled = m_resourceUsageSampled.loadAcquire();
+    ResourceUsage containerUsage;
+    {
+        QMutexLocker locker(&m_sampledResourceUsageMutex);
+        containerUsage = m_sampledContainerUsage;
+        if (resourceUsageSampled)
+            m_resourceUsage = m_sampledResourceUsage;
+    }
+    // plugin containers cannot hand over a cgroup to the sampling thread, so they have to be
+    // asked directly
+    if (m_cpuReportingEnabled || m_ioReportingEnabled || resourceUsageSampled) {
+        AbstractContainer *c = container();
+        if (c && c->accountingControlGroup().isEmpty()) {
+            containerUsage.cpuTime = c->cpuTime();
+            containerUsage.memoryUsage = c->memoryUsage();
+            containerUsage.hasIoCounters = c->ioCounters(&containerUsage.ioReadBytes, &containerUsage.ioWrittenBytes);
+        }
+    }
+
     if (m_memoryReportingEnabled) {
         m_memoryMonitor->readData();
     }
-    if (m_cpuReportingEnabled) {
-
+    if (m_cpuReportingEnabled)
+        m_cpuMonitor->readData(containerUsage.cpuTime);
+    if (m_ioReportingEnabled) {
+        if (containerUsage.hasIoCounters)
+            m_ioMonitor->readData(qint64(containerUsage.ioReadBytes), qint64(containerUsage.ioWrittenBytes));
+        else
+            m_ioMonitor->readData();
     }
     if (m_fpsReportingEnabled) {
+        for (FpsMonitor *m : qAsConst(m_fpsMonitors))
+            m->readData();
+    }
+    if (resourceUsageSampled) {
+        // the container's accounting is preferred, see cpuTime()
+        if (containerUsage.cpuTime >= 0)
+            m_resourceUsage.cpuTime = containerUsage.cpuTime;
+        if (containerUsage.memoryUsage >= 0)
+            m_resourceUsage.memoryUsage = containerUsage.memoryUsage;
+        if (containerUsage.hasIoCounters) {
+            m_resourceUsage.hasIoCounters = true;
+            m_resourceUsage.ioReadBytes = containerUsage.ioReadBytes;
+            m_resourceUsage.ioWrittenBytes = containerUsage.ioWrittenBytes;
+        }
+    }
 
+    // the application might have been restarted in the meantime: the new pid and cgroup will
+    // be used for the next sample
+    if (m_cpuReportingEnabled || m_ioReportingEnabled || resourceUsageSampled) {
+        updateSampledProcess();
+        if (m_cpuReportingEnabled)
+            m_cpuMonitor->setPid(m_pid);
+        if (m_ioReportingEnabled)
+            m_ioMonitor->setPid(m_pid);
     }
 }
 
+// Enables the sampling of the data returned by sampledResourceUsage(): the values are read on the
+// sampling thread, so that the metrics export does not need to block the GUI thread.
+void ProcessMonitor::setResourceUsageSampled(bool enabled)
+{
+    if (enabled)
+        updateSampledProcess();
+    m_resourceUsageSampled.storeRelease(enabled ? 1 : 0);
+}
+
+// Hands the current pid and the container's accounting cgroup over to the sampling thread
+void ProcessMonitor::updateSampledProcess()
+{
+    obtainPid();
+    m_sampledPid.storeRelease(m_pid);
+    AbstractContainer *c = container();
+    const QString controlGroup = c ? c->accountingControlGroup() : QString();
+    QMutexLocker locker(&m_sampledResourceUsageMutex);
+    m_sampledControlGroup = controlGroup;
+}
+
+ProcessMonitor::ResourceUsage ProcessMonitor::sampledResourceUsage() const
+{
+    return m_resourceUsage;
+}
+
 QAbstractListModel *ProcessMonitor::memoryMonitor()
 {
     if (!m_memoryMonitor)
@@ -139,9 +436,22 @@ QAbstractListModel *ProcessMonitor::memoryMonitor()
 
 }
 
+QAbstractListModel *ProcessMonitor::cpuMonitor()
+{
+    return m_cpuMonitor;
+}
+
+QAbstractListModel *ProcessMonitor::ioMonitor()
+{
+    return m_ioMonitor;
+}
+
 QVariant ProcessMonitor::fpsMonitors() const
 {
-    return QVariant::fromValue(m_fpsMonitors);
+    QVariantList list;
+    for (FpsMonitor *m : m_fpsMonitors)
+        list << QVariant::fromValue<QObject *>(m);
+    return list;
 }
 
 QString ProcessMonitor::getAppId() const
@@ -149,6 +459,87 @@ QString ProcessMonitor::getAppId() const
     return m_appId;
 }
 
+QVariantMap ProcessMonitor::resourceUsage()
+{
+    QVariantMap map;
+    map[qSL("cpuTime")] = cpuTime();
+    map[qSL("memoryUsage")] = memoryUsage();
+    quint64 readBytes = 0, writtenBytes = 0;
+    if (ioCounters(&readBytes, &writtenBytes)) {
+        map[qSL("ioReadBytes")] = readBytes;
+        map[qSL("ioWrittenBytes")] = writtenBytes;
+    }
+    return map;
+}
+
+// Returns the user + system time of the application in microseconds or -1. The container is
+// asked first, since it might have more accurate data (e.g. a cgroup that also includes all
+// child processes) or it might be the only way to get this data at all (e.g. pid namespaces).
+qint64 ProcessMonitor::cpuTime()
+{
+    if (AbstractContainer *c = container()) {
+        qint64 t = c->cpuTime();
+        if (t >= 0)
+            return t;
+    }
+#if defined(Q_OS_LINUX)
+    obtainPid();
+    if (m_pid) {
+        ProcFsPrefetcher procFs;
+        return procCpuTime(m_pid, &procFs);
+    }
+#endif
+    return -1;
+}
+
+// Returns the memory usage of the application in bytes or -1.
+qint64 ProcessMonitor::memoryUsage()
+{
+    if (AbstractContainer *c = container()) {
+        qint64 m = c->memoryUsage();
+        if (m >= 0)
+            return m;
+    }
+#if defined(Q_OS_LINUX)
+    obtainPid();
+    if (m_pid) {
+        ProcFsPrefetcher procFs;
+        return procMemoryUsage(m_pid, &procFs);
+    }
+#endif
+    return -1;
+}
+
+// Returns the number of bytes the application has read from and written to storage.
+bool ProcessMonitor::ioCounters(quint64 *readBytes, quint64 *writtenBytes)
+{
+    if (AbstractContainer *c = container()) {
+        if (c->ioCounters(readBytes, writtenBytes))
+            return true;
+    }
+#if defined(Q_OS_LINUX)
+    obtainPid();
+    if (m_pid) {
+        ProcFsPrefetcher procFs;
+        return procIoCounters(m_pid, readBytes, writtenBytes, &procFs);
+    }
+#else
+    Q_UNUSED(readBytes)
+    Q_UNUSED(writtenBytes)
+#endif
+    return false;
+}
+
+AbstractContainer *ProcessMonitor::container() const
+{
+    if (m_appId.isEmpty())
+        return nullptr;
+    const Application *app = ApplicationManager::instance()->fromId(m_appId);
+    if (app && app->currentRuntime())
+        return app->currentRuntime()->container();
+    return nullptr;
+}
+
 void ProcessMonitor::obtainPid()
 {
     if (m_appId.isEmpty())
@@ -43,12 +43,18 @@
 
 #include <QAbstractListModel>
 #include <QObject>
+#include <QAtomicPointer>
+#include <QMutex>
 #include <QtAppManManager/fpsmonitor.h>
 #include <QtAppManManager/systemmonitor.h>
 
 QT_BEGIN_NAMESPACE_AM
 
 class MemoryMonitor;
+class CpuMonitor;
+class IoMonitor;
+class AbstractContainer;
+class ProcFsPrefetcher;
 
 class ProcessMonitor : public QObject
 {
@@ -57,7 +63,10 @@ class ProcessMonitor : public QObject
     Q_PROPERTY(bool memoryReportingEnabled READ isMemoryReportingEnabled WRITE setMemoryReportingEnabled NOTIFY memoryReportingEnabledChanged)
     Q_PROPERTY(bool cpuLoadReportingEnabled READ isCpuLoadReportingEnabled WRITE setCpuLoadReportingEnabled NOTIFY cpuLoadReportingEnabledChanged)
     Q_PROPERTY(bool fpsReportingEnabled READ isFpsReportingEnabled WRITE setFpsReportingEnabled NOTIFY fpsReportingEnabledChanged)
+    Q_PROPERTY(bool ioReportingEnabled READ isIoReportingEnabled WRITE setIoReportingEnabled NOTIFY ioReportingEnabledChanged)
     Q_PROPERTY(QAbstractListModel *memoryMonitor READ memoryMonitor NOTIFY memoryMonitorChanged)
+    Q_PROPERTY(QAbstractListModel *cpuMonitor READ cpuMonitor NOTIFY cpuMonitorChanged)
+    Q_PROPERTY(QAbstractListModel *ioMonitor READ ioMonitor NOTIFY ioMonitorChanged)
     Q_PROPERTY(QVariant fpsMonitors READ fpsMonitors NOTIFY fpsMonitorsChanged)
 
 public:
@@ -70,28 +79,74 @@ public:
     void setCpuLoadReportingEnabled(bool cpuReportingEnabled);
     bool isFpsReportingEnabled() const;
     void setFpsReportingEnabled(bool fpsReportingEnabled);
+    bool isIoReportingEnabled() const;
+    void setIoReportingEnabled(bool ioReportingEnabled);
     QAbstractListModel *memoryMonitor();
+    QAbstractListModel *cpuMonitor();
+    QAbstractListModel *ioMonitor();
     QVariant fpsMonitors() const;
     QString getAppId() const;
 
+    Q_INVOKABLE QVariantMap resourceUsage();
+
+    qint64 cpuTime();
+    qint64 memoryUsage();
+    bool ioCounters(quint64 *readBytes, quint64 *writtenBytes);
+
+    struct ResourceUsage
+    {
+        qint64 cpuTime = -1; // usec
+        qint64 memoryUsage = -1; // bytes
+        bool hasIoCounters = false;
+        quint64 ioReadBytes = 0;
+        quint64 ioWrittenBytes = 0;
+    };
+    // the values of the last sampling interval: see setResourceUsageSampled()
+    ResourceUsage sampledResourceUsage() const;
+
 signals:
     void memoryReportingEnabledChanged();
     void cpuLoadReportingEnabledChanged();
     void fpsReportingEnabledChanged();
+    void ioReportingEnabledChanged();
     void fpsMonitorsChanged();
     void memoryMonitorChanged();
+    void cpuMonitorChanged();
+    void ioMonitorChanged();
 
 private:
     void obtainPid();
+    void prefetch(ProcFsPrefetcher *prefetcher);
+    void sampleData(ProcFsPrefetcher *prefetched = nullptr);
     void readData();
+    void reportFrameSwap(QObject *window, qreal refreshRate);
+    void setResourceUsageSampled(bool enabled);
+    void updateSampledProcess();
+    AbstractContainer *container() const;
 
     friend class SystemMonitorPrivate;
+    friend class SystemMonitorSampler;
 
     QList<FpsMonitor*> m_fpsMonitors;
     MemoryMonitor *m_memoryMonitor;
+    CpuMonitor *m_cpuMonitor;
+    IoMonitor *m_ioMonitor = nullptr;
+    // the monitors that the sampling thread should currently feed
+    QAtomicPointer<MemoryMonitor> m_sampledMemoryMonitor;
+    QAtomicPointer<CpuMonitor> m_sampledCpuMonitor;
+    QAtomicPointer<IoMonitor> m_sampledIoMonitor;
     bool m_memoryReportingEnabled;
     bool m_cpuReportingEnabled;
     bool m_fpsReportingEnabled;
+    bool m_ioReportingEnabled = false;
+    // the resource usage is read on the sampling thread and cached on the GUI thread
+    QAtomicInt m_resourceUsageSampled;
+    QAtomicInteger<quint64> m_sampledPid;
+    QMutex m_sampledResourceUsageMutex; // guards all the m_sampled* members below
+    QString m_sampledControlGroup; // the container's accountingControlGroup()
+    ResourceUsage m_sampledResourceUsage; // from /proc
+    ResourceUsage m_sampledContainerUsage; // from the m_sampledControlGroup
+    ResourceUsage m_resourceUsage;
     QString m_appId;
     quint64 m_pid;
 };
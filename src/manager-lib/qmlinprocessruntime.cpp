@@ -42,10 +42,17 @@
 #include <QQmlEngine>
 #include <QQmlContext>
 #include <QQmlComponent>
+#include <QQmlIncubator>
 #include <QCoreApplication>
+#include <QTimerEvent>
+#include <QSet>
+#include <QTimer>
 
 #if !defined(AM_HEADLESS)
 #  include <QQuickView>
+#  include <QQuickWindow>
+#  include <QGuiApplication>
+#  include <QScreen>
 
 #  include "fakeapplicationmanagerwindow.h"
 #endif
@@ -57,25 +64,26 @@
 #include "global.h"
 #include "utilities.h"
 #include "runtimefactory.h"
+#include "applicationmanager.h"
+#include "systemmonitor.h"
 
 QT_BEGIN_NAMESPACE_AM
 
 // copied straight from Qt 5.1.0 qmlscene/main.cpp for now - needs to be revised
-static void loadDummyDataFiles(QQmlEngine &engine, const QString& directory)
+static void loadDummyDataFiles(QmlInProcessRuntimeManager *manager, QQmlEngine &engine, const QString& directory,
+                               const QString &applicationId)
 {
     QDir dir(directory + qSL("/dummydata"), qSL("*.qml"));
     QStringList list = dir.entryList();
     for (int i = 0; i < list.size(); ++i) {
         QString qml = list.at(i);
-        QFile f(dir.filePath(qml));
-        f.open(QIODevice::ReadOnly);
-        QByteArray data = f.readAll();
-        QQmlComponent comp(&engine);
-        comp.setData(data, QUrl());
-        QObject *dummyData = comp.create();
-
-        if (comp.isError()) {
-            QList<QQmlError> errors = comp.errors();
+        QQmlComponent *comp = manager->dummyDataComponent(&engine, dir.filePath(qml), applicationId);
+        if (!comp)
+            continue;
+        QObject *dummyData = comp->create();
+
+        if (comp->isError()) {
+            QList<QQmlError> errors = comp->errors();
             foreach (const QQmlError &error, errors)
                 qWarning() << error;
         }
@@ -90,12 +98,149 @@ static void loadDummyDataFiles(QQmlEngine &engine, const QString& directory)
 }
 
 
+// Drives all asynchronous incubations of the engine: instead of using up all the idle time
+// between two frames (like QQuickWindow's controller), only a fixed time budget is spent per frame.
+// The frames are those of the System-UI's window - a timer is only used, if there is no window.
+// The controller replaces the engine's own one (normally the window's) only while there are
+// incubations running and restores it afterwards.
+class FrameBudgetIncubationController : public QObject, public QQmlIncubationController
+{
+public:
+    FrameBudgetIncubationController(int budget, QObject *parent)
+        : QObject(parent)
+        , m_budget(qMax(1, budget))
+    { }
+
+    void install(QQmlEngine *engine)
+    {
+        QQmlIncubationController *current = engine->incubationController();
+        if (current == this)
+            return;
+        // the window's controller is deleted together with the window
+        m_previous = current;
+        m_previousObject = dynamic_cast<QObject *>(current);
+        m_previousIsObject = !m_previousObject.isNull();
+        engine->setIncubationController(this);
+    }
+
+protected:
+    void incubatingObjectCountChanged(int count) override
+    {
+        if (count && !m_active) {
+            activate();
+        } else if (!count && m_active) {
+            deactivate();
+            // we are called from within the engine: restore the previous controller later
+            QTimer::singleShot(0, this, [this]() { uninstall(); });
+        }
+    }
+
+    void timerEvent(QTimerEvent *te) override
+    {
+        if (te->timerId() == m_timerId)
+            incubateFor(m_budget);
+    }
+
+private:
+    void activate()
+    {
+        m_active = true;
+#if !defined(AM_HEADLESS)
+        for (QWindow *w : QGuiApplication::topLevelWindows()) {
+            if ((m_window = qobject_cast<QQuickWindow *>(w)))
+                break;
+        }
+        if (m_window) {
+            connect(m_window.data(), &QQuickWindow::afterAnimating, this, [this]() {
+                incubateFor(m_budget);
+                // on-demand rendering: we need another frame to continue
+                if (incubatingObjectCount() && m_window)
+                    m_window->update();
+            });
+            m_window->update();
+            return;
+        }
+        qreal refreshRate = 60;
+        if (QScreen *screen = QGuiApplication::primaryScreen()) {
+            if (screen->refreshRate() >= 1)
+                refreshRate = screen->refreshRate();
+        }
+        m_timerId = startTimer(qMax(1, qRound(1000 / refreshRate)), Qt::PreciseTimer);
+#else
+        m_timerId = startTimer(16, Qt::PreciseTimer);
+#endif
+    }
+
+    void deactivate()
+    {
+        m_active = false;
+#if !defined(AM_HEADLESS)
+        if (m_window)
+            disconnect(m_window.data(), nullptr, this, nullptr);
+        m_window.clear();
+#endif
+        if (m_timerId) {
+            killTimer(m_timerId);
+            m_timerId = 0;
+        }
+    }
+
+    void uninstall()
+    {
+        QQmlEngine *e = engine();
+        if (!e || m_active || incubatingObjectCount())
+            return;
+        e->setIncubationController((m_previousIsObject && !m_previousObject) ? nullptr : m_previous);
+        m_previous = nullptr;
+        m_previousObject.clear();
+    }
+
+    int m_budget;
+    bool m_active = false;
+    int m_timerId = 0;
+    QQmlIncubationController *m_previous = nullptr;
+    QPointer<QObject> m_previousObject;
+    bool m_previousIsObject = false;
+#if !defined(AM_HEADLESS)
+    QPointer<QQuickWindow> m_window;
+#endif
+};
+
+class QmlInProcessIncubator : public QQmlIncubator
+{
+public:
+    explicit QmlInProcessIncubator(QmlInProcessRuntime *runtime)
+        : QQmlIncubator(QQmlIncubator::Asynchronous)
+        , m_runtime(runtime)
+    { }
+
+protected:
+    void setInitialState(QObject *obj) override
+    {
+        m_runtime->incubationInitialState(obj);
+    }
+
+    void statusChanged(Status status) override
+    {
+        if (status == Ready || status == Error)
+            m_runtime->incubationFinished(status);
+    }
+
+private:
+    QmlInProcessRuntime *m_runtime;
+};
+
+
 QmlInProcessRuntime::QmlInProcessRuntime(const Application *app, QmlInProcessRuntimeManager *manager)
     : AbstractRuntime(nullptr, app, manager)
 { }
 
 QmlInProcessRuntime::~QmlInProcessRuntime()
 {
+    // aborts a still running incubation and deletes the partially created objects
+    m_incubator.reset();
+    delete m_incubationContext;
+
 #if !defined(AM_HEADLESS)
     // if there is still a window present at this point, fire the 'closing' signal (probably) again,
     // because it's still the duty of WindowManager together with qml-ui to free and delete this item!!
@@ -123,7 +268,8 @@ bool QmlInProcessRuntime::start()
 
     if (m_app->runtimeParameters().value(qSL("loadDummyData")).toBool()) {
         qCDebug(LogSystem) << "Loading dummy-data";
-        loadDummyDataFiles(*m_inProcessQmlEngine, QFileInfo(m_app->absoluteCodeFilePath()).path());
+        loadDummyDataFiles(static_cast<QmlInProcessRuntimeManager *>(manager()), *m_inProcessQmlEngine,
+                           QFileInfo(m_app->absoluteCodeFilePath()).path(), m_app->id());
     }
 
     const QStringList importPaths = variantToStringList(configuration().value(qSL("importPaths")))
@@ -136,20 +282,35 @@ bool QmlInProcessRuntime::start()
         qCDebug(LogSystem) << "Updated Qml import paths:" << m_inProcessQmlEngine->importPathList();
     }
 
-    QQmlComponent component(m_inProcessQmlEngine, m_app->absoluteCodeFilePath());
+    auto rtm = static_cast<QmlInProcessRuntimeManager *>(manager());
+    const bool async = rtm->loadAsynchronously();
 
-    if (!component.isReady()) {
-        qCDebug(LogSystem) << "qml-file (" << m_app->absoluteCodeFilePath() << "): component not ready:\n" << component.errorString();
+    QQmlComponent *component = rtm->component(m_inProcessQmlEngine, m_app->absoluteCodeFilePath(), m_app->id(),
+                                              async ? QQmlComponent::Asynchronous : QQmlComponent::PreferSynchronous);
+    if (!component)
         return false;
-    }
 
-    // We are running each application in it's own, separate Qml context.
-    // This way, we can export an unique ApplicationInterface object for each app
-    QQmlContext *appContext = new QQmlContext(m_inProcessQmlEngine->rootContext());
-    m_applicationIf = new QmlInProcessApplicationInterface(this);
-    appContext->setContextProperty(qSL("ApplicationInterface"), m_applicationIf);
+    if (async) {
+        // the start-up is finished via incubationFinished(): until then we are in the Startup state
+        m_loading = true;
+        emit stateChanged(state());
+
+        if (component->isLoading()) {
+            m_loadingComponent = component;
+            connect(component, &QQmlComponent::statusChanged, this, &QmlInProcessRuntime::onComponentStatusChanged);
+            // the component cache might get cleared while we are still waiting
+            connect(component, &QObject::destroyed, this, [this]() {
+                qCCritical(LogSystem) << "could not load" << m_app->absoluteCodeFilePath() << ": component was deleted while loading";
+                failAsynchronousStart(nullptr);
+            });
+        } else {
+            startIncubation(component);
+        }
+        return true;
+    }
 
-    QObject *obj = component.beginCreate(appContext);
+    QQmlContext *appContext = createApplicationContext();
+    QObject *obj = component->beginCreate(appContext);
 
     if (!obj) {
         qCCritical(LogSystem) << "could not load" << m_app->absoluteCodeFilePath() << ": no root object";
@@ -165,6 +326,7 @@ bool QmlInProcessRuntime::start()
 
     if (!window) {
         qCCritical(LogSystem) << "could not load" << m_app->absoluteCodeFilePath() << ": root object is not a ApplicationManagerWindow.";
+        component->completeCreate(); // the cached component cannot be used again otherwise
         delete obj;
         delete appContext;
         delete m_applicationIf;
@@ -175,7 +337,7 @@ bool QmlInProcessRuntime::start()
     m_mainWindow = window;
 #endif
 
-    component.completeCreate();
+    component->completeCreate();
     if (!m_document.isEmpty())
         emit openDocument(m_document);
 
@@ -183,6 +345,109 @@ bool QmlInProcessRuntime::start()
     return true;
 }
 
+QQmlContext *QmlInProcessRuntime::createApplicationContext()
+{
+    // We are running each application in it's own, separate Qml context.
+    // This way, we can export an unique ApplicationInterface object for each app
+    QQmlContext *appContext = new QQmlContext(m_inProcessQmlEngine->rootContext());
+    m_applicationIf = new QmlInProcessApplicationInterface(this);
+    appContext->setContextProperty(qSL("ApplicationInterface"), m_applicationIf);
+    return appContext;
+}
+
+void QmlInProcessRuntime::onComponentStatusChanged(QQmlComponent::Status status)
+{
+    if (status == QQmlComponent::Loading)
+        return;
+
+    QQmlComponent *component = m_loadingComponent;
+    m_loadingComponent.clear();
+    if (!component)
+        return;
+    disconnect(component, nullptr, this, nullptr);
+
+    if (status != QQmlComponent::Ready) {
+        // the broken component will be re-created by the manager on the next start attempt
+        qCCritical(LogSystem) << "could not load" << m_app->absoluteCodeFilePath() << ":" << component->errorString();
+        failAsynchronousStart(nullptr);
+        return;
+    }
+    startIncubation(component);
+}
+
+void QmlInProcessRuntime::startIncubation(QQmlComponent *component)
+{
+    m_incubationContext = createApplicationContext();
+    m_incubator.reset(new QmlInProcessIncubator(this));
+    static_cast<QmlInProcessRuntimeManager *>(manager())->setupIncubationController(m_inProcessQmlEngine);
+    component->create(*m_incubator, m_incubationContext);
+}
+
+void QmlInProcessRuntime::incubationInitialState(QObject *obj)
+{
+#if !defined(AM_HEADLESS)
+    // has to be set before the window's componentComplete(), which calls addWindow()
+    if (FakeApplicationManagerWindow *window = qobject_cast<FakeApplicationManagerWindow*>(obj)) {
+        window->m_runtime = this;
+        m_mainWindow = window;
+    }
+#else
+    Q_UNUSED(obj)
+#endif
+}
+
+void QmlInProcessRuntime::incubationFinished(QQmlIncubator::Status status)
+{
+    QQmlContext *appContext = m_incubationContext;
+    m_incubationContext = nullptr;
+
+    if (status == QQmlIncubator::Error) {
+        qCCritical(LogSystem) << "could not load" << m_app->absoluteCodeFilePath() << ":" << m_incubator->errors();
+        failAsynchronousStart(appContext);
+        return;
+    }
+
+#if !defined(AM_HEADLESS)
+    if (!m_mainWindow) {
+        qCCritical(LogSystem) << "could not load" << m_app->absoluteCodeFilePath() << ": root object is not a ApplicationManagerWindow.";
+        // we must not delete the object from within the incubator's callback
+        m_incubator->object()->deleteLater();
+        failAsynchronousStart(appContext);
+        return;
+    }
+
+    m_loading = false;
+
+    // the windows were only recorded while incubating, since the load could still fail
+    for (QQuickItem *window : qAsConst(m_windows))
+        emit inProcessSurfaceItemReady(window);
+#else
+    m_loading = false;
+#endif
+
+    if (!m_document.isEmpty())
+        emit openDocument(m_document);
+
+    emit stateChanged(state());
+}
+
+void QmlInProcessRuntime::failAsynchronousStart(QQmlContext *appContext)
+{
+    m_loading = false;
+#if !defined(AM_HEADLESS)
+    // these windows have never been announced
+    m_windows.clear();
+    m_mainWindow = 0;
+#endif
+    if (appContext)
+        appContext->deleteLater();
+    delete m_applicationIf;
+    m_applicationIf = 0;
+
+    emit stateChanged(state());
+    deleteLater();
+}
+
 void QmlInProcessRuntime::stop(bool forceKill)
 {
     Q_UNUSED(forceKill)// ignore forceKill
@@ -190,6 +455,24 @@ void QmlInProcessRuntime::stop(bool forceKill)
                 //... all this function does for in-process is firing the 'closing' signal (aka: "application/window want's to close")
     emit aboutToStop();
 
+    if (m_loading) {
+        if (m_loadingComponent) {
+            disconnect(m_loadingComponent, nullptr, this, nullptr);
+            m_loadingComponent.clear();
+        }
+        // abort the incubation, so that incubationFinished() will not be called anymore
+        if (m_incubator)
+            m_incubator->clear();
+        delete m_incubationContext;
+        m_incubationContext = nullptr;
+        m_loading = false;
+#if !defined(AM_HEADLESS)
+        // these windows have never been announced
+        m_windows.clear();
+        m_mainWindow = 0;
+#endif
+    }
+
 #if !defined(AM_HEADLESS)
     for (int i = m_windows.size(); i; --i)
         emit inProcessSurfaceItemClosing(m_windows.at(i-1));
@@ -246,13 +529,17 @@ void QmlInProcessRuntime::addWindow(QQuickItem *window)
         }
     }
 
-    emit inProcessSurfaceItemReady(window);
+    // while incubating, the windows are announced by incubationFinished()
+    if (!m_loading)
+        emit inProcessSurfaceItemReady(window);
 }
 
 #endif // !AM_HEADLESS
 
 AbstractRuntime::State QmlInProcessRuntime::state() const
 {
+    if (m_loading)
+        return Startup;
 #if !defined(AM_HEADLESS)
     return m_mainWindow ? Active : Inactive;
 #else
@@ -297,7 +584,142 @@ AbstractRuntime *QmlInProcessRuntimeManager::create(AbstractContainer *container
         delete container;
         return nullptr;
     }
+
+    if (!m_memoryWarningsConnected) {
+        // the ApplicationManager does not exist yet, when the runtime managers are registered
+        m_memoryWarningsConnected = true;
+        connect(ApplicationManager::instance(), &ApplicationManager::memoryLowWarning,
+                this, &QmlInProcessRuntimeManager::clearComponentCache);
+        connect(ApplicationManager::instance(), &ApplicationManager::applicationChanged,
+                this, [this](const QString &id, const QStringList &changedRoles) {
+            // the files of an application are replaced during an update
+            if (changedRoles.contains(qSL("isUpdating")))
+                removeComponentsForApplication(id);
+        });
+        connect(SystemMonitor::instance(), &SystemMonitor::memoryLowWarning,
+                this, &QmlInProcessRuntimeManager::clearComponentCache);
+        connect(SystemMonitor::instance(), &SystemMonitor::memoryCriticalWarning,
+                this, &QmlInProcessRuntimeManager::clearComponentCache);
+    }
     return new QmlInProcessRuntime(app, this);
 }
 
+/*! \internal
+    Returns the compiled component for the QML file \a filePath of the application
+    \a applicationId. Components are cached per file, so restarting an application will
+    not load and compile its QML code again. Returns \c nullptr if the component has errors.
+    With an asynchronous compilation \a mode, the returned component might still be loading.
+*/
+QQmlComponent *QmlInProcessRuntimeManager::component(QQmlEngine *engine, const QString &filePath,
+                                                     const QString &applicationId,
+                                                     QQmlComponent::CompilationMode mode)
+{
+    CachedComponent &cc = m_componentCache[filePath];
+
+    if (cc.component && ((cc.component->engine() != engine) || cc.component->isError())) {
+        delete cc.component;
+        cc.component.clear();
+    }
+    if (!cc.component) {
+        cc.component = new QQmlComponent(engine, filePath, mode, engine);
+        cc.applicationId = applicationId;
+    }
+
+    if (!cc.component->isReady() && !cc.component->isLoading()) {
+        qCDebug(LogSystem) << "qml-file (" << filePath << "): component not ready:\n" << cc.component->errorString();
+        delete cc.component;
+        m_componentCache.remove(filePath);
+        return nullptr;
+    }
+    return cc.component;
+}
+
+/*! \internal
+    Same as component(), but for the dummy-data files of an application: these are not
+    loaded via their URL, since they have to be completely independent from each other.
+*/
+QQmlComponent *QmlInProcessRuntimeManager::dummyDataComponent(QQmlEngine *engine, const QString &filePath,
+                                                              const QString &applicationId)
+{
+    CachedComponent &cc = m_componentCache[filePath];
+
+    if (cc.component && (cc.component->engine() != engine)) {
+        delete cc.component;
+        cc.component.clear();
+    }
+    if (!cc.component) {
+        QFile f(filePath);
+        if (!f.open(QIODevice::ReadOnly)) {
+            m_componentCache.remove(filePath);
+            return nullptr;
+        }
+        cc.component = new QQmlComponent(engine, engine);
+        cc.component->setData(f.readAll(), QUrl());
+        cc.applicationId = applicationId;
+
+        // broken files are not cached: they would only be re-compiled after an update anyway
+        if (cc.component->isError()) {
+            foreach (const QQmlError &error, cc.component->errors())
+                qWarning() << error;
+            delete cc.component;
+            m_componentCache.remove(filePath);
+            return nullptr;
+        }
+    }
+    return cc.component;
+}
+
+bool QmlInProcessRuntimeManager::loadAsynchronously() const
+{
+    return configuration().value(qSL("asynchronousLoading")).toBool();
+}
+
+/*! \internal
+    Installs an incubation controller on \a engine, that spends at most \c incubationBudget
+    msec per frame on creating the objects of asynchronously loaded applications.
+    The engine is shared with the System-UI, so the previous controller (normally the one of
+    the System-UI's window) is restored, as soon as there is nothing left to incubate.
+*/
+void QmlInProcessRuntimeManager::setupIncubationController(QQmlEngine *engine)
+{
+    if (!m_incubationController) {
+        int budget = configuration().value(qSL("incubationBudget"), 5).toInt();
+        m_incubationController = new FrameBudgetIncubationController(budget, this);
+    }
+    m_incubationController->install(engine);
+}
+
+void QmlInProcessRuntimeManager::clearComponentCache()
+{
+    if (m_componentCache.isEmpty())
+        return;
+
+    qCDebug(LogSystem) << "Dropping" << m_componentCache.size() << "cached QML components of in-process applications";
+
+    QSet<QQmlEngine *> engines;
+    for (const CachedComponent &cc : qAsConst(m_componentCache)) {
+        if (cc.component) {
+            engines.insert(cc.component->engine());
+            delete cc.component;
+        }
+    }
+    m_componentCache.clear();
+
+    // the engine keeps the compiled type data around, as long as it is not explicitly trimmed
+    for (QQmlEngine *engine : qAsConst(engines))
+        engine->trimComponentCache();
+}
+
+void QmlInProcessRuntimeManager::removeComponentsForApplication(const QString &applicationId)
+{
+    for (auto it = m_componentCache.begin(); it != m_componentCache.end(); ) {
+        if (it->applicationId == applicationId) {
+            delete it->component;
+            it = m_componentCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 QT_END_NAMESPACE_AM
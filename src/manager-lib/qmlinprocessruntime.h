@@ -41,12 +41,19 @@
 
 #pragma once
 
+#include <QHash>
+#include <QPointer>
+#include <QScopedPointer>
+#include <QQmlComponent>
+#include <QQmlIncubator>
 #include <QtAppManManager/abstractruntime.h>
 
 QT_BEGIN_NAMESPACE_AM
 
 class FakeApplicationManagerWindow;
 class QmlInProcessApplicationInterface;
+class QmlInProcessIncubator;
+class FrameBudgetIncubationController;
 
 class QmlInProcessRuntimeManager : public AbstractRuntimeManager
 {
@@ -59,6 +66,29 @@ public:
     bool inProcess() const override;
 
     AbstractRuntime *create(AbstractContainer *container, const Application *app) override;
+
+    QQmlComponent *component(QQmlEngine *engine, const QString &filePath, const QString &applicationId,
+                             QQmlComponent::CompilationMode mode = QQmlComponent::PreferSynchronous);
+    QQmlComponent *dummyDataComponent(QQmlEngine *engine, const QString &filePath, const QString &applicationId);
+
+    bool loadAsynchronously() const;
+    void setupIncubationController(QQmlEngine *engine);
+
+public slots:
+    void clearComponentCache();
+
+private:
+    void removeComponentsForApplication(const QString &applicationId);
+
+    // compiled components are children of the engine, so they might vanish behind our back
+    struct CachedComponent
+    {
+        QPointer<QQmlComponent> component;
+        QString applicationId;
+    };
+    QHash<QString, CachedComponent> m_componentCache; // absolute file path -> component
+    bool m_memoryWarningsConnected = false;
+    FrameBudgetIncubationController *m_incubationController = nullptr;
 };
 
 
@@ -82,6 +112,8 @@ signals:
     void aboutToStop(); // used for the ApplicationInterface
 
 private slots:
+    void onComponentStatusChanged(QQmlComponent::Status status);
+
 #if !defined(AM_HEADLESS)
     void onWindowClose();
     void onWindowDestroyed();
@@ -91,9 +123,22 @@ private slots:
 #endif
 
 private:
+    QQmlContext *createApplicationContext();
+    void startIncubation(QQmlComponent *component);
+    void incubationInitialState(QObject *obj);
+    void incubationFinished(QQmlIncubator::Status status);
+    void failAsynchronousStart(QQmlContext *appContext);
+
     QString m_document;
     QmlInProcessApplicationInterface *m_applicationIf = 0;
 
+    // asynchronous loading
+    bool m_loading = false;
+    QPointer<QQmlComponent> m_loadingComponent;
+    QQmlContext *m_incubationContext = nullptr;
+    QScopedPointer<QmlInProcessIncubator> m_incubator;
+    friend class QmlInProcessIncubator;
+
 #if !defined(AM_HEADLESS)
     // used by FakeApplicationManagerWindow to register windows
     void addWindow(QQuickItem *window);
@@ -47,7 +47,9 @@
 #include "containerfactory.h"
 #include "runtimefactory.h"
 #include "quicklauncher.h"
+#include "applicationmanager.h"
 #include "systemmonitor.h"
+#include "metricsexporter.h"
 
 QT_BEGIN_NAMESPACE_AM
 
@@ -73,8 +75,20 @@ void QuickLauncher::initialize(int runtimesPerContainer, qreal idleLoad)
     RuntimeFactory *rf = RuntimeFactory::instance();
 
     foreach (const QString &containerId, cf->containerIds()) {
-        if (!cf->manager(containerId)->supportsQuickLaunch())
+        if (!cf->manager(containerId)->supportsQuickLaunch()) {
+            // containers that have an expensive setup phase can at least be prepared in advance,
+            // but only if there are applications that are going to use them
+            if (cf->manager(containerId)->supportsPreparation()
+                    && ApplicationManager::instance()->selectableContainerIds().contains(containerId)) {
+                QuickLaunchEntry entry;
+                entry.m_containerId = containerId;
+                entry.m_maximum = runtimesPerContainer;
+                m_quickLaunchPool << entry;
+
+                qCDebug(LogSystem) << "Created prepared container slot for" << containerId;
+            }
             continue;
+        }
 
         foreach (const QString &runtimeId, rf->runtimeIds()) {
             if (rf->manager(runtimeId)->inProcess())
@@ -97,6 +111,27 @@ void QuickLauncher::initialize(int runtimesPerContainer, qreal idleLoad)
         m_onlyRebuildWhenIdle = true;
         connect(SystemMonitor::instance(), &SystemMonitor::idleChanged, this, &QuickLauncher::rebuild);
     }
+
+    MetricsExporter *me = MetricsExporter::instance();
+    me->registerGauge(qSL("am_quicklaunch_pool_capacity"), qSL("Maximum number of entries in a quick-launch slot"));
+    me->registerGauge(qSL("am_quicklaunch_pool_size"), qSL("Current number of entries in a quick-launch slot"));
+    me->registerGauge(qSL("am_quicklaunch_pool_ready"), qSL("Entries in a quick-launch slot that are fully prepared"));
+    me->registerCounter(qSL("am_quicklaunch_requests"), qSL("Requests for a quick-launch entry by result"));
+    me->registerCollector(this, [this, me]() {
+        for (const QuickLaunchEntry &entry : qAsConst(m_quickLaunchPool)) {
+            const MetricsExporter::Labels labels { { qSL("container"), entry.m_containerId },
+                                                   { qSL("runtime"), entry.m_runtimeId } };
+            int ready = 0;
+            for (const auto &car : entry.m_containersAndRuntimes) {
+                if (car.first->isReady() && !m_preparationGuards.contains(car.first))
+                    ++ready;
+            }
+            me->setGauge(qSL("am_quicklaunch_pool_capacity"), labels, entry.m_maximum);
+            me->setGauge(qSL("am_quicklaunch_pool_size"), labels, entry.m_containersAndRuntimes.size());
+            me->setGauge(qSL("am_quicklaunch_pool_ready"), labels, ready);
+        }
+    });
+
     triggerRebuild();
 }
 
@@ -122,6 +157,11 @@ void QuickLauncher::rebuild()
                                      << entry->m_containerId;
                 continue;
             }
+            if (!ac->prepare()) {
+                qCWarning(LogSystem) << "ERROR: Could not prepare quick-launch container with id"
+                                     << entry->m_containerId;
+                continue;
+            }
 
             QScopedPointer<AbstractRuntime> ar;
             if (!entry->m_runtimeId.isEmpty()) {
@@ -132,7 +172,7 @@ void QuickLauncher::rebuild()
                                          << entry->m_containerId;
                     continue;
                 }
-                if (!ar->start()) {
+                if (ar->container()->isReady() && !ar->start()) {
                     qCWarning(LogSystem) << "ERROR: Could not start quick-launch runtime with id"
                                          << entry->m_runtimeId << "within container with id"
                                          << entry->m_containerId;
@@ -142,6 +182,9 @@ void QuickLauncher::rebuild()
             AbstractContainer *container = ar ? ar.data()->container() : ac.take();
             AbstractRuntime *runtime = ar.take();
 
+            if (!container->isReady())
+                finishPreparation(container, runtime);
+
             connect(container, &AbstractContainer::destroyed, this, [this, container]() { removeEntry(container, nullptr); });
             if (runtime)
                 connect(runtime, &AbstractRuntime::destroyed, this, [this, runtime]() { removeEntry(nullptr, runtime); });
@@ -156,6 +199,36 @@ void QuickLauncher::rebuild()
         triggerRebuild(1000);
 }
 
+void QuickLauncher::finishPreparation(AbstractContainer *container, AbstractRuntime *runtime)
+{
+    // the guard object makes sure that only one of the two signals is handled
+    QObject *guard = new QObject(container);
+    m_preparationGuards.insert(container, guard);
+
+    connect(container, &AbstractContainer::ready, guard, [this, container, runtime, guard]() {
+        QObject::disconnect(container, nullptr, guard, nullptr);
+        guard->deleteLater();
+        m_preparationGuards.remove(container);
+
+        if (runtime && !runtime->start()) {
+            qCWarning(LogSystem) << "ERROR: Could not start quick-launch runtime within prepared container"
+                                 << container;
+            runtime->deleteLater();
+        }
+    });
+    connect(container, &AbstractContainer::preparationFailed, guard, [this, container, runtime, guard](const QString &errorString) {
+        QObject::disconnect(container, nullptr, guard, nullptr);
+        guard->deleteLater();
+        m_preparationGuards.remove(container);
+
+        qCWarning(LogSystem) << "ERROR: Could not prepare quick-launch container" << container << ":" << errorString;
+        if (runtime)
+            runtime->deleteLater(); // also deletes the container
+        else
+            container->deleteLater();
+    });
+}
+
 void QuickLauncher::triggerRebuild(int delay)
 {
     QTimer::singleShot(delay, this, &QuickLauncher::rebuild);
@@ -174,6 +247,8 @@ void QuickLauncher::removeEntry(AbstractContainer *container, AbstractRuntime *r
             }
         }
     }
+    if (container)
+        m_preparationGuards.remove(container);
 }
 
 QPair<AbstractContainer *, AbstractRuntime *> QuickLauncher::take(const QString &containerId, const QString &runtimeId)
@@ -189,6 +264,10 @@ QPair<AbstractContainer *, AbstractRuntime *> QuickLauncher::take(const QString
                         || ((pass == 2) && (entry->m_runtimeId.isEmpty()))) {
                     if (!entry->m_containersAndRuntimes.isEmpty()) {
                         result = entry->m_containersAndRuntimes.takeFirst();
+                        // a container that is still being prepared is now owned by the caller,
+                        // but a quick-launch runtime in it still needs to be started by us
+                        if (!result.second)
+                            delete m_preparationGuards.take(result.first);
                         triggerRebuild();
                         pass = 2;
                         break;
@@ -198,6 +277,10 @@ QPair<AbstractContainer *, AbstractRuntime *> QuickLauncher::take(const QString
         }
     }
 
+    MetricsExporter::instance()->incrementCounter(qSL("am_quicklaunch_requests"),
+                                                  { { qSL("container"), containerId },
+                                                    { qSL("runtime"), runtimeId },
+                                                    { qSL("result"), result.first ? qSL("hit") : qSL("miss") } });
     return result;
 }
 
@@ -44,6 +44,7 @@
 #include <QObject>
 #include <QPair>
 #include <QVector>
+#include <QHash>
 #include <QtAppManCommon/global.h>
 
 QT_BEGIN_NAMESPACE_AM
@@ -75,6 +76,7 @@ private:
     static QuickLauncher *s_instance;
 
     void triggerRebuild(int delay = 0);
+    void finishPreparation(AbstractContainer *container, AbstractRuntime *runtime);
     void removeEntry(AbstractContainer *container, AbstractRuntime *runtime);
 
     struct QuickLaunchEntry
@@ -86,6 +88,7 @@ private:
     };
 
     QVector<QuickLaunchEntry> m_quickLaunchPool;
+    QHash<AbstractContainer *, QObject *> m_preparationGuards;
     bool m_onlyRebuildWhenIdle = false;
 };
 
@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QAtomicInt>
+#include <QtAppManCommon/global.h>
+
+QT_BEGIN_NAMESPACE_AM
+
+// A bounded, lock-free queue for exactly one producer and one consumer thread: the producer
+// only ever writes m_tail, the consumer only ever writes m_head.
+template <typename T, int Capacity>
+class SpscQueue
+{
+public:
+    SpscQueue()
+    { }
+
+    // producer only: returns false if the queue is full
+    bool push(const T &value)
+    {
+        const int tail = m_tail.load();
+        const int next = (tail + 1) % Size;
+        if (next == m_head.loadAcquire())
+            return false;
+        m_items[tail] = value;
+        m_tail.storeRelease(next);
+        return true;
+    }
+
+    // consumer only: returns false if the queue is empty
+    bool pop(T *value)
+    {
+        const int head = m_head.load();
+        if (head == m_tail.loadAcquire())
+            return false;
+        *value = m_items[head];
+        m_items[head] = T(); // drop the shared data on this side
+        m_head.storeRelease((head + 1) % Size);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return m_head.loadAcquire() == m_tail.loadAcquire();
+    }
+
+private:
+    enum { Size = Capacity + 1 };
+
+    T m_items[Size];
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
+
+    Q_DISABLE_COPY(SpscQueue)
+};
+
+QT_END_NAMESPACE_AM
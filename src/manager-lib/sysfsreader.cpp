@@ -40,9 +40,22 @@
 ****************************************************************************/
 
 #include <errno.h>
+#include <cstring>
 #include <qplatformdefs.h>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
 #include "sysfsreader.h"
 
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#  include <linux/io_uring.h>
+#  define AM_HAVE_IO_URING
+#endif
+
 #  define EINTR_LOOP(cmd) __extension__ ({int res = 0; do { res = cmd; } while (res == -1 && errno == EINTR); res; })
 
 static inline int qt_safe_open(const char *pathname, int flags, mode_t mode = 0777)
@@ -87,13 +100,21 @@ QByteArray SysFsReader::readValue() const
 {
     if (m_fd < 0)
         return QByteArray();
-    if (EINTR_LOOP(QT_LSEEK(m_fd, 0, SEEK_SET)) != QT_OFF_T(0))
-        return QByteArray();
+
+    // procfs and sysfs files deliver their complete content in a single read, as long as the
+    // buffer is big enough, so a prefetched result never needs to be continued
+    if (m_prefetched >= 0) {
+        int size = m_prefetched;
+        m_prefetched = -1;
+        if (size < m_buffer.size())
+            m_buffer[size] = 0;
+        return m_buffer;
+    }
 
     int offset = 0;
     int read = 0;
     do {
-        read = EINTR_LOOP(QT_READ(m_fd, m_buffer.data() + offset, m_buffer.size() - offset));
+        read = EINTR_LOOP(::pread(m_fd, m_buffer.data() + offset, m_buffer.size() - offset, offset));
         if (read < 0)
             return QByteArray();
         else if (read < (m_buffer.size() - offset))
@@ -103,4 +124,319 @@ QByteArray SysFsReader::readValue() const
     return m_buffer;
 }
 
+bool SysFsReader::rewind() const
+{
+    return (m_fd >= 0) && (EINTR_LOOP(QT_LSEEK(m_fd, 0, SEEK_SET)) == QT_OFF_T(0));
+}
+
+int SysFsReader::read(char *buffer, int size) const
+{
+    if (m_fd < 0)
+        return -1;
+    return EINTR_LOOP(QT_READ(m_fd, buffer, size));
+}
+
+
+#if defined(AM_HAVE_IO_URING)
+
+// A minimal io_uring submission/completion ring on top of the raw syscalls: we only ever
+// need READV requests, so there is no point in depending on liburing.
+struct SysFsBatch::Ring
+{
+    int fd = -1;
+    unsigned entries = 0;
+
+    void *sqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    void *cqRing = MAP_FAILED;
+    size_t cqRingSize = 0;
+    io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned *sqHead = nullptr;
+    unsigned *sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned *sqArray = nullptr;
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe *cqes = nullptr;
+
+    QVector<iovec> iovecs;
+
+    bool setup(unsigned wantedEntries)
+    {
+        io_uring_params p;
+        memset(&p, 0, sizeof(p));
+        fd = int(::syscall(__NR_io_uring_setup, wantedEntries, &p));
+        if (fd < 0)
+            return false;
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        entries = p.sq_entries;
+        sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+#  if defined(IORING_FEAT_SINGLE_MMAP)
+        bool singleMmap = (p.features & IORING_FEAT_SINGLE_MMAP);
+#  else
+        bool singleMmap = false;
+#  endif
+        if (singleMmap)
+            sqRingSize = cqRingSize = qMax(sqRingSize, cqRingSize);
+
+        sqRing = ::mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        fd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED)
+            return false;
+        if (singleMmap) {
+            cqRing = sqRing;
+        } else {
+            cqRing = ::mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            fd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED)
+                return false;
+        }
+        sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe *>(::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED)
+            return false;
+
+        char *sq = static_cast<char *>(sqRing);
+        sqHead = reinterpret_cast<unsigned *>(sq + p.sq_off.head);
+        sqTail = reinterpret_cast<unsigned *>(sq + p.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned *>(sq + p.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned *>(sq + p.sq_off.array);
+        char *cq = static_cast<char *>(cqRing);
+        cqHead = reinterpret_cast<unsigned *>(cq + p.cq_off.head);
+        cqTail = reinterpret_cast<unsigned *>(cq + p.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned *>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    ~Ring()
+    {
+        if (sqes != MAP_FAILED)
+            ::munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing)
+            ::munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED)
+            ::munmap(sqRing, sqRingSize);
+        if (fd >= 0)
+            QT_CLOSE(fd);
+    }
+
+    // Reads all readers (at most entries) at offset 0 into their buffers. Returns false if
+    // the ring is not usable anymore: the readers that have not been completed yet will then
+    // simply do a synchronous read.
+    bool read(const SysFsReader * const *readers, int count)
+    {
+        iovecs.resize(count);
+
+        unsigned tail = *sqTail;
+        for (int i = 0; i < count; ++i) {
+            QByteArray &buffer = readers[i]->m_buffer;
+            iovecs[i].iov_base = buffer.data();
+            iovecs[i].iov_len = size_t(buffer.size());
+
+            unsigned index = tail & sqMask;
+            io_uring_sqe *sqe = sqes + index;
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_READV;
+            sqe->fd = readers[i]->m_fd;
+            sqe->off = 0;
+            sqe->addr = quint64(quintptr(&iovecs[i]));
+            sqe->len = 1;
+            sqe->user_data = quint64(i);
+            sqArray[index] = index;
+            ++tail;
+        }
+        __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+        int completed = 0;
+        while (completed < count) {
+            unsigned toSubmit = tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            int res = int(::syscall(__NR_io_uring_enter, fd, toSubmit, 1, IORING_ENTER_GETEVENTS,
+                                    nullptr, 0));
+            if (res < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                return false;
+
+            unsigned head = *cqHead;
+            while (head != __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe *cqe = cqes + (head & cqMask);
+                if (cqe->user_data < quint64(count))
+                    readers[cqe->user_data]->m_prefetched = qMax(cqe->res, -1);
+                ++head;
+                ++completed;
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+        return true;
+    }
+};
+
+#else
+
+struct SysFsBatch::Ring { };
+
+#endif // AM_HAVE_IO_URING
+
+SysFsBatch::SysFsBatch()
+{
+#if defined(AM_HAVE_IO_URING)
+    // ENOSYS on kernels before 5.1 and EPERM if io_uring is disabled via sysctl or seccomp
+    m_ring = new Ring;
+    if (!m_ring->setup(32)) {
+        qCDebug(LogSystem) << "io_uring is not available (" << strerror(errno)
+                           << "): system statistics will be read with one syscall per file";
+        delete m_ring;
+        m_ring = nullptr;
+    }
+#endif
+}
+
+SysFsBatch::~SysFsBatch()
+{
+    delete m_ring;
+}
+
+bool SysFsBatch::usesIoUring() const
+{
+    return m_ring;
+}
+
+void SysFsBatch::add(const SysFsReader *reader)
+{
+    if (m_ring && reader && reader->isOpen() && !reader->m_buffer.isEmpty())
+        m_readers.append(reader);
+}
+
+void SysFsBatch::submit()
+{
+#if defined(AM_HAVE_IO_URING)
+    for (int i = 0; m_ring && i < m_readers.size(); i += int(m_ring->entries)) {
+        if (!m_ring->read(m_readers.constData() + i, qMin(int(m_ring->entries), m_readers.size() - i))) {
+            qCWarning(LogSystem) << "WARNING: io_uring failed (" << strerror(errno)
+                                 << "), falling back to one syscall per file";
+            delete m_ring;
+            m_ring = nullptr;
+        }
+    }
+#endif
+    m_readers.clear();
+}
+
+QVector<quint64> processTree(quint64 pid, int maxSize)
+{
+    QVector<quint64> pids;
+    pids << pid;
+    for (int i = 0; i < pids.size() && pids.size() < maxSize; ++i) {
+        const QString taskDir = qSL("/proc/%1/task").arg(pids.at(i));
+        foreach (const QString &tid, QDir(taskDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            // needs CONFIG_PROC_CHILDREN, otherwise we only see the main process
+            QFile f(taskDir + qL1C('/') + tid + qSL("/children"));
+            if (!f.open(QFile::ReadOnly))
+                continue;
+            foreach (const QByteArray &child, f.readAll().simplified().split(' ')) {
+                if (quint64 childPid = child.toULongLong())
+                    pids << childPid;
+            }
+        }
+    }
+    return pids;
+}
+
+
+static const char *procFileName(int file)
+{
+    switch (file) {
+    case ProcFsPrefetcher::Stat: return "stat";
+    case ProcFsPrefetcher::Statm: return "statm";
+    case ProcFsPrefetcher::Io: return "io";
+    default: return nullptr;
+    }
+}
+
+ProcFsPrefetcher::~ProcFsPrefetcher()
+{
+    qDeleteAll(m_readers);
+}
+
+void ProcFsPrefetcher::reset()
+{
+    m_files.clear();
+    m_trees.clear();
+    m_content.clear();
+}
+
+void ProcFsPrefetcher::addProcess(quint64 pid, int files)
+{
+    if (pid)
+        m_files[pid] |= files;
+}
+
+void ProcFsPrefetcher::addProcessTree(quint64 pid, int files)
+{
+    if (!pid)
+        return;
+    foreach (quint64 p, processTree(pid))
+        addProcess(p, files);
+}
+
+void ProcFsPrefetcher::addTo(SysFsBatch *batch)
+{
+    for (auto it = m_readers.begin(); it != m_readers.end(); ) {
+        if (!(m_files.value(it.key().first) & it.key().second)) {
+            delete it.value();
+            it = m_readers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = m_files.cbegin(); it != m_files.cend(); ++it) {
+        for (int file = Stat; file <= Io; file <<= 1) {
+            if (!(it.value() & file))
+                continue;
+            SysFsReader *&reader = m_readers[qMakePair(it.key(), file)];
+            if (!reader) {
+                reader = new SysFsReader("/proc/" + QByteArray::number(it.key()) + '/' + procFileName(file),
+                                         file == Statm ? 128 : 1024);
+            }
+            batch->add(reader);
+        }
+    }
+}
+
+QVector<quint64> ProcFsPrefetcher::processTree(quint64 pid)
+{
+    auto it = m_trees.constFind(pid);
+    if (it == m_trees.constEnd())
+        it = m_trees.insert(pid, QT_PREPEND_NAMESPACE_AM(processTree)(pid));
+    return *it;
+}
+
+QByteArray ProcFsPrefetcher::read(quint64 pid, File file)
+{
+    const Key key = qMakePair(pid, int(file));
+    auto it = m_content.constFind(key);
+    if (it != m_content.constEnd())
+        return *it;
+
+    QByteArray content;
+    if (SysFsReader *reader = m_readers.value(key)) {
+        const QByteArray value = reader->readValue();
+        content = QByteArray(value.constData(), int(qstrnlen(value.constData(), uint(value.size()))));
+        // the process is gone: the pid might be reused by a new process in the next tick
+        if (content.isEmpty())
+            delete m_readers.take(key);
+    } else {
+        QFile f(qSL("/proc/%1/%2").arg(pid).arg(qL1S(procFileName(file))));
+        if (f.open(QFile::ReadOnly))
+            content = f.readAll();
+    }
+    m_content.insert(key, content);
+    return content;
+}
+
 QT_END_NAMESPACE_AM
@@ -42,10 +42,15 @@
 #pragma once
 
 #include <QByteArray>
+#include <QVector>
+#include <QHash>
+#include <QPair>
 #include <QtAppManCommon/global.h>
 
 QT_BEGIN_NAMESPACE_AM
 
+class SysFsBatch;
+
 class SysFsReader
 {
 public:
@@ -55,12 +60,77 @@ public:
     QByteArray fileName() const;
     QByteArray readValue() const;
 
+    // for streaming parsers of files that are too big to be read in one go
+    bool rewind() const;
+    int read(char *buffer, int size) const;
+
 private:
     int m_fd = -1;
     QByteArray m_path;
     mutable QByteArray m_buffer;
+    mutable int m_prefetched = -1; // bytes read by a SysFsBatch, but not consumed yet
 
+    friend class SysFsBatch;
     Q_DISABLE_COPY(SysFsReader)
 };
 
+// Reads the complete content of several SysFsReaders with as few syscalls as possible: all
+// reads are submitted as one io_uring batch, if the kernel supports it. The next readValue()
+// call on each reader then just returns the prefetched data. Without io_uring, submit() is a
+// no-op and readValue() falls back to a plain pread().
+class SysFsBatch
+{
+public:
+    SysFsBatch();
+    ~SysFsBatch();
+
+    bool usesIoUring() const;
+
+    void add(const SysFsReader *reader);
+    void submit();
+
+private:
+    struct Ring;
+    Ring *m_ring = nullptr;
+    QVector<const SysFsReader *> m_readers;
+
+    Q_DISABLE_COPY(SysFsBatch)
+};
+
+// Keeps the /proc/<pid>/stat, statm and io files of the sampled processes open, so that they
+// can be read together with the system-wide files in one SysFsBatch per sampling tick: the
+// per-process monitors then just parse the prefetched data. Files that were not added before
+// the batch was submitted are read synchronously.
+class ProcFsPrefetcher
+{
+public:
+    enum File { Stat = 0x1, Statm = 0x2, Io = 0x4 };
+
+    ProcFsPrefetcher() = default;
+    ~ProcFsPrefetcher();
+
+    // starts a new sampling tick
+    void reset();
+    void addProcess(quint64 pid, int files);
+    void addProcessTree(quint64 pid, int files);
+    // closes the files that are not needed anymore and adds all the others to the batch
+    void addTo(SysFsBatch *batch);
+
+    QVector<quint64> processTree(quint64 pid);
+    QByteArray read(quint64 pid, File file);
+
+private:
+    typedef QPair<quint64, int> Key;
+    QHash<quint64, int> m_files; // pid -> files needed in this tick
+    QHash<quint64, QVector<quint64>> m_trees; // root pid -> process tree in this tick
+    QHash<Key, SysFsReader *> m_readers;
+    QHash<Key, QByteArray> m_content; // already read in this tick
+
+    Q_DISABLE_COPY(ProcFsPrefetcher)
+};
+
+// Returns pid and the pids of all its descendants. The maxSize limit protects against
+// applications that are forking like crazy.
+QVector<quint64> processTree(quint64 pid, int maxSize = 256);
+
 QT_END_NAMESPACE_AM
@@ -42,20 +42,50 @@
 #include <QSysInfo>
 #include <QThread>
 #include <QFile>
+#include <QDir>
 #include <QHash>
-#include <QTimerEvent>
 #include <QElapsedTimer>
+#include <QScopedPointer>
+#include <QDateTime>
 #include <vector>
 #include <QGuiApplication>
+#include <qplatformdefs.h>
+#include <qnumeric.h>
+#include <fcntl.h>
 
 #include "systemmonitor.h"
 #include "systemmonitor_p.h"
 #include "processmonitor.h"
+#include "iomonitor.h"
+#include "frametimer.h"
+#include "systemmonitorhistory.h"
+#include "metricsexporter.h"
+#include "applicationmanager.h"
+#include "application.h"
+#include "abstractruntime.h"
+#include "abstractcontainer.h"
+#include "dbus-policy.h"
+#include "utilities.h"
+#include "trace.h"
 
 #include "global.h"
 
 #include "qml-utilities.h"
 
+#define AM_AUTHENTICATE_DBUS(RETURN_TYPE) \
+    do { \
+        if (!checkDBusPolicy(this, d->dbusPolicy, __FUNCTION__, [](qint64 pid) -> QStringList { return ApplicationManager::instance()->capabilities(ApplicationManager::instance()->identifyApplication(pid)); })) \
+            return RETURN_TYPE(); \
+    } while (false);
+
+// for functions that write files: these need an explicit D-Bus policy
+#define AM_AUTHENTICATE_DBUS_REQUIRE_POLICY(RETURN_TYPE) \
+    do { \
+        if (!requireDBusPolicy(this, d->dbusPolicy, __FUNCTION__)) \
+            return RETURN_TYPE(); \
+        AM_AUTHENTICATE_DBUS(RETURN_TYPE) \
+    } while (false);
+
 QT_BEGIN_NAMESPACE_AM
 
 namespace {
@@ -65,69 +95,56 @@ enum Roles
     MemoryUsed,
     MemoryTotal,
     IoLoad,
+    CpuUser,
+    CpuSystem,
+    CpuIoWait,
+    CpuIrq,
+    CpuSteal,
+    CpuCoreLoads,
+    CpuPressure,
+    MemoryPressure,
+    MemoryFullPressure,
+    IoPressure,
+    IoFullPressure,
 
     AverageFps = Qt::UserRole + 6000,
     MinimumFps,
     MaximumFps,
-    FpsJitter
+    FpsJitter,
+    FrameTimeP50,
+    FrameTimeP95,
+    FrameTimeP99,
+    DroppedFrames,
+    LongestFrameTime,
+    ScreenFps,
+
+    ApplicationIo = Qt::UserRole + 7000
 };
 
-class FrameTimer
+QVariantList qrealListToVariantList(const QVector<qreal> &values)
 {
-public:
-    FrameTimer()
-    { }
-
-    void newFrame()
-    {
-        int frameTime = m_timer.isValid() ? qMax(1, int(m_timer.nsecsElapsed() / 1000)) : IdealFrameTime;
-        m_timer.restart();
-
-        m_count++;
-        m_sum += frameTime;
-        m_min = qMin(m_min, frameTime);
-        m_max = qMax(m_max, frameTime);
-        m_jitter += qAbs(frameTime - IdealFrameTime);
-    }
-
-    inline void reset()
-    {
-        m_count = m_sum = m_max = m_jitter = 0;
-        m_min = INT_MAX;
-    }
-
-    inline qreal averageFps() const
-    {
-        return m_sum ? qreal(1000000) * m_count / m_sum : qreal(0);
-    }
-
-    inline qreal minimumFps() const
-    {
-        return m_max ? qreal(1000000) / m_max : qreal(0);
-    }
-
-    inline qreal maximumFps() const
-    {
-        return m_min ? qreal(1000000) / m_min : qreal(0);
-    }
-
-    inline qreal jitterFps() const
-    {
-        return m_jitter ? qreal(1000000) * m_count / m_jitter : qreal(0);
-
-    }
+    QVariantList list;
+    list.reserve(values.size());
+    for (qreal v : values)
+        list << v;
+    return list;
+}
 
-private:
-    int m_count = 0;
-    int m_sum = 0;
-    int m_min = INT_MAX;
-    int m_max = 0;
-    int m_jitter = 0;
+// set up once and only read from within the crash handler
+static const SystemMonitorHistory *crashDumpHistory = nullptr;
+static QByteArray crashDumpFile;
 
-    QElapsedTimer m_timer;
+static void dumpHistoryOnCrash()
+{
+    if (!crashDumpHistory || crashDumpFile.isEmpty())
+        return;
 
-    static const int IdealFrameTime = 16666; // usec - could be made configurable via an env variable
-};
+    int fd = QT_OPEN(crashDumpFile.constData(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (crashDumpHistory->dump(fd))
+        fprintf(stderr, "\n > SystemMonitor history dumped to %s\n", crashDumpFile.constData());
+    if (fd >= 0)
+        QT_CLOSE(fd);
+}
 }
 
 class SystemMonitorPrivate : public QObject
@@ -140,10 +157,12 @@ public:
     SystemMonitor *q_ptr;
     Q_DECLARE_PUBLIC(SystemMonitor)
 
+    // all reading is done on this thread
+    QThread *samplerThread = 0;
+    SystemMonitorSampler *sampler = 0;
+
     // idle
     qreal idleAverage = 0.1;
-    CpuReader *idleCpu = 0;
-    int idleTimerId = 0;
     bool isIdle = false;
 
     // memory thresholds
@@ -154,39 +173,66 @@ public:
     MemoryThreshold *memoryThreshold = 0;
 
     // fps
-    QHash<QObject *, FrameTimer *> frameTimer;
+    FrameTimer *frameTimer = nullptr; // system-ui; the apps' windows have their own FpsMonitor
+    QMap<QString, FrameTimer *> screenFrameTimer;
 
     QList<ProcessMonitor*> processMonitors;
+    QVariantMap applicationIo; // processes are only sampled on every other report
 
     // reporting
-    MemoryReader *memory = 0;
-    CpuReader *cpu = 0;
-    QHash<QString, IoReader *> ioHash;
+    MemoryReader *memory = 0; // only used for the (constant) total value
+    QStringList ioDevices;
     int reportingInterval = -1;
     int reportingRange = 100 * 100;
-    int reportingTimerId = 0;
     bool reportCpu = false;
     bool reportMem = false;
     bool reportFps = false;
-    // Report process only on half interval to decrease overload
-    bool reportProcess = false;
+    bool reportPressure = false;
+    bool sampleResourceUsage = false; // only needed for the metrics export
+    bool sampleApplicationMemory = false;
+    QHash<QString, QString> applicationControlGroups; // see updateApplicationControlGroups()
+    QList<PressureTrigger *> pressureTriggers;
 
-    struct Report
-    {
-        qreal cpuLoad = 0;
-        qreal fpsAvg = 0;
-        qreal fpsMin = 0;
-        qreal fpsMax = 0;
-        qreal fpsJitter = 0;
-        quint64 memoryUsed = 0;
-        QVariantMap ioLoad;
-    };
+    typedef SystemMonitorSampler::Report Report;
     QVector<Report> reports;
     int reportPos = 0;
 
+    // long term, down-sampled history of the reports
+    SystemMonitorHistory history;
+
+    // dumps are only written into this directory
+    QString dumpDirectory;
+
+    QString dumpFilePath(const QString &fileName) const
+    {
+        if (dumpDirectory.isEmpty()) {
+            qCWarning(LogSystem) << "Cannot dump" << fileName << ": the SystemMonitor's dump directory is not configured";
+            return QString();
+        }
+        // only plain file names: no absolute paths, no sub-directories and no ".."
+        if (fileName.isEmpty() || fileName.contains(qL1C('/')) || fileName.contains(qL1C('\\'))
+                || (fileName == qSL(".")) || (fileName == qSL(".."))) {
+            qCWarning(LogSystem) << "Cannot dump" << fileName << ": only file names are allowed";
+            return QString();
+        }
+        return QDir(dumpDirectory).absoluteFilePath(fileName);
+    }
+
+    QMap<QByteArray, DBusPolicy> dbusPolicy;
+
     // model
     QHash<int, QByteArray> roleNames;
 
+    ProcessMonitor *findProcess(const QString &appId) const
+    {
+        // no alias handling needed here: the WindowManager always reports the real id
+        for (int i = 0; i < processMonitors.size(); i++) {
+            if (processMonitors.at(i)->getAppId() == appId)
+                return processMonitors.at(i);
+        }
+        return nullptr;
+    }
+
     ProcessMonitor *getProcess(const QString &appId)
     {
         Q_Q(SystemMonitor);
@@ -209,104 +255,290 @@ public:
         }
 
         ProcessMonitor *p = new ProcessMonitor(usedAppId, q);
+        if (sampleResourceUsage)
+            p->setResourceUsageSampled(true);
         processMonitors.append(p);
+        setupTimer();
         return processMonitors.last();
     }
 
     void setupTimer(int newInterval = -1)
     {
-        bool useNewInterval = (newInterval != -1) && (newInterval != reportingInterval);
-        bool shouldBeOn = reportCpu | reportMem | reportFps | !ioHash.isEmpty();
-
-        if (useNewInterval)
+        if (newInterval != -1)
             reportingInterval = newInterval;
 
-        if (!shouldBeOn) {
-            if (reportingTimerId) {
-                killTimer(reportingTimerId);
-                reportingTimerId = 0;
-            }
-        } else {
-            if (reportingTimerId) {
-                if (useNewInterval) {
-                    killTimer(reportingTimerId);
-                    reportingTimerId = 0;
+        SystemMonitorSampler::Configuration config;
+        config.interval = reportingInterval;
+        config.cpu = reportCpu;
+        config.memory = reportMem;
+        config.pressure = reportPressure;
+        config.fps = reportFps;
+        config.ioDevices = ioDevices;
+        config.processMonitors = processMonitors;
+        config.resourceUsage = sampleResourceUsage;
+        config.applicationMemory = sampleApplicationMemory;
+        config.applicationControlGroups = applicationControlGroups;
+        sampler->setConfiguration(config);
+    }
+
+    // The applications might have been started, stopped or moved to another cgroup since the last
+    // report: the sampling thread only gets the new paths, if anything changed.
+    void updateApplicationControlGroups()
+    {
+        QHash<QString, QString> controlGroups;
+        if (sampleApplicationMemory) {
+            const auto apps = ApplicationManager::instance()->applications();
+            for (const Application *app : apps) {
+                if (app->isAlias() || !app->currentRuntime())
+                    continue;
+                if (AbstractContainer *c = app->currentRuntime()->container()) {
+                    const QString controlGroup = c->accountingControlGroup();
+                    if (!controlGroup.isEmpty())
+                        controlGroups.insert(app->id(), controlGroup);
                 }
             }
-            if (!reportingTimerId)
-                reportingTimerId = startTimer(reportingInterval);
+        }
+        if (controlGroups != applicationControlGroups) {
+            applicationControlGroups = controlGroups;
+            setupTimer();
         }
     }
 
-    void timerEvent(QTimerEvent *te)
+    void readReports()
+    {
+        Report r;
+        while (sampler->takeReport(&r))
+            applyReport(r);
+    }
+
+    void applyReport(Report &r)
     {
         Q_Q(SystemMonitor);
 
-        if (te && te->timerId() == reportingTimerId) {
-            Report r;
-            QVector<int> roles;
-            if (reportProcess) {
-                for (int i = 0; i < processMonitors.size(); i++)
-                    processMonitors.at(i)->readData();
+        QVector<int> roles;
+        if (r.processesSampled) {
+            applicationIo.clear();
+            for (int i = 0; i < processMonitors.size(); i++) {
+                ProcessMonitor *pm = processMonitors.at(i);
+                pm->readData();
+                if (pm->isIoReportingEnabled())
+                    applicationIo.insert(pm->getAppId(), pm->m_ioMonitor->get(pm->m_ioMonitor->count() - 1));
             }
+            roles.append(ApplicationIo);
+        }
+        r.applicationIo = applicationIo;
 
-            reportProcess = !reportProcess;
+        if (r.applicationMemorySampled) {
+            emit q->applicationMemorySampled(r.applicationMemory);
+            updateApplicationControlGroups();
+        }
+
+        if (r.hasCpu) {
+            emit q->cpuLoadReportingChanged(r.cpuInterval, r.cpuLoad);
+            roles.append(CpuLoad);
 
-            if (reportCpu) {
-                QPair<int, qreal> cpuVal = cpu->readLoadValue();
-                emit q->cpuLoadReportingChanged(cpuVal.first, cpuVal.second);
-                r.cpuLoad = cpuVal.second;
-                roles.append(CpuLoad);
+            if (r.hasCpuDetails) {
+                emit q->cpuStatesReportingChanged(r.cpuInterval, r.cpuDetails.user, r.cpuDetails.system,
+                                                  r.cpuDetails.ioWait, r.cpuDetails.irq, r.cpuDetails.steal);
+                emit q->cpuCoreLoadReportingChanged(r.cpuInterval, qrealListToVariantList(r.cpuCoreLoads));
+                roles << CpuUser << CpuSystem << CpuIoWait << CpuIrq << CpuSteal << CpuCoreLoads;
             }
-            if (reportMem) {
-                quint64 memVal = memory->readUsedValue();
-                emit q->memoryReportingChanged(memory->totalValue(), memVal);
-                r.memoryUsed = memVal;
-                roles.append(MemoryUsed);
-                roles.append(MemoryTotal);
+        }
+        if (r.hasMemory) {
+            emit q->memoryReportingChanged(memory->totalValue(), r.memoryUsed);
+            roles.append(MemoryUsed);
+            roles.append(MemoryTotal);
+        }
+        for (auto it = r.ioIntervals.cbegin(); it != r.ioIntervals.cend(); ++it)
+            emit q->ioLoadReportingChanged(it.key(), it.value(), r.ioLoad.value(it.key()).toReal());
+        if (!r.ioIntervals.isEmpty())
+            roles.append(IoLoad);
+
+        if (r.hasPressure)
+            roles << CpuPressure << MemoryPressure << MemoryFullPressure << IoPressure << IoFullPressure;
+
+        // the frame timers are fed on this thread, so they are read here as well
+        if (reportFps) {
+            if (FrameTimer *ft = frameTimer) {
+                r.fpsAvg = ft->averageFps();
+                r.fpsMin = ft->minimumFps();
+                r.fpsMax = ft->maximumFps();
+                r.fpsJitter = ft->jitterFps();
+                r.frameTimeP50 = ft->frameTimePercentile(qreal(0.5));
+                r.frameTimeP95 = ft->frameTimePercentile(qreal(0.95));
+                r.frameTimeP99 = ft->frameTimePercentile(qreal(0.99));
+                r.droppedFrames = ft->droppedFrames();
+                r.longestFrameTime = ft->longestFrameTime();
+                ft->reset();
+                MetricsExporter::instance()->incrementCounter(qSL("am_dropped_frames"), MetricsExporter::Labels(),
+                                                              r.droppedFrames);
+                emit q->fpsReportingChanged(r.fpsAvg, r.fpsMin, r.fpsMax, r.fpsJitter);
+                emit q->frameTimeReportingChanged(r.frameTimeP50, r.frameTimeP95, r.frameTimeP99,
+                                                  r.droppedFrames, r.longestFrameTime);
+                roles.append(AverageFps);
+                roles.append(MinimumFps);
+                roles.append(MaximumFps);
+                roles.append(FpsJitter);
+                roles << FrameTimeP50 << FrameTimeP95 << FrameTimeP99 << DroppedFrames << LongestFrameTime;
             }
-            for (auto it = ioHash.cbegin(); it != ioHash.cend(); ++it) {
-                QPair<int, qreal> ioVal = it.value()->readLoadValue();
-                emit q->ioLoadReportingChanged(it.key(), ioVal.first, ioVal.second);
-                r.ioLoad.insert(it.key(), ioVal.second);
+
+            for (auto it = screenFrameTimer.cbegin(); it != screenFrameTimer.cend(); ++it) {
+                FrameTimer *ft = it.value();
+                QVariantMap screen;
+                screen[qSL("averageFps")] = ft->averageFps();
+                screen[qSL("minimumFps")] = ft->minimumFps();
+                screen[qSL("maximumFps")] = ft->maximumFps();
+                screen[qSL("fpsJitter")] = ft->jitterFps();
+                screen[qSL("frameTimeP50")] = ft->frameTimePercentile(qreal(0.5));
+                screen[qSL("frameTimeP95")] = ft->frameTimePercentile(qreal(0.95));
+                screen[qSL("frameTimeP99")] = ft->frameTimePercentile(qreal(0.99));
+                screen[qSL("droppedFrames")] = ft->droppedFrames();
+                screen[qSL("longestFrameTime")] = ft->longestFrameTime();
+                screen[qSL("refreshRate")] = qreal(1000000) / ft->idealFrameTime();
+                emit q->screenFpsReportingChanged(it.key(), ft->averageFps(), ft->minimumFps(),
+                                                  ft->maximumFps(), ft->jitterFps());
+                MetricsExporter::instance()->incrementCounter(qSL("am_dropped_frames"), { { qSL("screen"), it.key() } },
+                                                              ft->droppedFrames());
+                ft->reset();
+                r.screenFps.insert(it.key(), screen);
             }
-            if (!ioHash.isEmpty())
-                roles.append(IoLoad);
-
-            if (reportFps) {
-                if (FrameTimer *ft = frameTimer.value(nullptr)) {
-                    r.fpsAvg = ft->averageFps();
-                    r.fpsMin = ft->minimumFps();
-                    r.fpsMax = ft->maximumFps();
-                    r.fpsJitter = ft->jitterFps();
-                    ft->reset();
-                    emit q->fpsReportingChanged(r.fpsAvg, r.fpsMin, r.fpsMax, r.fpsJitter);
-                    roles.append(AverageFps);
-                    roles.append(MinimumFps);
-                    roles.append(MaximumFps);
-                    roles.append(FpsJitter);
+            if (!screenFrameTimer.isEmpty())
+                roles.append(ScreenFps);
+        }
+
+        qreal historyValues[SystemMonitorHistory::MetricCount];
+        historyValues[SystemMonitorHistory::CpuLoad] = r.hasCpu ? r.cpuLoad : qQNaN();
+        historyValues[SystemMonitorHistory::MemoryUsed] = r.hasMemory ? qreal(r.memoryUsed) : qQNaN();
+        historyValues[SystemMonitorHistory::Fps] = roles.contains(AverageFps) ? r.fpsAvg : qQNaN();
+        history.addSample(QDateTime::currentMSecsSinceEpoch(), historyValues);
+
+        // ring buffer handling
+        // optimization: instead of sending a dataChanged for every item, we always move the
+        // first item to the end and change its data only
+        int size = reports.size();
+        q->beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), size);
+        reports[reportPos++] = r;
+        if (reportPos >= reports.size())
+            reportPos = 0;
+        q->endMoveRows();
+        q->dataChanged(q->index(size - 1), q->index(size - 1), roles);
+    }
+
+    void registerMetrics()
+    {
+        Q_Q(SystemMonitor);
+
+        MetricsExporter *me = MetricsExporter::instance();
+        me->registerGauge(qSL("am_cpu_load_ratio"), qSL("CPU load of the whole system"));
+        me->registerGauge(qSL("am_cpu_core_load_ratio"), qSL("CPU load per core"));
+        me->registerGauge(qSL("am_memory_used_bytes"), qSL("Used system memory"));
+        me->registerGauge(qSL("am_memory_total_bytes"), qSL("Total system memory"));
+        me->registerGauge(qSL("am_io_load_ratio"), qSL("Load of the monitored block devices"));
+        me->registerGauge(qSL("am_pressure_some_ratio"), qSL("Share of time (avg10) in which some tasks were stalled"));
+        me->registerGauge(qSL("am_pressure_full_ratio"), qSL("Share of time (avg10) in which all tasks were stalled"));
+        me->registerGauge(qSL("am_fps"), qSL("Average frame rate in the last reporting interval"));
+        me->registerGauge(qSL("am_frame_time_seconds"), qSL("Frame time percentiles in the last reporting interval"));
+        me->registerCounter(qSL("am_dropped_frames"), qSL("Frames that missed their vsync deadline"));
+        me->registerCounter(qSL("am_application_cpu_seconds"), qSL("CPU time used by a monitored application"));
+        me->registerGauge(qSL("am_application_memory_bytes"), qSL("Memory used by a monitored application"));
+        me->registerCounter(qSL("am_application_io_read_bytes"), qSL("Bytes read from storage by a monitored application"));
+        me->registerCounter(qSL("am_application_io_written_bytes"), qSL("Bytes written to storage by a monitored application"));
+        me->registerCollector(q, [this]() { exportMetrics(); });
+    }
+
+    // only the latest report is exported: the scraper is expected to keep its own history
+    void exportMetrics()
+    {
+        MetricsExporter *me = MetricsExporter::instance();
+        const MetricsExporter::Labels noLabels;
+        const Report &r = reportForRow(reports.size() - 1);
+
+        me->clearSeries(qSL("am_cpu_core_load_ratio"));
+        if (r.hasCpu)
+            me->setGauge(qSL("am_cpu_load_ratio"), noLabels, r.cpuLoad);
+        for (int i = 0; i < r.cpuCoreLoads.size(); ++i)
+            me->setGauge(qSL("am_cpu_core_load_ratio"), { { qSL("core"), QString::number(i) } }, r.cpuCoreLoads.at(i));
+
+        me->setGauge(qSL("am_memory_total_bytes"), noLabels, memory->totalValue());
+        if (r.hasMemory)
+            me->setGauge(qSL("am_memory_used_bytes"), noLabels, r.memoryUsed);
+
+        me->clearSeries(qSL("am_io_load_ratio"));
+        for (auto it = r.ioLoad.cbegin(); it != r.ioLoad.cend(); ++it)
+            me->setGauge(qSL("am_io_load_ratio"), { { qSL("device"), it.key() } }, it.value().toReal());
+
+        if (r.hasPressure) {
+            const QPair<qreal, qreal> pressure[] = { r.cpuPressure, r.memoryPressure, r.ioPressure };
+            const char *resources[] = { "cpu", "memory", "io" };
+            for (int i = 0; i < 3; ++i) {
+                const MetricsExporter::Labels labels { { qSL("resource"), qL1S(resources[i]) } };
+                me->setGauge(qSL("am_pressure_some_ratio"), labels, pressure[i].first);
+                // there is no full line for the CPU
+                if (i > 0)
+                    me->setGauge(qSL("am_pressure_full_ratio"), labels, pressure[i].second);
+            }
+        }
+
+        me->clearSeries(qSL("am_fps"));
+        me->clearSeries(qSL("am_frame_time_seconds"));
+        if (reportFps) {
+            auto exportFps = [me](const MetricsExporter::Labels &labels, qreal fps, qreal p50, qreal p95, qreal p99) {
+                me->setGauge(qSL("am_fps"), labels, fps);
+                const qreal percentiles[] = { p50, p95, p99 };
+                const char *names[] = { "50", "95", "99" };
+                for (int i = 0; i < 3; ++i) {
+                    MetricsExporter::Labels percentileLabels = labels;
+                    percentileLabels.insert(qSL("percentile"), qL1S(names[i]));
+                    me->setGauge(qSL("am_frame_time_seconds"), percentileLabels, percentiles[i] / 1000);
                 }
+            };
+            if (frameTimer)
+                exportFps(noLabels, r.fpsAvg, r.frameTimeP50, r.frameTimeP95, r.frameTimeP99);
+            for (auto it = r.screenFps.cbegin(); it != r.screenFps.cend(); ++it) {
+                const QVariantMap screen = it.value().toMap();
+                exportFps({ { qSL("screen"), it.key() } }, screen.value(qSL("averageFps")).toReal(),
+                          screen.value(qSL("frameTimeP50")).toReal(), screen.value(qSL("frameTimeP95")).toReal(),
+                          screen.value(qSL("frameTimeP99")).toReal());
             }
+        }
 
-            // ring buffer handling
-            // optimization: instead of sending a dataChanged for every item, we always move the
-            // first item to the end and change its data only
-            int size = reports.size();
-            q->beginMoveRows(QModelIndex(), 0, 0, QModelIndex(), size);
-            reports[reportPos++] = r;
-            if (reportPos >= reports.size())
-                reportPos = 0;
-            q->endMoveRows();
-            q->dataChanged(q->index(size - 1), q->index(size - 1), roles);
-        } else if (te && te->timerId() == idleTimerId) {
-            QPair<int, qreal> idleVal = idleCpu->readLoadValue();
-            bool nowIdle = (idleVal.second <= idleAverage);
-            if (nowIdle != isIdle)
-                emit q->idleChanged(nowIdle);
-            isIdle = nowIdle;
+        static const QString appMetrics[] = { qSL("am_application_cpu_seconds"), qSL("am_application_memory_bytes"),
+                                               qSL("am_application_io_read_bytes"), qSL("am_application_io_written_bytes") };
+        for (const QString &name : appMetrics)
+            me->clearSeries(name);
+        // a scrape must not block the GUI thread with reading the /proc files of all the
+        // applications: from the first scrape on, the usage is read on the sampling thread and
+        // the scrapes only export the values of the latest sampling interval
+        if (!sampleResourceUsage) {
+            sampleResourceUsage = true;
+            for (ProcessMonitor *pm : qAsConst(processMonitors))
+                pm->setResourceUsageSampled(true);
+            setupTimer();
+        }
+        for (ProcessMonitor *pm : qAsConst(processMonitors)) {
+            const MetricsExporter::Labels labels { { qSL("app"), pm->getAppId() } };
+            const ProcessMonitor::ResourceUsage usage = pm->sampledResourceUsage();
+            if (usage.cpuTime >= 0)
+                me->setCounter(appMetrics[0], labels, qreal(usage.cpuTime) / 1000000);
+            if (usage.memoryUsage >= 0)
+                me->setGauge(appMetrics[1], labels, usage.memoryUsage);
+            if (usage.hasIoCounters) {
+                me->setCounter(appMetrics[2], labels, usage.ioReadBytes);
+                me->setCounter(appMetrics[3], labels, usage.ioWrittenBytes);
+            }
         }
     }
 
+    void updateIdle(qreal load)
+    {
+        Q_Q(SystemMonitor);
+
+        bool nowIdle = (load <= idleAverage);
+        if (nowIdle != isIdle)
+            emit q->idleChanged(nowIdle);
+        isIdle = nowIdle;
+    }
+
     const Report &reportForRow(int row) const
     {
         // convert a visual row position to an index into the internal ringbuffer
@@ -365,11 +597,17 @@ SystemMonitor::SystemMonitor()
 {
     Q_D(SystemMonitor);
 
-    d->idleCpu = new CpuReader;
-    d->cpu = new CpuReader;
     d->memory = new MemoryReader;
 
-    d->idleTimerId = d->startTimer(1000);
+    d->samplerThread = new QThread;
+    d->samplerThread->setObjectName(qSL("SystemMonitor"));
+    d->sampler = new SystemMonitorSampler;
+    d->sampler->moveToThread(d->samplerThread);
+    connect(d->samplerThread, &QThread::finished, d->sampler, &QObject::deleteLater);
+    connect(d->sampler, &SystemMonitorSampler::reportsAvailable, d, [d]() { d->readReports(); });
+    connect(d->sampler, &SystemMonitorSampler::idleLoadSampled, d, [d](qreal load) { d->updateIdle(load); });
+    d->samplerThread->start(QThread::LowPriority);
+    d->setupTimer();
 
     connect(this, &QAbstractItemModel::rowsInserted, this, &SystemMonitor::countChanged);
     connect(this, &QAbstractItemModel::rowsRemoved, this, &SystemMonitor::countChanged);
@@ -380,23 +618,51 @@ SystemMonitor::SystemMonitor()
     d->roleNames.insert(MemoryUsed, "memoryUsed");
     d->roleNames.insert(MemoryTotal, "memoryTotal");
     d->roleNames.insert(IoLoad, "ioLoad");
+    d->roleNames.insert(CpuUser, "cpuUser");
+    d->roleNames.insert(CpuSystem, "cpuSystem");
+    d->roleNames.insert(CpuIoWait, "cpuIoWait");
+    d->roleNames.insert(CpuIrq, "cpuIrq");
+    d->roleNames.insert(CpuSteal, "cpuSteal");
+    d->roleNames.insert(CpuCoreLoads, "cpuCoreLoads");
+    d->roleNames.insert(CpuPressure, "cpuPressure");
+    d->roleNames.insert(MemoryPressure, "memoryPressure");
+    d->roleNames.insert(MemoryFullPressure, "memoryFullPressure");
+    d->roleNames.insert(IoPressure, "ioPressure");
+    d->roleNames.insert(IoFullPressure, "ioFullPressure");
     d->roleNames.insert(AverageFps, "averageFps");
     d->roleNames.insert(MinimumFps, "minimumFps");
     d->roleNames.insert(MaximumFps, "maximumFps");
     d->roleNames.insert(FpsJitter, "fpsJitter");
+    d->roleNames.insert(FrameTimeP50, "frameTimeP50");
+    d->roleNames.insert(FrameTimeP95, "frameTimeP95");
+    d->roleNames.insert(FrameTimeP99, "frameTimeP99");
+    d->roleNames.insert(DroppedFrames, "droppedFrames");
+    d->roleNames.insert(LongestFrameTime, "longestFrameTime");
+    d->roleNames.insert(ScreenFps, "screenFps");
+    d->roleNames.insert(ApplicationIo, "applicationIo");
 
     d->updateModel();
+    d->registerMetrics();
 }
 
 SystemMonitor::~SystemMonitor()
 {
     Q_D(SystemMonitor);
 
-    delete d->idleCpu;
+    if (crashDumpHistory == &d->history) {
+        setCrashCallback(nullptr);
+        crashDumpHistory = nullptr;
+    }
+
+    // the sampler deletes itself (and all its readers) when the thread has finished
+    d->samplerThread->quit();
+    d->samplerThread->wait();
+    delete d->samplerThread;
+
     delete d->memory;
-    delete d->cpu;
-    qDeleteAll(d->ioHash);
     delete d->memoryThreshold;
+    delete d->frameTimer;
+    qDeleteAll(d->screenFrameTimer);
     delete d;
 }
 
@@ -427,6 +693,28 @@ QVariant SystemMonitor::data(const QModelIndex &index, int role) const
         return totalMemory();
     case IoLoad:
         return r.ioLoad;
+    case CpuUser:
+        return r.cpuDetails.user;
+    case CpuSystem:
+        return r.cpuDetails.system;
+    case CpuIoWait:
+        return r.cpuDetails.ioWait;
+    case CpuIrq:
+        return r.cpuDetails.irq;
+    case CpuSteal:
+        return r.cpuDetails.steal;
+    case CpuCoreLoads:
+        return qrealListToVariantList(r.cpuCoreLoads);
+    case CpuPressure:
+        return r.cpuPressure.first;
+    case MemoryPressure:
+        return r.memoryPressure.first;
+    case MemoryFullPressure:
+        return r.memoryPressure.second;
+    case IoPressure:
+        return r.ioPressure.first;
+    case IoFullPressure:
+        return r.ioPressure.second;
     case AverageFps:
         return r.fpsAvg;
     case MinimumFps:
@@ -435,6 +723,20 @@ QVariant SystemMonitor::data(const QModelIndex &index, int role) const
         return r.fpsMax;
     case FpsJitter:
         return r.fpsJitter;
+    case FrameTimeP50:
+        return r.frameTimeP50;
+    case FrameTimeP95:
+        return r.frameTimeP95;
+    case FrameTimeP99:
+        return r.frameTimeP99;
+    case DroppedFrames:
+        return r.droppedFrames;
+    case LongestFrameTime:
+        return r.longestFrameTime;
+    case ScreenFps:
+        return r.screenFps;
+    case ApplicationIo:
+        return r.applicationIo;
     }
     return QVariant();
 }
@@ -484,11 +786,14 @@ bool SystemMonitor::setMemoryWarningThresholds(qreal lowWarning, qreal criticalW
         QList<qreal> thresholds { lowWarning, criticalWarning };
         d->memoryThreshold = new MemoryThreshold(thresholds);
 
-        connect(d->memoryThreshold, &MemoryThreshold::thresholdTriggered, this, [this, d]() {
+        // the current usage is read on the sampling thread, just like all the other values (the
+        // cgroup v2 polling in MemoryThreshold uses its own reader on this thread)
+        connect(d->memoryThreshold, &MemoryThreshold::thresholdTriggered,
+                d->sampler, &SystemMonitorSampler::sampleMemoryUsage);
+        connect(d->sampler, &SystemMonitorSampler::memoryUsageSampled, d->memoryThreshold, [this, d](quint64 memUsed) {
             quint64 memTotal = d->memory->totalValue();
-            quint64 memUsed = d->memory->readUsedValue();
 
-            qreal factor = memUsed / memTotal;
+            qreal factor = qreal(memUsed) / memTotal;
             bool nowMemoryCritical = (factor > d->memoryCriticalWarning);
             bool nowMemoryLow = (factor > d->memoryLowWarning);
             if (nowMemoryCritical && !d->hasMemoryCriticalWarning)
@@ -583,11 +888,10 @@ bool SystemMonitor::addIoLoadReporting(const QString &deviceName)
 
     if (!QFile::exists(qSL("/dev/") + deviceName))
         return false;
-    if (d->ioHash.contains(deviceName))
+    if (d->ioDevices.contains(deviceName))
         return false;
 
-    IoReader *ior = new IoReader(deviceName.toLocal8Bit().constData());
-    d->ioHash.insert(deviceName, ior);
+    d->ioDevices.append(deviceName);
     d->setupTimer();
     return true;
 }
@@ -596,15 +900,115 @@ void SystemMonitor::removeIoLoadReporting(const QString &deviceName)
 {
     Q_D(SystemMonitor);
 
-    delete d->ioHash.take(deviceName);
-    d->setupTimer();
+    if (d->ioDevices.removeOne(deviceName))
+        d->setupTimer();
 }
 
 QStringList SystemMonitor::ioLoadReportingDevices() const
 {
     Q_D(const SystemMonitor);
 
-    return d->ioHash.keys();
+    return d->ioDevices;
+}
+
+bool SystemMonitor::isPressureReportingAvailable() const
+{
+    return PressureReader::isAvailable();
+}
+
+void SystemMonitor::setPressureReportingEnabled(bool enabled)
+{
+    Q_D(SystemMonitor);
+
+    if (enabled && !PressureReader::isAvailable()) {
+        qCWarning(LogSystem) << "Pressure stall information is not available on this system";
+        return;
+    }
+    if (enabled != d->reportPressure) {
+        d->reportPressure = enabled;
+        d->setupTimer();
+        emit pressureReportingEnabledChanged();
+    }
+}
+
+bool SystemMonitor::isPressureReportingEnabled() const
+{
+    Q_D(const SystemMonitor);
+
+    return d->reportPressure;
+}
+
+/*! \internal
+    Registers a PSI trigger for \a resource (\c cpu, \c memory or \c io): as soon as tasks were
+    stalled for more than \a stallThreshold milliseconds within \a timeWindow milliseconds, the
+    corresponding pressure signal is emitted. If \a controlGroup (a cgroup v2 path relative to the
+    cgroup2 mount point) is given, only the tasks in this cgroup are taken into account and
+    controlGroupPressureChanged is emitted instead.
+*/
+bool SystemMonitor::addPressureTrigger(const QString &resource, int stallThreshold, int timeWindow,
+                                       const QString &controlGroup)
+{
+    Q_D(SystemMonitor);
+
+    if (!PressureReader::isAvailable())
+        return false;
+    if (resource != qL1S("cpu") && resource != qL1S("memory") && resource != qL1S("io")) {
+        qCWarning(LogSystem) << "Cannot add a pressure trigger for the unknown resource" << resource;
+        return false;
+    }
+
+    QScopedPointer<PressureTrigger> trigger(new PressureTrigger(resource.toLatin1(), controlGroup, this));
+    if (!trigger->setThreshold(stallThreshold, timeWindow))
+        return false;
+
+    PressureTrigger *t = trigger.data();
+    connect(t, &PressureTrigger::triggered, this, [this, t]() {
+        // the trigger tells us that there is pressure, but not how much
+        QPair<qreal, qreal> stall = PressureReader(t->resource(), t->controlGroup()).readStallValues();
+        if (!t->controlGroup().isEmpty())
+            emit controlGroupPressureChanged(t->controlGroup(), QString::fromLatin1(t->resource()), stall.first, stall.second);
+        else if (t->resource() == "cpu")
+            emit cpuPressureChanged(stall.first, stall.second);
+        else if (t->resource() == "memory")
+            emit memoryPressureChanged(stall.first, stall.second);
+        else
+            emit ioPressureChanged(stall.first, stall.second);
+    });
+    d->pressureTriggers.append(trigger.take());
+    return true;
+}
+
+void SystemMonitor::removePressureTriggers(const QString &resource, const QString &controlGroup)
+{
+    Q_D(SystemMonitor);
+
+    for (auto it = d->pressureTriggers.begin(); it != d->pressureTriggers.end(); ) {
+        if (QString::fromLatin1((*it)->resource()) == resource && (*it)->controlGroup() == controlGroup) {
+            delete *it;
+            it = d->pressureTriggers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/*! \internal
+    Returns the current 10 second averages of the "some" and "full" stall shares of \a resource,
+    either system-wide or for the cgroup v2 \a controlGroup.
+*/
+QVariantMap SystemMonitor::pressure(const QString &resource, const QString &controlGroup) const
+{
+    QVariantMap map;
+    if (!PressureReader::isAvailable())
+        return map;
+
+    PressureReader reader(resource.toLatin1(), controlGroup);
+    if (reader.isOpen()) {
+        QPair<qreal, qreal> stall = reader.readStallValues();
+        map[qSL("some")] = stall.first;
+        map[qSL("full")] = stall.second;
+    }
+    return map;
 }
 
 void SystemMonitor::setFpsReportingEnabled(bool enabled)
@@ -632,6 +1036,7 @@ void SystemMonitor::setReportingInterval(int intervalInMSec)
     if (d->reportingInterval != intervalInMSec && intervalInMSec > 0) {
         d->setupTimer(intervalInMSec);
         d->updateModel();
+        emit reportingIntervalChanged(intervalInMSec);
     }
 }
 
@@ -659,27 +1064,193 @@ int SystemMonitor::reportingRange() const
     return d->reportingRange;
 }
 
+// The resolutions (in msec) of the history tiers: 1 second, 10 seconds and 1 minute
+QList<int> SystemMonitor::historyResolutions() const
+{
+    Q_D(const SystemMonitor);
+
+    AM_AUTHENTICATE_DBUS(QList<int>)
+
+    return d->history.resolutions().toList();
+}
+
+/*! \internal
+    Returns the down-sampled history of the CPU load, the memory usage and the FPS for the given
+    \a resolution (or the next coarser one) as a list of maps with the keys \c timestamp,
+    \c resolution, \c samples and one \c{{ min, max, avg }} map per recorded metric. Only
+    buckets that started at or after \a since (in msecs since the epoch) are returned.
+*/
+QVariantList SystemMonitor::history(int resolution, qint64 since) const
+{
+    Q_D(const SystemMonitor);
+
+    AM_AUTHENTICATE_DBUS(QVariantList)
+
+    return d->history.buckets(resolution, since);
+}
+
+/*! \internal
+    Writes the history to the file \a fileName in the dump directory. Returns \c false, if no
+    dump directory is configured or if \a fileName is not a plain file name.
+*/
+bool SystemMonitor::dumpHistory(const QString &fileName) const
+{
+    Q_D(const SystemMonitor);
+
+    AM_AUTHENTICATE_DBUS_REQUIRE_POLICY(bool)
+
+    const QString filePath = d->dumpFilePath(fileName);
+    return !filePath.isEmpty() && d->history.dump(filePath);
+}
+
+QString SystemMonitor::dumpDirectory() const
+{
+    Q_D(const SystemMonitor);
+    return d->dumpDirectory;
+}
+
+void SystemMonitor::setDumpDirectory(const QString &dir)
+{
+    Q_D(SystemMonitor);
+    d->dumpDirectory = dir;
+}
+
+// Makes the crash handler dump the history to fileName
+void SystemMonitor::setHistoryCrashDumpFile(const QString &fileName)
+{
+    Q_D(SystemMonitor);
+
+    crashDumpFile = QFile::encodeName(fileName);
+    crashDumpHistory = &d->history;
+    setCrashCallback(fileName.isEmpty() ? nullptr : dumpHistoryOnCrash);
+}
+
+/*! \internal
+    Writes the events of the trace ring buffers as Chrome trace-event JSON to the file \a fileName
+    in the dump directory. The trace points are only compiled in with \c{-config enable-tracing}:
+    the trace is empty otherwise. Returns \c false, if no dump directory is configured or if
+    \a fileName is not a plain file name.
+*/
+bool SystemMonitor::dumpTrace(const QString &fileName) const
+{
+    Q_D(const SystemMonitor);
+
+    AM_AUTHENTICATE_DBUS_REQUIRE_POLICY(bool)
+
+    const QString filePath = d->dumpFilePath(fileName);
+    return !filePath.isEmpty() && Trace::dump(filePath);
+}
+
+bool SystemMonitor::setDBusPolicy(const QVariantMap &yamlFragment)
+{
+    Q_D(SystemMonitor);
+
+    static const QVector<QByteArray> functions {
+        QT_STRINGIFY(historyResolutions),
+        QT_STRINGIFY(history),
+        QT_STRINGIFY(dumpHistory),
+        QT_STRINGIFY(dumpTrace)
+    };
+
+    d->dbusPolicy = parseDBusPolicy(yamlFragment);
+
+    for (auto it = d->dbusPolicy.cbegin(); it != d->dbusPolicy.cend(); ++it) {
+       if (!functions.contains(it.key()))
+           return false;
+    }
+    return true;
+}
+
+/*! \internal
+    report a frame swap for any window. \a item is \c 0 for the system-ui. Frames of application
+    windows are forwarded to the ProcessMonitor of \a applicationId, if it has FPS reporting enabled.
+    The \a refreshRate of the window's screen is used to calculate the ideal frame time.
+*/
+void SystemMonitor::reportFrameSwap(QObject *item, const QString &applicationId, qreal refreshRate)
+{
+    Q_D(SystemMonitor);
+
+    if (item) {
+        if (!applicationId.isEmpty()) {
+            if (ProcessMonitor *pm = d->findProcess(applicationId))
+                pm->reportFrameSwap(item, refreshRate);
+        }
+        return;
+    }
+
+    if (!d->reportFps)
+        return;
+
+    if (!d->frameTimer)
+        d->frameTimer = new FrameTimer();
+
+    d->frameTimer->setRefreshRate(refreshRate);
+    d->frameTimer->newFrame();
+}
+
+/*! \internal
+    Enables the sampling of the memory usage of all the applications that have a cgroup of their
+    own on every reporting interval. The values are delivered via applicationMemorySampled().
+*/
+void SystemMonitor::setApplicationMemorySamplingEnabled(bool enabled)
+{
+    Q_D(SystemMonitor);
+
+    if (d->sampleApplicationMemory == enabled)
+        return;
+    d->sampleApplicationMemory = enabled;
+    d->updateApplicationControlGroups();
+    d->setupTimer();
+}
+
 /*! \internal
-    report a frame swap for any window. \a item is \c 0 for the system-ui
+    report a frame swap for a system-ui window on the screen named \a screenName, which is
+    running at \a refreshRate Hz. Every screen gets its own statistics.
 */
-void SystemMonitor::reportFrameSwap(QObject *item)
+void SystemMonitor::reportScreenFrameSwap(const QString &screenName, qreal refreshRate)
 {
     Q_D(SystemMonitor);
 
     if (!d->reportFps)
         return;
 
-    FrameTimer *frameTimer = d->frameTimer.value(item);
-    if (!frameTimer) {
+    FrameTimer *&frameTimer = d->screenFrameTimer[screenName];
+    if (!frameTimer)
         frameTimer = new FrameTimer();
-        d->frameTimer.insert(item, frameTimer);
-        if (item)
-            connect(item, &QObject::destroyed, this, [d](QObject *o) { delete d->frameTimer.take(o); });
-    }
 
+    frameTimer->setRefreshRate(refreshRate);
     frameTimer->newFrame();
 }
 
+/*! \internal
+    report that the window \a item (\c nullptr for the system-ui) started to render a new frame:
+    the time since the last frame swap was spent idle and is not counted as frame time.
+*/
+void SystemMonitor::reportFrameStart(QObject *item)
+{
+    Q_D(SystemMonitor);
+
+    if (!d->reportFps)
+        return;
+
+    if (!item && d->frameTimer)
+        d->frameTimer->frameStarted();
+}
+
+/*! \internal
+    report that a system-ui window on the screen named \a screenName started to render a new frame.
+*/
+void SystemMonitor::reportScreenFrameStart(const QString &screenName)
+{
+    Q_D(SystemMonitor);
+
+    if (!d->reportFps)
+        return;
+
+    if (FrameTimer *frameTimer = d->screenFrameTimer.value(screenName))
+        frameTimer->frameStarted();
+}
+
 QObject *SystemMonitor::getProcessMonitor(const QString &appId)
 {
     Q_D(SystemMonitor);
@@ -42,6 +42,9 @@
 #pragma once
 
 #include <QAbstractListModel>
+#if defined(QT_DBUS_LIB)
+#  include <QDBusContext>
+#endif
 #include <QtAppManCommon/global.h>
 
 QT_FORWARD_DECLARE_CLASS(QQmlEngine)
@@ -53,10 +56,14 @@ class SystemMonitorPrivate;
 class ProcessMonitor;
 
 class SystemMonitor : public QAbstractListModel
+#if defined(QT_DBUS_LIB)
+        , protected QDBusContext
+#endif
 {
     Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "io.qt.SystemMonitor")
     Q_PROPERTY(int count READ count NOTIFY countChanged)
-    Q_PROPERTY(int reportingInterval READ reportingInterval WRITE setReportingInterval)
+    Q_PROPERTY(int reportingInterval READ reportingInterval WRITE setReportingInterval NOTIFY reportingIntervalChanged)
     Q_PROPERTY(int reportingRange READ reportingRange WRITE setReportingRange)
     Q_PROPERTY(qreal idleLoadAverage READ idleLoadAverage WRITE setIdleLoadAverage)
     Q_PROPERTY(quint64 totalMemory READ totalMemory CONSTANT)
@@ -64,6 +71,8 @@ class SystemMonitor : public QAbstractListModel
     Q_PROPERTY(bool memoryReportingEnabled READ isMemoryReportingEnabled WRITE setMemoryReportingEnabled NOTIFY memoryReportingEnabledChanged)
     Q_PROPERTY(bool cpuLoadReportingEnabled READ isCpuLoadReportingEnabled WRITE setCpuLoadReportingEnabled NOTIFY cpuLoadReportingEnabledChanged)
     Q_PROPERTY(bool fpsReportingEnabled READ isFpsReportingEnabled WRITE setFpsReportingEnabled NOTIFY fpsReportingEnabledChanged)
+    Q_PROPERTY(bool pressureReportingAvailable READ isPressureReportingAvailable CONSTANT)
+    Q_PROPERTY(bool pressureReportingEnabled READ isPressureReportingEnabled WRITE setPressureReportingEnabled NOTIFY pressureReportingEnabledChanged)
     Q_PROPERTY(bool idle READ isIdle NOTIFY idleChanged)
 
 public:
@@ -105,31 +114,67 @@ public:
     void setFpsReportingEnabled(bool enabled);
     bool isFpsReportingEnabled() const;
 
+    bool isPressureReportingAvailable() const;
+    void setPressureReportingEnabled(bool enabled);
+    bool isPressureReportingEnabled() const;
+    Q_INVOKABLE bool addPressureTrigger(const QString &resource, int stallThreshold, int timeWindow,
+                                        const QString &controlGroup = QString());
+    Q_INVOKABLE void removePressureTriggers(const QString &resource, const QString &controlGroup = QString());
+    Q_INVOKABLE QVariantMap pressure(const QString &resource, const QString &controlGroup = QString()) const;
+
     void setReportingInterval(int intervalInMSec);
     int reportingInterval() const;
 
     void setReportingRange(int rangeInMSec);
     int reportingRange() const;
 
+    Q_INVOKABLE QList<int> historyResolutions() const;
+    Q_INVOKABLE QVariantList history(int resolution, qint64 since = 0) const;
+    Q_INVOKABLE bool dumpHistory(const QString &fileName) const;
+    QString dumpDirectory() const;
+    void setDumpDirectory(const QString &dir);
+    void setHistoryCrashDumpFile(const QString &fileName);
+    Q_INVOKABLE bool dumpTrace(const QString &fileName) const;
+
+    bool setDBusPolicy(const QVariantMap &yamlFragment);
+
     // semi-public API: used for the WindowManager to report FPS
-    void reportFrameSwap(QObject *item);
+    void reportFrameSwap(QObject *item, const QString &applicationId = QString(), qreal refreshRate = 0);
+    void reportScreenFrameSwap(const QString &screenName, qreal refreshRate);
+    void reportFrameStart(QObject *item);
+    void reportScreenFrameStart(const QString &screenName);
+
+    // semi-public API: used for the ApplicationManager's memory usage roles
+    void setApplicationMemorySamplingEnabled(bool enabled);
 
     Q_INVOKABLE QObject *getProcessMonitor(const QString &appId);
 
 signals:
     void countChanged();
+    void reportingIntervalChanged(int interval);
     void idleChanged(bool idle);
     void memoryLowWarning();
     void memoryCriticalWarning();
 
     void memoryReportingChanged(quint64 total, quint64 used);
     void cpuLoadReportingChanged(int interval, qreal load);
+    void cpuStatesReportingChanged(int interval, qreal user, qreal system, qreal ioWait, qreal irq, qreal steal);
+    void cpuCoreLoadReportingChanged(int interval, const QVariantList &coreLoads);
     void ioLoadReportingChanged(const QString &device, int interval, qreal load);
     void fpsReportingChanged(qreal average, qreal minimum, qreal maximum, qreal jitter);
+    void screenFpsReportingChanged(const QString &screen, qreal average, qreal minimum, qreal maximum, qreal jitter);
+    void frameTimeReportingChanged(qreal p50, qreal p95, qreal p99, int droppedFrames, qreal longestFrameTime);
+
+    void cpuPressureChanged(qreal some, qreal full);
+    void memoryPressureChanged(qreal some, qreal full);
+    void ioPressureChanged(qreal some, qreal full);
+    void controlGroupPressureChanged(const QString &controlGroup, const QString &resource, qreal some, qreal full);
+    void applicationMemorySampled(const QVariantMap &usage);
 
     void memoryReportingEnabledChanged();
     void cpuLoadReportingEnabledChanged();
     void fpsReportingEnabledChanged();
+    void pressureReportingEnabledChanged();
 
 private:
     SystemMonitor();
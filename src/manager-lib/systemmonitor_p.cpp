@@ -40,9 +40,17 @@
 ****************************************************************************/
 
 #include <qglobal.h>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QTimerEvent>
 
 #include "systemmonitor_p.h"
+#include "processmonitor.h"
 #include "global.h"
+#if defined(Q_OS_LINUX)
+#  include "sysfsreader.h"
+#  include "controlgroupv2.h"
+#endif
 
 QT_BEGIN_NAMESPACE_AM
 
@@ -53,6 +61,214 @@ quint64 MemoryReader::totalValue() const
     return s_totalValue;
 }
 
+
+SystemMonitorSampler::SystemMonitorSampler()
+{ }
+
+SystemMonitorSampler::~SystemMonitorSampler()
+{
+    // the readers have been created on the sampling thread, which we are still running on
+    delete m_idleCpu;
+    delete m_cpu;
+    delete m_memory;
+    qDeleteAll(m_io);
+    delete m_cpuPressure;
+    delete m_memoryPressure;
+    delete m_ioPressure;
+#if defined(Q_OS_LINUX)
+    delete m_batch;
+    delete m_procFs;
+#endif
+}
+
+void SystemMonitorSampler::setConfiguration(const Configuration &config)
+{
+    {
+        QMutexLocker locker(&m_configurationMutex);
+        m_newConfiguration = config;
+    }
+    QMetaObject::invokeMethod(this, "applyConfiguration", Qt::QueuedConnection);
+}
+
+bool SystemMonitorSampler::takeReport(Report *report)
+{
+    // re-arm the notification before looking at the queue: a report that is pushed after the
+    // last successful pop will then always trigger a new reportsAvailable() signal
+    m_notificationPending.storeRelease(0);
+    return m_reports.pop(report);
+}
+
+void SystemMonitorSampler::applyConfiguration()
+{
+    Configuration config;
+    {
+        QMutexLocker locker(&m_configurationMutex);
+        config = m_newConfiguration;
+    }
+
+    if (!m_idleCpu) {
+        m_idleCpu = new CpuReader;
+        m_idleTimerId = startTimer(1000);
+    }
+#if defined(Q_OS_LINUX)
+    if (!m_batch)
+        m_batch = new SysFsBatch;
+    if (!m_procFs)
+        m_procFs = new ProcFsPrefetcher;
+#endif
+    if (config.cpu && !m_cpu)
+        m_cpu = new CpuReader;
+    if (config.memory && !m_memory)
+        m_memory = new MemoryReader;
+    if (config.pressure && !m_cpuPressure) {
+        m_cpuPressure = new PressureReader("cpu");
+        m_memoryPressure = new PressureReader("memory");
+        m_ioPressure = new PressureReader("io");
+    }
+    for (auto it = m_io.begin(); it != m_io.end(); ) {
+        if (!config.ioDevices.contains(it.key())) {
+            delete it.value();
+            it = m_io.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const QString &device : qAsConst(config.ioDevices)) {
+        if (!m_io.contains(device))
+            m_io.insert(device, new IoReader(device.toLocal8Bit().constData()));
+    }
+
+    bool shouldBeOn = config.cpu || config.memory || config.pressure || config.fps
+            || !config.ioDevices.isEmpty() || (config.resourceUsage && !config.processMonitors.isEmpty())
+            || config.applicationMemory;
+    // the metrics export needs the applications' resource usage, even if nothing is reported
+    if (config.interval <= 0 && config.resourceUsage)
+        config.interval = 1000;
+    if (m_timerId && (!shouldBeOn || config.interval != m_configuration.interval)) {
+        killTimer(m_timerId);
+        m_timerId = 0;
+    }
+    if (shouldBeOn && !m_timerId && config.interval > 0)
+        m_timerId = startTimer(config.interval);
+
+    m_configuration = config;
+}
+
+void SystemMonitorSampler::sampleMemoryUsage()
+{
+    if (!m_memory)
+        m_memory = new MemoryReader;
+    emit memoryUsageSampled(m_memory->readUsedValue());
+}
+
+void SystemMonitorSampler::timerEvent(QTimerEvent *te)
+{
+    if (te && te->timerId() == m_timerId)
+        sample();
+    else if (te && te->timerId() == m_idleTimerId)
+        emit idleLoadSampled(m_idleCpu->readLoadValue().second);
+}
+
+void SystemMonitorSampler::sample()
+{
+    Report r;
+
+    // Report process only on half interval to decrease overload
+    bool sampleProcesses = m_sampleProcesses;
+    m_sampleProcesses = !m_sampleProcesses;
+
+#if defined(Q_OS_LINUX)
+    // prefetch all the files we need in this tick with a single syscall: the readers below
+    // are then just parsing the buffers
+    if (sampleProcesses) {
+        m_procFs->reset();
+        for (ProcessMonitor *pm : qAsConst(m_configuration.processMonitors))
+            pm->prefetch(m_procFs);
+        m_procFs->addTo(m_batch);
+    }
+    if (m_batch->usesIoUring()) {
+        if (m_configuration.cpu)
+            m_batch->add(m_cpu->sysFs());
+        if (m_configuration.memory)
+            m_batch->add(m_memory->sysFs());
+        for (const IoReader *io : qAsConst(m_io))
+            m_batch->add(io->sysFs());
+        if (m_configuration.pressure) {
+            m_batch->add(m_cpuPressure->sysFs());
+            m_batch->add(m_memoryPressure->sysFs());
+            m_batch->add(m_ioPressure->sysFs());
+        }
+        m_batch->submit();
+    }
+#endif
+
+    if (sampleProcesses) {
+        for (ProcessMonitor *pm : qAsConst(m_configuration.processMonitors)) {
+#if defined(Q_OS_LINUX)
+            pm->sampleData(m_procFs);
+#else
+            pm->sampleData();
+#endif
+        }
+        r.processesSampled = true;
+    }
+
+    if (m_configuration.applicationMemory) {
+        for (auto it = m_configuration.applicationControlGroups.cbegin();
+             it != m_configuration.applicationControlGroups.cend(); ++it) {
+            QVariantMap usage;
+#if defined(Q_OS_LINUX)
+            qint64 used = ControlGroupV2::memoryUsage(it.value());
+            quint64 anonymous, file, kernel;
+            if (used < 0)
+                continue;
+            usage.insert(qSL("used"), used);
+            if (ControlGroupV2::memoryStatistics(it.value(), &anonymous, &file, &kernel)) {
+                usage.insert(qSL("anonymous"), anonymous);
+                usage.insert(qSL("file"), file);
+                usage.insert(qSL("kernel"), kernel);
+            }
+#endif
+            r.applicationMemory.insert(it.key(), usage);
+        }
+        r.applicationMemorySampled = true;
+    }
+
+    if (m_configuration.cpu) {
+        QPair<int, qreal> cpuVal = m_cpu->readLoadValue();
+        r.hasCpu = true;
+        r.cpuInterval = cpuVal.first;
+        r.cpuLoad = cpuVal.second;
+        if (m_cpu->hasDetails()) {
+            r.hasCpuDetails = true;
+            r.cpuDetails = m_cpu->details();
+            r.cpuCoreLoads = m_cpu->coreLoads();
+        }
+    }
+    if (m_configuration.memory) {
+        r.hasMemory = true;
+        r.memoryUsed = m_memory->readUsedValue();
+    }
+    for (auto it = m_io.cbegin(); it != m_io.cend(); ++it) {
+        QPair<int, qreal> ioVal = it.value()->readLoadValue();
+        r.ioIntervals.insert(it.key(), ioVal.first);
+        r.ioLoad.insert(it.key(), ioVal.second);
+    }
+    if (m_configuration.pressure) {
+        r.hasPressure = true;
+        r.cpuPressure = m_cpuPressure->readStallValues();
+        r.memoryPressure = m_memoryPressure->readStallValues();
+        r.ioPressure = m_ioPressure->readStallValues();
+    }
+
+    // if the GUI thread is blocked for so long that the queue is full, dropping reports is the
+    // best we can do
+    if (!m_reports.push(r))
+        return;
+    if (m_notificationPending.testAndSetOrdered(0, 1))
+        emit reportsAvailable();
+}
+
 QT_END_NAMESPACE_AM
 
 #if defined(Q_OS_LINUX)
@@ -60,69 +276,109 @@ QT_END_NAMESPACE_AM
 #  include <qplatformdefs.h>
 #  include <QElapsedTimer>
 #  include <QSocketNotifier>
+#  include <QFile>
+#  include <QTimerEvent>
+#  include "controlgroupv2.h"
 
 #  include <sys/eventfd.h>
 #  include <fcntl.h>
 #  include <unistd.h>
 #  include <sys/ioctl.h>
 #  include <errno.h>
+#  include <cstring>
 
 QT_BEGIN_NAMESPACE_AM
 
-QScopedPointer<SysFsReader> CpuReader::s_sysFs;
-
 CpuReader::CpuReader()
 {
-    if (!s_sysFs) {
-        s_sysFs.reset(new SysFsReader("/proc/stat", 256));
-        if (!s_sysFs->isOpen())
-            qCWarning(LogSystem) << "WARNING: could not read CPU statistics from" << s_sysFs->fileName();
-    }
+    int cores = qMax(1, int(sysconf(_SC_NPROCESSORS_CONF)));
+    m_coreLoads.resize(cores);
+    m_lastCoreTicks.resize(cores);
+
+    // the aggregated "cpu" line comes first, followed by one line per core
+    m_sysFs.reset(new SysFsReader("/proc/stat", 128 * (cores + 1)));
+    if (!m_sysFs->isOpen())
+        qCWarning(LogSystem) << "WARNING: could not read CPU statistics from" << m_sysFs->fileName();
+}
+
+CpuReader::~CpuReader()
+{ }
+
+bool CpuReader::hasDetails() const
+{
+    return true;
 }
 
 QPair<int, qreal> CpuReader::readLoadValue()
 {
-    QByteArray str = s_sysFs->readValue();
+    // this is called very often, so we parse the buffer in-place without any allocations
+    const QByteArray str = m_sysFs->readValue();
+    const char *pos = str.constData();
+    const char *end = pos + str.size();
+
+    auto loadOf = [](const Ticks &now, const Ticks &last) {
+        qint64 total = now.total() - last.total();
+        return total > 0 ? qBound(qreal(0), qreal(1) - qreal(now.idle() - last.idle()) / qreal(total), qreal(1))
+                         : qreal(0);
+    };
 
-    int pos = 0;
-    qint64 total = 0;
-    QVector<qint64> values;
+    bool foundAggregate = false;
+    while ((end - pos) > 3 && !memcmp(pos, "cpu", 3)) {
+        pos += 3;
+        int core = -1;
+        if (*pos >= '0' && *pos <= '9') {
+            core = 0;
+            while (pos < end && *pos >= '0' && *pos <= '9')
+                core = core * 10 + (*pos++ - '0');
+        }
 
-    while (pos < str.size() && values.size() < 4) {
-        if (!isdigit(str.at(pos))) {
+        Ticks ticks;
+        for (int i = 0; i < 8; ++i) {
+            while (pos < end && *pos == ' ')
+                ++pos;
+            qint64 value = 0;
+            while (pos < end && *pos >= '0' && *pos <= '9')
+                value = value * 10 + (*pos++ - '0');
+            ticks.values[i] = value;
+        }
+        while (pos < end && *pos != '\n')
             ++pos;
-            continue;
+        ++pos;
+
+        if (core < 0) {
+            qint64 total = ticks.total() - m_lastTicks.total();
+            m_load = loadOf(ticks, m_lastTicks);
+            if (total > 0) {
+                m_details.user = qreal(ticks.values[0] + ticks.values[1] - m_lastTicks.values[0] - m_lastTicks.values[1]) / total;
+                m_details.system = qreal(ticks.values[2] - m_lastTicks.values[2]) / total;
+                m_details.ioWait = qreal(ticks.values[4] - m_lastTicks.values[4]) / total;
+                m_details.irq = qreal(ticks.values[5] + ticks.values[6] - m_lastTicks.values[5] - m_lastTicks.values[6]) / total;
+                m_details.steal = qreal(ticks.values[7] - m_lastTicks.values[7]) / total;
+            }
+            m_lastIdle = ticks.idle();
+            m_lastTotal = ticks.total();
+            m_lastTicks = ticks;
+            foundAggregate = true;
+        } else if (core < m_coreLoads.size()) {
+            // offline cores are simply missing
+            m_coreLoads[core] = loadOf(ticks, m_lastCoreTicks.at(core));
+            m_lastCoreTicks[core] = ticks;
         }
-
-        char *endPtr = 0;
-        qint64 val = strtoll(str.constData() + pos, &endPtr, 10); // check missing for over-/underflow
-        values << val;
-        total += val;
-        pos = endPtr - str.constData() + 1;
     }
-
-    if (values.size() >= 4) {
-        qint64 idle = values.at(3);
-
-        m_load = qreal(1) - (qreal(idle - m_lastIdle) / qreal(total - m_lastTotal));
-
-        m_lastIdle = idle;
-        m_lastTotal = total;
-    } else {
+    if (!foundAggregate)
         m_load = qreal(1);
-    }
+
     return qMakePair(m_lastCheck.restart(), m_load);
 }
 
 
-QScopedPointer<SysFsReader> MemoryReader::s_sysFs;
+bool MemoryReader::s_useMemInfo = false;
 
 MemoryReader::MemoryReader()
 {
-    if (!s_sysFs) {
-        s_sysFs.reset(new SysFsReader("/sys/fs/cgroup/memory/memory.usage_in_bytes", 256));
-        if (!s_sysFs->isOpen())
-            qCWarning(LogSystem) << "WARNING: could not read memory statistics from" << s_sysFs->fileName() << "(make sure that the memory cgroup is mounted)";
+    // readers are created on different threads: the static initialization is thread-safe
+    static const bool staticsInitialized = []() {
+        s_useMemInfo = ControlGroupV2::isAvailable();
 
         long pageSize = ::sysconf(_SC_PAGESIZE);
         long physPages = ::sysconf(_SC_PHYS_PAGES);
@@ -133,12 +389,34 @@ MemoryReader::MemoryReader()
         } else {
             s_totalValue = quint64(physPages) * quint64(pageSize);
         }
-    }
+        return true;
+    }();
+    Q_UNUSED(staticsInitialized)
+
+    if (s_useMemInfo)
+        m_sysFs.reset(new SysFsReader("/proc/meminfo", 256)); // MemTotal, MemFree and MemAvailable come first
+    else
+        m_sysFs.reset(new SysFsReader("/sys/fs/cgroup/memory/memory.usage_in_bytes", 256));
+    if (!m_sysFs->isOpen())
+        qCWarning(LogSystem) << "WARNING: could not read memory statistics from" << m_sysFs->fileName() << "(make sure that the memory cgroup is mounted)";
 }
 
+MemoryReader::~MemoryReader()
+{ }
+
 quint64 MemoryReader::readUsedValue() const
 {
-    return ::strtoull(s_sysFs->readValue().constData(), 0, 10);
+    if (s_useMemInfo) {
+        const QByteArray str = m_sysFs->readValue();
+        auto readKb = [&str](const char *key) -> quint64 {
+            int pos = str.indexOf(key);
+            return (pos < 0) ? 0 : ::strtoull(str.constData() + pos + qstrlen(key), 0, 10) * 1024;
+        };
+        quint64 total = readKb("MemTotal:");
+        quint64 available = readKb("MemAvailable:");
+        return (total > available) ? (total - available) : 0;
+    }
+    return ::strtoull(m_sysFs->readValue().constData(), 0, 10);
 }
 
 
@@ -215,7 +493,12 @@ bool MemoryThreshold::setEnabled(bool enabled)
 {
     if (m_enabled == enabled)
         return true;
-    if (enabled && !m_initialized) {
+    if (enabled && !m_initialized && ControlGroupV2::isAvailable()) {
+        m_memoryReader.reset(new MemoryReader);
+        m_lastLevel = thresholdLevel();
+        m_pollTimerId = startTimer(1000);
+        return m_initialized = m_enabled = true;
+    } else if (enabled && !m_initialized) {
         qint64 totalMem = MemoryReader().totalValue();
 
         m_eventFd = ::eventfd(0, EFD_CLOEXEC);
@@ -264,12 +547,167 @@ bool MemoryThreshold::setEnabled(bool enabled)
         return false;
     } else {
         m_enabled = enabled;
-        m_notifier->setEnabled(enabled);
-
+        if (m_notifier) {
+            m_notifier->setEnabled(enabled);
+        } else if (enabled) {
+            m_pollTimerId = startTimer(1000);
+        } else if (m_pollTimerId) {
+            killTimer(m_pollTimerId);
+            m_pollTimerId = 0;
+        }
         return true;
     }
 }
 
+int MemoryThreshold::thresholdLevel() const
+{
+    if (!m_memoryReader || !m_memoryReader->totalValue())
+        return 0;
+    qreal percent = qreal(m_memoryReader->readUsedValue()) * 100 / m_memoryReader->totalValue();
+
+    int level = 0;
+    for (qreal threshold : m_thresholds) {
+        if (percent > threshold)
+            ++level;
+    }
+    return level;
+}
+
+void MemoryThreshold::timerEvent(QTimerEvent *te)
+{
+    if (te->timerId() != m_pollTimerId)
+        return;
+
+    // just like the cgroup v1 eventfd, trigger on every crossing of a threshold
+    int level = thresholdLevel();
+    if (level != m_lastLevel) {
+        m_lastLevel = level;
+        emit thresholdTriggered();
+    }
+}
+
+static QByteArray pressureFilePath(const QByteArray &resource, const QString &controlGroup)
+{
+    if (controlGroup.isEmpty())
+        return "/proc/pressure/" + resource;
+    return QFile::encodeName(ControlGroupV2::mountPoint() + qL1C('/') + controlGroup + qL1C('/'))
+            + resource + ".pressure";
+}
+
+PressureReader::PressureReader(const QByteArray &resource, const QString &controlGroup)
+    : m_sysFs(new SysFsReader(pressureFilePath(resource, controlGroup), 256))
+{
+    if (!m_sysFs->isOpen())
+        qCWarning(LogSystem) << "WARNING: could not read pressure stall information from" << m_sysFs->fileName();
+}
+
+PressureReader::~PressureReader()
+{ }
+
+bool PressureReader::isAvailable()
+{
+    // needs Linux 4.20 and CONFIG_PSI (it can also be disabled with psi=0 on the command line)
+    static int available = -1;
+    if (available < 0)
+        available = (QT_ACCESS("/proc/pressure/cpu", R_OK) == 0) ? 1 : 0;
+    return available;
+}
+
+bool PressureReader::isOpen() const
+{
+    return m_sysFs->isOpen();
+}
+
+QPair<qreal, qreal> PressureReader::readStallValues()
+{
+    // "some avg10=1.53 avg60=0.87 avg300=0.31 total=1234567\nfull avg10=..."
+    // strtod() is locale dependent, so we parse the fixed-point numbers ourselves
+    const QByteArray str = m_sysFs->readValue();
+    auto avg10 = [&str](const char *line) -> qreal {
+        int pos = str.indexOf(line);
+        if (pos < 0)
+            return 0;
+        pos = str.indexOf("avg10=", pos);
+        if (pos < 0)
+            return 0;
+        const char *s = str.constData() + pos + 6;
+        qreal value = 0;
+        while (*s >= '0' && *s <= '9')
+            value = value * 10 + (*s++ - '0');
+        if (*s == '.') {
+            qreal factor = 0.1;
+            while (*++s >= '0' && *s <= '9') {
+                value += factor * (*s - '0');
+                factor /= 10;
+            }
+        }
+        return value / 100;
+    };
+    return qMakePair(avg10("some "), avg10("full "));
+}
+
+
+PressureTrigger::PressureTrigger(const QByteArray &resource, const QString &controlGroup, QObject *parent)
+    : QObject(parent)
+    , m_resource(resource)
+    , m_controlGroup(controlGroup)
+{ }
+
+PressureTrigger::~PressureTrigger()
+{
+    if (m_fd >= 0)
+        QT_CLOSE(m_fd);
+}
+
+QByteArray PressureTrigger::resource() const
+{
+    return m_resource;
+}
+
+QString PressureTrigger::controlGroup() const
+{
+    return m_controlGroup;
+}
+
+bool PressureTrigger::setThreshold(int stallMSec, int windowMSec)
+{
+    // the kernel only accepts windows between 500ms and 10s (unprivileged users: multiples of 2s)
+    if (windowMSec < 500 || windowMSec > 10000 || stallMSec <= 0 || stallMSec > windowMSec) {
+        qCWarning(LogSystem) << "Invalid pressure trigger parameters for" << m_resource << ": stall"
+                             << stallMSec << "ms in a window of" << windowMSec << "ms";
+        return false;
+    }
+
+    delete m_notifier;
+    m_notifier = nullptr;
+    if (m_fd >= 0)
+        QT_CLOSE(m_fd);
+
+    const QByteArray path = pressureFilePath(m_resource, m_controlGroup);
+    m_fd = QT_OPEN(path.constData(), O_RDWR | O_NONBLOCK);
+    if (m_fd < 0) {
+        qCWarning(LogSystem) << "Could not open" << path << ":" << strerror(errno);
+        return false;
+    }
+
+    // every trigger needs its own file descriptor
+    const QByteArray trigger = "some " + QByteArray::number(qint64(stallMSec) * 1000) + ' '
+            + QByteArray::number(qint64(windowMSec) * 1000);
+    if (QT_WRITE(m_fd, trigger.constData(), size_t(trigger.size() + 1)) < 0) {
+        qCWarning(LogSystem) << "Could not register the pressure trigger" << trigger << "on" << path
+                             << ":" << strerror(errno);
+        QT_CLOSE(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    // the kernel signals POLLPRI, which maps to QSocketNotifier::Exception
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Exception, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &PressureTrigger::triggered);
+    return true;
+}
+
+
 void MemoryThreshold::readEventFd()
 {
     if (m_eventFd >= 0) {
@@ -304,6 +742,14 @@ QT_BEGIN_NAMESPACE_AM
 CpuReader::CpuReader()
 { }
 
+CpuReader::~CpuReader()
+{ }
+
+bool CpuReader::hasDetails() const
+{
+    return false;
+}
+
 QPair<int, qreal> CpuReader::readLoadValue()
 {
     auto winFileTimeToInt64 = [](const FILETIME &filetime) {
@@ -337,6 +783,9 @@ MemoryReader::MemoryReader()
     }
 }
 
+MemoryReader::~MemoryReader()
+{ }
+
 quint64 MemoryReader::readUsedValue() const
 {
     MEMORYSTATUSEX mem { sizeof(MEMORYSTATUSEX) };
@@ -357,6 +806,14 @@ QT_BEGIN_NAMESPACE_AM
 CpuReader::CpuReader()
 { }
 
+CpuReader::~CpuReader()
+{ }
+
+bool CpuReader::hasDetails() const
+{
+    return false;
+}
+
 QPair<int, qreal> CpuReader::readLoadValue()
 {
     natural_t cpuCount = 0;
@@ -408,6 +865,9 @@ MemoryReader::MemoryReader()
     }
 }
 
+MemoryReader::~MemoryReader()
+{ }
+
 quint64 MemoryReader::readUsedValue() const
 {
     vm_statistics64_data_t vmStat;
@@ -434,6 +894,14 @@ QT_BEGIN_NAMESPACE_AM
 CpuReader::CpuReader()
 { }
 
+CpuReader::~CpuReader()
+{ }
+
+bool CpuReader::hasDetails() const
+{
+    return false;
+}
+
 QPair<int, qreal> CpuReader::readLoadValue()
 {
     return qMakePair(0, 1);
@@ -442,6 +910,9 @@ QPair<int, qreal> CpuReader::readLoadValue()
 MemoryReader::MemoryReader()
 { }
 
+MemoryReader::~MemoryReader()
+{ }
+
 quint64 MemoryReader::readUsedValue() const
 {
     return 0;
@@ -468,6 +939,56 @@ QPair<int, qreal> IoReader::readLoadValue()
     return qMakePair(0, 1);
 }
 
+PressureReader::PressureReader(const QByteArray &resource, const QString &controlGroup)
+{
+    Q_UNUSED(resource)
+    Q_UNUSED(controlGroup)
+}
+
+PressureReader::~PressureReader()
+{ }
+
+bool PressureReader::isAvailable()
+{
+    return false;
+}
+
+bool PressureReader::isOpen() const
+{
+    return false;
+}
+
+QPair<qreal, qreal> PressureReader::readStallValues()
+{
+    return qMakePair(qreal(0), qreal(0));
+}
+
+PressureTrigger::PressureTrigger(const QByteArray &resource, const QString &controlGroup, QObject *parent)
+    : QObject(parent)
+    , m_resource(resource)
+    , m_controlGroup(controlGroup)
+{ }
+
+PressureTrigger::~PressureTrigger()
+{ }
+
+QByteArray PressureTrigger::resource() const
+{
+    return m_resource;
+}
+
+QString PressureTrigger::controlGroup() const
+{
+    return m_controlGroup;
+}
+
+bool PressureTrigger::setThreshold(int stallMSec, int windowMSec)
+{
+    Q_UNUSED(stallMSec)
+    Q_UNUSED(windowMSec)
+    return false;
+}
+
 MemoryThreshold::MemoryThreshold(const QList<qreal> &thresholds)
 {
     Q_UNUSED(thresholds)
@@ -45,13 +45,21 @@
 #include <QPair>
 #include <QElapsedTimer>
 #include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+#include <QVariantMap>
 #include <QtAppManCommon/global.h>
+#include "spscqueue.h"
 
 #if defined(Q_OS_LINUX)
 #  include <QScopedPointer>
 QT_FORWARD_DECLARE_CLASS(QSocketNotifier)
 QT_BEGIN_NAMESPACE_AM
 class SysFsReader;
+class SysFsBatch;
+class ProcFsPrefetcher;
 QT_END_NAMESPACE_AM
 #endif
 
@@ -60,16 +68,49 @@ QT_BEGIN_NAMESPACE_AM
 class CpuReader
 {
 public:
+    // fractions of the CPU time between the last two calls to readLoadValue()
+    struct Details
+    {
+        qreal user = 0;    // including nice
+        qreal system = 0;
+        qreal ioWait = 0;
+        qreal irq = 0;     // hard and soft interrupts
+        qreal steal = 0;
+    };
+
     CpuReader();
+    ~CpuReader();
     QPair<int, qreal> readLoadValue();
 
+    // only available on Linux: updated by readLoadValue()
+    bool hasDetails() const;
+    Details details() const { return m_details; }
+    const QVector<qreal> &coreLoads() const { return m_coreLoads; }
+#if defined(Q_OS_LINUX)
+    const SysFsReader *sysFs() const { return m_sysFs.data(); }
+#endif
+
 private:
     QElapsedTimer m_lastCheck;
     qint64 m_lastIdle = 0;
     qint64 m_lastTotal = 0;
     qreal m_load = 1;
+    Details m_details;
+    QVector<qreal> m_coreLoads;
 #if defined(Q_OS_LINUX)
-    static QScopedPointer<SysFsReader> s_sysFs;
+    // user, nice, system, idle, iowait, irq, softirq, steal
+    struct Ticks
+    {
+        qint64 values[8] = { 0 };
+
+        qint64 idle() const { return values[3] + values[4]; }
+        qint64 total() const { qint64 t = 0; for (qint64 v : values) t += v; return t; }
+    };
+    Ticks m_lastTicks;
+    QVector<Ticks> m_lastCoreTicks;
+
+    // not shared: the readers are used on different threads and SysFsReader has a mutable buffer
+    QScopedPointer<SysFsReader> m_sysFs;
 #endif
     Q_DISABLE_COPY(CpuReader)
 };
@@ -78,13 +119,18 @@ class MemoryReader
 {
 public:
     MemoryReader();
+    ~MemoryReader();
     quint64 totalValue() const;
     quint64 readUsedValue() const;
+#if defined(Q_OS_LINUX)
+    const SysFsReader *sysFs() const { return m_sysFs.data(); }
+#endif
 
 private:
     static quint64 s_totalValue;
 #if defined(Q_OS_LINUX)
-    static QScopedPointer<SysFsReader> s_sysFs;
+    QScopedPointer<SysFsReader> m_sysFs; // see CpuReader
+    static bool s_useMemInfo; // cgroup v2 has no memory accounting for the root cgroup
 #elif defined(Q_OS_OSX)
     static int s_pageSize;
 #endif
@@ -97,6 +143,9 @@ public:
     IoReader(const char *device);
     ~IoReader();
     QPair<int, qreal> readLoadValue();
+#if defined(Q_OS_LINUX)
+    const SysFsReader *sysFs() const { return m_sysFs.data(); }
+#endif
 
 private:
 #if defined(Q_OS_LINUX)
@@ -108,6 +157,163 @@ private:
     Q_DISABLE_COPY(IoReader)
 };
 
+// Pressure stall information (PSI): the share of time in which at least one ("some") or all
+// non-idle ("full") tasks were stalled waiting for a resource (cpu, memory or io), either
+// system-wide or for a single cgroup v2 (relative to the cgroup2 mount point)
+class PressureReader
+{
+public:
+    PressureReader(const QByteArray &resource, const QString &controlGroup = QString());
+    ~PressureReader();
+
+    static bool isAvailable();
+    bool isOpen() const;
+
+    // the 10 second averages for "some" and "full" as fractions
+    QPair<qreal, qreal> readStallValues();
+#if defined(Q_OS_LINUX)
+    const SysFsReader *sysFs() const { return m_sysFs.data(); }
+#endif
+
+private:
+#if defined(Q_OS_LINUX)
+    QScopedPointer<SysFsReader> m_sysFs;
+#endif
+    Q_DISABLE_COPY(PressureReader)
+};
+
+// A PSI trigger: the kernel notifies us as soon as the stall time within the time window
+// exceeds the threshold, so there is no need to sample the pressure files
+class PressureTrigger : public QObject
+{
+    Q_OBJECT
+
+public:
+    PressureTrigger(const QByteArray &resource, const QString &controlGroup = QString(), QObject *parent = nullptr);
+    ~PressureTrigger();
+
+    QByteArray resource() const;
+    QString controlGroup() const;
+
+    bool setThreshold(int stallMSec, int windowMSec);
+
+signals:
+    void triggered();
+
+private:
+    QByteArray m_resource;
+    QString m_controlGroup;
+#if defined(Q_OS_LINUX)
+    int m_fd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+#endif
+};
+
+class ProcessMonitor;
+
+// Does all the (potentially slow) reading of system and application statistics on a separate
+// thread. Completed reports are handed over to the GUI thread via a lock-free queue, so that
+// the models and their signals are only ever touched on the GUI thread.
+class SystemMonitorSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Configuration
+    {
+        int interval = -1;
+        bool cpu = false;
+        bool memory = false;
+        bool pressure = false;
+        bool fps = false; // read on the GUI thread, but needs the reports to be triggered
+        QStringList ioDevices;
+        QList<ProcessMonitor *> processMonitors;
+        bool resourceUsage = false; // the processes' resource usage for the metrics export
+        bool applicationMemory = false; // the memory usage of the applications' cgroups
+        QHash<QString, QString> applicationControlGroups; // application id -> accounting cgroup
+    };
+
+    struct Report
+    {
+        bool hasCpu = false;
+        bool hasCpuDetails = false;
+        bool hasMemory = false;
+        bool hasPressure = false;
+        bool processesSampled = false;
+        bool applicationMemorySampled = false;
+
+        int cpuInterval = 0;
+        qreal cpuLoad = 0;
+        CpuReader::Details cpuDetails;
+        QVector<qreal> cpuCoreLoads;
+        QPair<qreal, qreal> cpuPressure;
+        QPair<qreal, qreal> memoryPressure;
+        QPair<qreal, qreal> ioPressure;
+        qreal fpsAvg = 0;
+        qreal fpsMin = 0;
+        qreal fpsMax = 0;
+        qreal fpsJitter = 0;
+        qreal frameTimeP50 = 0; // msec
+        qreal frameTimeP95 = 0;
+        qreal frameTimeP99 = 0;
+        int droppedFrames = 0;
+        qreal longestFrameTime = 0;
+        QVariantMap screenFps; // screen name -> map of all the values above
+        QVariantMap applicationIo; // application id -> latest sample of its IoMonitor
+        QVariantMap applicationMemory; // application id -> memory usage of its cgroup
+        quint64 memoryUsed = 0;
+        QVariantMap ioLoad;
+        QHash<QString, int> ioIntervals;
+    };
+
+    SystemMonitorSampler();
+    ~SystemMonitorSampler();
+
+    // GUI thread only
+    void setConfiguration(const Configuration &config);
+    bool takeReport(Report *report);
+
+public slots:
+    void sampleMemoryUsage();
+
+signals:
+    void reportsAvailable();
+    void idleLoadSampled(qreal load);
+    void memoryUsageSampled(quint64 used);
+
+protected:
+    void timerEvent(QTimerEvent *te) override;
+
+private slots:
+    void applyConfiguration();
+
+private:
+    void sample();
+
+    QMutex m_configurationMutex;
+    Configuration m_newConfiguration;
+    Configuration m_configuration;
+
+    int m_timerId = 0;
+    int m_idleTimerId = 0;
+    bool m_sampleProcesses = false;
+
+    CpuReader *m_idleCpu = nullptr;
+    CpuReader *m_cpu = nullptr;
+    MemoryReader *m_memory = nullptr;
+    QHash<QString, IoReader *> m_io;
+    PressureReader *m_cpuPressure = nullptr;
+    PressureReader *m_memoryPressure = nullptr;
+    PressureReader *m_ioPressure = nullptr;
+#if defined(Q_OS_LINUX)
+    SysFsBatch *m_batch = nullptr; // all the statistics files are read in one go
+    ProcFsPrefetcher *m_procFs = nullptr; // the per-process files of the monitored applications
+#endif
+
+    SpscQueue<Report, 16> m_reports;
+    QAtomicInt m_notificationPending;
+};
+
 class MemoryThreshold : public QObject
 {
     Q_OBJECT
@@ -132,7 +338,18 @@ private:
 private slots:
     void readEventFd();
 
+protected:
+    void timerEvent(QTimerEvent *te) override;
+
 private:
+    int thresholdLevel() const;
+
+    // cgroup v2 has no memory thresholds for the root cgroup, so we have to poll: this happens
+    // on the GUI thread, so we need our own reader
+    int m_pollTimerId = 0;
+    int m_lastLevel = 0;
+    QScopedPointer<MemoryReader> m_memoryReader;
+
     int m_eventFd = -1;
     int m_controlFd = -1;
     int m_usageFd = -1;
@@ -0,0 +1,245 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#include <QFile>
+#include <QVariantMap>
+#include <qplatformdefs.h>
+#include <qnumeric.h>
+#include <cstring>
+#include <errno.h>
+
+#include "global.h"
+#include "systemmonitorhistory.h"
+
+QT_BEGIN_NAMESPACE_AM
+
+namespace {
+static const struct {
+    int resolution;
+    int duration;
+} tierSpecs[] = {
+    { 1000, 2 * 60 * 1000 },          // 2 minutes
+    { 10 * 1000, 30 * 60 * 1000 },    // 30 minutes
+    { 60 * 1000, 24 * 60 * 60 * 1000 } // 24 hours
+};
+
+static const char *metricNames[] = { "cpuLoad", "memoryUsed", "fps" };
+
+// The dump file uses the host's byte order:
+//   header: char[4] "AMSH", quint32 version, quint32 metric count, quint32 tier count
+//   per tier: quint32 resolution in msec, quint32 bucket count, followed by the buckets in
+//             chronological order: qint64 timestamp, quint32 samples and the minimum, maximum
+//             and average (float each) of all metrics
+static const quint32 dumpVersion = 1;
+
+static bool writeAll(int fd, const void *data, size_t size)
+{
+    const char *ptr = static_cast<const char *>(data);
+    while (size > 0) {
+        auto written = QT_WRITE(fd, ptr, size);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        ptr += written;
+        size -= size_t(written);
+    }
+    return true;
+}
+}
+
+SystemMonitorHistory::SystemMonitorHistory()
+{
+    Q_STATIC_ASSERT(sizeof(metricNames) / sizeof(*metricNames) == MetricCount);
+
+    for (const auto &spec : tierSpecs) {
+        Tier tier;
+        tier.resolution = spec.resolution;
+        tier.buckets.resize(spec.duration / spec.resolution);
+        resetCurrent(tier, -1);
+        m_tiers.append(tier);
+    }
+}
+
+void SystemMonitorHistory::addSample(qint64 timestamp, const qreal (&values)[MetricCount])
+{
+    for (Tier &tier : m_tiers) {
+        qint64 start = timestamp - (timestamp % tier.resolution);
+        if (start != tier.currentStart) {
+            if (tier.currentSamples)
+                closeCurrent(tier);
+            resetCurrent(tier, start);
+        }
+
+        ++tier.currentSamples;
+        for (int m = 0; m < MetricCount; ++m) {
+            if (qIsNaN(values[m]))
+                continue;
+            float f = float(values[m]);
+            tier.sum[m] += values[m];
+            tier.minimum[m] = tier.valid[m] ? qMin(tier.minimum[m], f) : f;
+            tier.maximum[m] = tier.valid[m] ? qMax(tier.maximum[m], f) : f;
+            ++tier.valid[m];
+        }
+    }
+}
+
+QVector<int> SystemMonitorHistory::resolutions() const
+{
+    QVector<int> result;
+    for (const Tier &tier : m_tiers)
+        result << tier.resolution;
+    return result;
+}
+
+// Returns the buckets of the tier with the given resolution (or the next coarser one)
+QVariantList SystemMonitorHistory::buckets(int resolution, qint64 since) const
+{
+    QVariantList result;
+
+    const Tier *tier = nullptr;
+    for (const Tier &t : m_tiers) {
+        if (t.resolution >= resolution) {
+            tier = &t;
+            break;
+        }
+    }
+    if (!tier)
+        return result;
+
+    for (int i = 0; i < tier->count; ++i) {
+        const Bucket &b = bucketAt(*tier, i);
+        if (b.timestamp < since)
+            continue;
+
+        QVariantMap map;
+        map[qSL("timestamp")] = b.timestamp;
+        map[qSL("resolution")] = tier->resolution;
+        map[qSL("samples")] = b.samples;
+        for (int m = 0; m < MetricCount; ++m) {
+            if (qIsNaN(b.average[m]))
+                continue;
+            QVariantMap values;
+            values[qSL("min")] = qreal(b.minimum[m]);
+            values[qSL("max")] = qreal(b.maximum[m]);
+            values[qSL("avg")] = qreal(b.average[m]);
+            map[qL1S(metricNames[m])] = values;
+        }
+        result << map;
+    }
+    return result;
+}
+
+bool SystemMonitorHistory::dump(const QString &fileName) const
+{
+    QFile f(fileName);
+    if (!f.open(QFile::WriteOnly | QFile::Truncate | QFile::Unbuffered)) {
+        qCWarning(LogSystem) << "Could not open" << fileName << "to dump the SystemMonitor history:" << f.errorString();
+        return false;
+    }
+    return dump(f.handle());
+}
+
+bool SystemMonitorHistory::dump(int fd) const
+{
+    if (fd < 0)
+        return false;
+
+    const quint32 header[] = { dumpVersion, MetricCount, quint32(m_tiers.size()) };
+    if (!writeAll(fd, "AMSH", 4) || !writeAll(fd, header, sizeof(header)))
+        return false;
+
+    for (const Tier &tier : m_tiers) {
+        const quint32 tierHeader[] = { quint32(tier.resolution), quint32(tier.count) };
+        if (!writeAll(fd, tierHeader, sizeof(tierHeader)))
+            return false;
+
+        // the ring buffer consists of at most two consecutive parts
+        int capacity = tier.buckets.size();
+        int first = (tier.next - tier.count + capacity) % capacity;
+        int firstSize = qMin(tier.count, capacity - first);
+        const Bucket *data = tier.buckets.constData();
+
+        if (!writeAll(fd, data + first, sizeof(Bucket) * size_t(firstSize))
+                || !writeAll(fd, data, sizeof(Bucket) * size_t(tier.count - firstSize))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SystemMonitorHistory::resetCurrent(Tier &tier, qint64 start)
+{
+    tier.currentStart = start;
+    tier.currentSamples = 0;
+    for (int m = 0; m < MetricCount; ++m) {
+        tier.sum[m] = 0;
+        tier.valid[m] = 0;
+        tier.minimum[m] = tier.maximum[m] = 0;
+    }
+}
+
+void SystemMonitorHistory::closeCurrent(Tier &tier)
+{
+    Bucket &b = tier.buckets[tier.next];
+    b.timestamp = tier.currentStart;
+    b.samples = tier.currentSamples;
+    for (int m = 0; m < MetricCount; ++m) {
+        bool valid = (tier.valid[m] > 0);
+        b.minimum[m] = valid ? tier.minimum[m] : float(qQNaN());
+        b.maximum[m] = valid ? tier.maximum[m] : float(qQNaN());
+        b.average[m] = valid ? float(tier.sum[m] / tier.valid[m]) : float(qQNaN());
+    }
+
+    tier.next = (tier.next + 1) % tier.buckets.size();
+    if (tier.count < tier.buckets.size())
+        ++tier.count;
+}
+
+const SystemMonitorHistory::Bucket &SystemMonitorHistory::bucketAt(const Tier &tier, int index)
+{
+    // index 0 is the oldest bucket
+    int capacity = tier.buckets.size();
+    return tier.buckets.at((tier.next - tier.count + index + capacity) % capacity);
+}
+
+QT_END_NAMESPACE_AM
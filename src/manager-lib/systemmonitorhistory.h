@@ -0,0 +1,109 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:LGPL-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+** SPDX-License-Identifier: LGPL-3.0
+**
+****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QVariantList>
+#include <QtAppManCommon/global.h>
+
+QT_BEGIN_NAMESPACE_AM
+
+// Keeps a down-sampled history of the SystemMonitor reports in multiple tiers of fixed size
+// (1 second resolution for 2 minutes, 10 seconds for 30 minutes and 1 minute for 24 hours).
+// Each bucket stores the minimum, maximum and average of every metric.
+class SystemMonitorHistory
+{
+public:
+    enum Metric {
+        CpuLoad,
+        MemoryUsed,
+        Fps,
+
+        MetricCount
+    };
+
+    SystemMonitorHistory();
+
+    // values that have not been measured are NaN
+    void addSample(qint64 timestamp, const qreal (&values)[MetricCount]);
+
+    QVector<int> resolutions() const;
+    QVariantList buckets(int resolution, qint64 since = 0) const;
+
+    bool dump(const QString &fileName) const;
+    // only uses async-signal-safe functions, so it can be called from a crash handler
+    bool dump(int fd) const;
+
+private:
+    struct Bucket
+    {
+        qint64 timestamp = 0; // msecs since epoch
+        quint32 samples = 0;
+        float minimum[MetricCount];
+        float maximum[MetricCount];
+        float average[MetricCount];
+    };
+
+    struct Tier
+    {
+        int resolution = 0; // msecs
+        int next = 0;
+        int count = 0;
+        QVector<Bucket> buckets;
+
+        // the bucket that is currently being filled
+        qint64 currentStart = -1;
+        quint32 currentSamples = 0;
+        double sum[MetricCount];
+        quint32 valid[MetricCount];
+        float minimum[MetricCount];
+        float maximum[MetricCount];
+    };
+
+    static void resetCurrent(Tier &tier, qint64 start);
+    static void closeCurrent(Tier &tier);
+    static const Bucket &bucketAt(const Tier &tier, int index);
+
+    QVector<Tier> m_tiers;
+};
+
+QT_END_NAMESPACE_AM
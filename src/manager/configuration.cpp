@@ -350,6 +350,13 @@ QString Configuration::appImageMountDir() const
     return d->config<QString>("app-image-mount-dir", { qSL("applications"), qSL("appImageMountDir") });
 }
 
+int Configuration::applicationShutDownTimeout() const
+{
+    bool found, conversionOk;
+    int timeout = d->findInConfigFile({ qSL("applications"), qSL("shutDownTimeout") }, &found).toInt(&conversionOk);
+    return (found && conversionOk && timeout >= 0) ? timeout : 3000;
+}
+
 bool Configuration::fullscreen() const
 {
     return d->config<bool>("fullscreen", { qSL("ui"), qSL("fullscreen") });
@@ -430,6 +437,15 @@ QVariantMap Configuration::containerConfigurations() const
     return d->findInConfigFile({ qSL("containers") }).toMap();
 }
 
+QVariantList Configuration::containerSelectionConfiguration() const
+{
+    // a single container id is a shortcut for: - '*': <id>
+    QVariant selection = d->findInConfigFile({ qSL("containers"), qSL("selection") });
+    if (selection.type() == QVariant::String)
+        return QVariantList { QVariantMap { { qSL("*"), selection } } };
+    return selection.toList();
+}
+
 QVariantMap Configuration::runtimeConfigurations() const
 {
     return d->findInConfigFile({ qSL("runtimes") }).toMap();
@@ -513,6 +529,26 @@ int Configuration::quickLaunchRuntimesPerContainer() const
     return (found && conversionOk && rpc >= 0 && rpc < 10) ? rpc : 0;
 }
 
+QVariantMap Configuration::restartConfiguration() const
+{
+    return d->findInConfigFile({ qSL("restart") }).toMap();
+}
+
+QVariantMap Configuration::foregroundBoost() const
+{
+    return d->findInConfigFile({ qSL("foregroundBoost") }).toMap();
+}
+
+QVariantMap Configuration::metricsExport() const
+{
+    return d->findInConfigFile({ qSL("metricsExport") }).toMap();
+}
+
+QString Configuration::systemMonitorDumpDirectory() const
+{
+    return d->findInConfigFile({ qSL("systemMonitor"), qSL("dumpDirectory") }).toString();
+}
+
 QString Configuration::waylandSocketName() const
 {
     return d->clp.value(qSL("wayland-socket-name"));
@@ -546,6 +582,13 @@ QStringList Configuration::caCertificates() const
     return variantToStringList(d->findInConfigFile({ qSL("installer"), qSL("caCertificates") }));
 }
 
+int Configuration::installerMaxConcurrentTasks() const
+{
+    bool found, conversionOk;
+    int maxTasks = d->findInConfigFile({ qSL("installer"), qSL("maxConcurrentTasks") }, &found).toInt(&conversionOk);
+    return (found && conversionOk && maxTasks > 0) ? maxTasks : 1;
+}
+
 QStringList Configuration::pluginFilePaths(const char *type) const
 {
     return variantToStringList(d->findInConfigFile({ qSL("plugins"), qL1S(type) }));
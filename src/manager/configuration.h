@@ -61,6 +61,7 @@ public:
     QStringList builtinAppsManifestDirs() const;
     QString installedAppsManifestDir() const;
     QString appImageMountDir() const;
+    int applicationShutDownTimeout() const;
 
     bool fullscreen() const;
     bool noFullscreen() const;
@@ -79,6 +80,7 @@ public:
     QVariantList installationLocations() const;
 
     QVariantMap containerConfigurations() const;
+    QVariantList containerSelectionConfiguration() const;
     QVariantMap runtimeConfigurations() const;
 
     QVariantMap dbusPolicy(const QString &interfaceName) const;
@@ -93,6 +95,11 @@ public:
     qreal quickLaunchIdleLoad() const;
     int quickLaunchRuntimesPerContainer() const;
 
+    QVariantMap restartConfiguration() const;
+    QVariantMap foregroundBoost() const;
+    QVariantMap metricsExport() const;
+    QString systemMonitorDumpDirectory() const;
+
     QString waylandSocketName() const;
 
     QString telnetAddress() const;
@@ -103,6 +110,7 @@ public:
     QVariantMap managerCrashAction() const;
 
     QStringList caCertificates() const;
+    int installerMaxConcurrentTasks() const;
 
     QStringList pluginFilePaths(const char *type) const;
 
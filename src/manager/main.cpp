@@ -61,6 +61,7 @@
 #include <QQmlApplicationEngine>
 #include <QUrl>
 #include <QLibrary>
+#include <QEventLoop>
 #include <QFunctionPointer>
 #include <QProcess>
 #include <private/qabstractanimation_p.h>
@@ -100,6 +101,8 @@
 #include "runtimefactory.h"
 #include "containerfactory.h"
 #include "quicklauncher.h"
+#include "foregroundbooster.h"
+#include "metricsexporter.h"
 #include "nativeruntime.h"
 #include "processcontainer.h"
 #include "plugincontainer.h"
@@ -124,6 +127,10 @@
 #include "systemmonitor.h"
 #include "applicationipcmanager.h"
 
+#if defined(QT_DBUS_LIB)
+#  include "systemmonitor_adaptor.h"
+#endif
+
 #include "../plugin-interfaces/startupinterface.h"
 
 #ifdef AM_TESTRUNNER
@@ -216,6 +223,11 @@ static void dbusInitialization()
             throw Exception(Error::DBus, "could not set DBus policy for ApplicationInstaller");
 #  endif
 
+        auto sm = SystemMonitor::instance();
+        registerDBusObject(new SystemMonitorAdaptor(sm), "io.qt.ApplicationManager", "/SystemMonitor");
+        if (!sm->setDBusPolicy(configuration->dbusPolicy(dbusInterfaceName(sm))))
+            throw Exception(Error::DBus, "could not set DBus policy for SystemMonitor");
+
 #  if !defined(AM_HEADLESS)
         try {
             auto nm = NotificationManager::instance();
@@ -612,7 +624,11 @@ int main(int argc, char *argv[])
         if (Q_UNLIKELY(!adb->isValid() && !configuration->recreateDatabase()))
             throw Exception(Error::System, "database file %1 is not a valid application database: %2").arg(adb->name(), adb->errorString());
 
-        if (!adb->isValid() || configuration->recreateDatabase()) {
+        bool outdated = adb->isOutdated();
+        if (outdated)
+            qCDebug(LogSystem) << "The application database" << adb->name() << "was written by a different version and will be recreated";
+
+        if (!adb->isValid() || outdated || configuration->recreateDatabase()) {
             QVector<const Application *> apps;
 
             if (!configuration->singleApp().isEmpty()) {
@@ -641,6 +657,8 @@ int main(int argc, char *argv[])
         if (configuration->noSecurity())
             am->setSecurityChecksEnabled(false);
         am->setAdditionalConfiguration(configuration->additionalUiConfiguration());
+        am->setRestartConfiguration(configuration->restartConfiguration());
+        am->setContainerSelectionConfiguration(configuration->containerSelectionConfiguration());
 
         startupTimer.checkpoint("after ApplicationManager instantiation");
 
@@ -649,6 +667,12 @@ int main(int argc, char *argv[])
         startupTimer.checkpoint("after NotificationManager instantiation");
 
         SystemMonitor *sysmon = SystemMonitor::createInstance();
+        QString historyDumpFile = configuration->managerCrashAction().value(qSL("dumpSystemMonitorHistory")).toString();
+        if (!historyDumpFile.isEmpty())
+            sysmon->setHistoryCrashDumpFile(historyDumpFile);
+        sysmon->setDumpDirectory(configuration->systemMonitorDumpDirectory());
+        QObject::connect(sysmon, &SystemMonitor::applicationMemorySampled, am, &ApplicationManager::updateMemoryUsage);
+        sysmon->setApplicationMemorySamplingEnabled(true);
 
         startupTimer.checkpoint("after SystemMonitor instantiation");
 
@@ -657,6 +681,13 @@ int main(int argc, char *argv[])
 
         startupTimer.checkpoint("after quick-launcher setup");
 
+        ForegroundBooster *fb = ForegroundBooster::instance();
+        fb->initialize(configuration->foregroundBoost());
+        if (fb->isEnabled())
+            QObject::connect(am, &ApplicationManager::applicationWasActivated, fb, &ForegroundBooster::activateApplication);
+
+        MetricsExporter::instance()->initialize(configuration->metricsExport());
+
 #if !defined(AM_DISABLE_INSTALLER)
         ApplicationInstaller *ai = ApplicationInstaller::createInstance(installationLocations,
                                                                         configuration->installedAppsManifestDir(),
@@ -682,6 +713,7 @@ int main(int argc, char *argv[])
             }
             ai->setCACertificates(caCertificateList);
         }
+        ai->setMaxConcurrentTasks(configuration->installerMaxConcurrentTasks());
 
         uint minUserId, maxUserId, commonGroupId;
         if (configuration->applicationUserIdSeparation(&minUserId, &maxUserId, &commonGroupId)) {
@@ -742,6 +774,10 @@ int main(int argc, char *argv[])
                          wm, &WindowManager::setupInProcessRuntime);
         QObject::connect(am, &ApplicationManager::applicationWasActivated,
                          wm, &WindowManager::raiseApplicationWindow);
+        if (fb->isEnabled()) {
+            QObject::connect(wm, &WindowManager::applicationWindowActivated,
+                             fb, &ForegroundBooster::activateApplication);
+        }
 #endif
 
         if (Q_UNLIKELY(configuration->loadDummyData())) {
@@ -863,8 +899,25 @@ int main(int argc, char *argv[])
         engine->rootContext()->setContextProperty("ssdp", &ssdp);
 #endif // QT_PSSDP_LIB
 
-        QObject::connect(qApp, &QCoreApplication::aboutToQuit,
-                         ApplicationManager::instance(), &ApplicationManager::killAll);
+        // give all applications a chance to quit gracefully, but within a global deadline
+        int shutDownTimeout = configuration->applicationShutDownTimeout();
+        QObject::connect(qApp, &QCoreApplication::aboutToQuit, [shutDownTimeout]() {
+            ApplicationManager *am = ApplicationManager::instance();
+            if (am->isShuttingDown()) {
+                // the System-UI already did a shutDown() - just get rid of any stragglers
+                am->killAll();
+                return;
+            }
+            QEventLoop loop;
+            bool finished = false;
+            QObject::connect(am, &ApplicationManager::shutDownFinished, &loop, [&loop, &finished]() {
+                finished = true;
+                loop.quit();
+            });
+            am->shutDown(shutDownTimeout);
+            if (!finished)
+                loop.exec();
+        });
 
 #ifdef AM_TESTRUNNER
         int res =  TestRunner::exec(engine);
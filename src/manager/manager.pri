@@ -51,6 +51,7 @@ SOURCES += \
 
 DBUS_ADAPTORS += \
     $$PWD/../dbus/io.qt.applicationinstaller.xml \
+    $$PWD/../dbus/io.qt.systemmonitor.xml \
 
 !headless:DBUS_ADAPTORS += \
     $$PWD/../dbus/io.qt.windowmanager.xml \
@@ -102,6 +102,11 @@ void Surface::connectWindowPropertyChanged(const std::function<void (const QStri
     QObject::connect(m_surface, &QWaylandSurface::windowPropertyChanged, cb);
 }
 
+void Surface::connectFrameCommitted(const std::function<void ()> &cb)
+{
+    QObject::connect(m_surface, &QWaylandSurface::redraw, cb);
+}
+
 WaylandCompositor::WaylandCompositor(QQuickWindow *window, const QString &waylandSocketName, WindowManager *manager)
 #if QT_VERSION >= QT_VERSION_CHECK(5,5,0)
     : QWaylandQuickCompositor(qPrintable(waylandSocketName), DefaultExtensions | SubSurfaceExtension)
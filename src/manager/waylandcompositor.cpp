@@ -114,6 +114,12 @@ void Surface::connectWindowPropertyChanged(const std::function<void (const QStri
         connect(m_ext, &QtWayland::ExtendedSurface::windowPropertyChanged, cb);
 }
 
+void Surface::connectFrameCommitted(const std::function<void ()> &cb)
+{
+    // emitted for every commit of the client that attached a new buffer
+    connect(this, &QWaylandSurface::redraw, cb);
+}
+
 QQuickItem *Surface::item() const
 {
     return m_item;
@@ -88,6 +88,7 @@ public:
 
     void connectPong(const std::function<void ()> &cb) override;
     void connectWindowPropertyChanged(const std::function<void (const QString &, const QVariant &)> &cb) override;
+    void connectFrameCommitted(const std::function<void ()> &cb) override;
 
 private:
     SurfaceQuickItem *m_item;
@@ -41,11 +41,16 @@
 
 #if defined(AM_MULTI_PROCESS)
 
+#include <QPointer>
+#include <QQuickWindow>
+#include <QScreen>
+
 #include "waylandwindow.h"
 #include "applicationmanager.h"
 #include "application.h"
 #include "global.h"
 #include "windowmanager.h"
+#include "systemmonitor.h"
 
 QT_BEGIN_NAMESPACE_AM
 
@@ -59,6 +64,20 @@ WaylandWindow::WaylandWindow(const Application *app, WindowSurface *surf)
         surf->connectPong([this]() { pongReceived(); });
         surf->connectWindowPropertyChanged([this](const QString &n, const QVariant &v) { emit windowPropertyChanged(n, v); });
 
+        // per-application FPS reporting: the surface might outlive this window
+        if (app) {
+            QPointer<WaylandWindow> that(this);
+            const QString appId = app->isAlias() ? app->nonAliased()->id() : app->id();
+            surf->connectFrameCommitted([that, appId]() {
+                if (!that)
+                    return;
+                QQuickItem *item = that->windowItem();
+                QQuickWindow *view = item ? item->window() : nullptr;
+                qreal refreshRate = (view && view->screen()) ? view->screen()->refreshRate() : 0;
+                SystemMonitor::instance()->reportFrameSwap(item, appId, refreshRate);
+            });
+        }
+
         m_pingTimer->setInterval(1000);
         m_pingTimer->setSingleShot(true);
         connect(m_pingTimer, &QTimer::timeout, this, &WaylandWindow::pingTimeout);
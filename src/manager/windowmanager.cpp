@@ -42,6 +42,7 @@
 #include <QGuiApplication>
 #include <QRegularExpression>
 #include <QQuickView>
+#include <QScreen>
 #include <QQuickItem>
 #include <QQuickItemGrabResult>
 #include <QQmlEngine>
@@ -67,6 +68,7 @@
 #include "dbus-policy.h"
 #include "qml-utilities.h"
 #include "systemmonitor.h"
+#include "trace.h"
 
 
 #define AM_AUTHENTICATE_DBUS(RETURN_TYPE) \
@@ -357,11 +359,15 @@ WindowManager::WindowManager(QQmlEngine *qmlEngine, const QString &waylandSocket
 
     connect(SystemMonitor::instance(), &SystemMonitor::fpsReportingEnabledChanged, this, [this]() {
         if (SystemMonitor::instance()->isFpsReportingEnabled()) {
-            foreach (const QQuickWindow *view, d->views)
+            foreach (const QQuickWindow *view, d->views) {
+                connect(view, &QQuickWindow::afterAnimating, this, &WindowManager::reportFrameStart);
                 connect(view, &QQuickWindow::frameSwapped, this, &WindowManager::reportFps);
+            }
         } else {
-            foreach (const QQuickWindow *view, d->views)
+            foreach (const QQuickWindow *view, d->views) {
+                disconnect(view, &QQuickWindow::afterAnimating, this, &WindowManager::reportFrameStart);
                 disconnect(view, &QQuickWindow::frameSwapped, this, &WindowManager::reportFps);
+            }
         }
     });
 }
@@ -550,8 +556,11 @@ void WindowManager::registerCompositorView(QQuickWindow *view)
 {
     d->views << view;
 
-    if (SystemMonitor::instance()->isFpsReportingEnabled())
+    if (SystemMonitor::instance()->isFpsReportingEnabled()) {
+        connect(view, &QQuickWindow::afterAnimating, this, &WindowManager::reportFrameStart);
         connect(view, &QQuickWindow::frameSwapped, this, &WindowManager::reportFps);
+    }
+    connect(view, &QQuickWindow::activeFocusItemChanged, this, &WindowManager::activeFocusItemChanged);
 
 #if defined(AM_MULTI_PROCESS)
     if (!ApplicationManager::instance()->isSingleProcess()) {
@@ -663,6 +672,8 @@ void WindowManager::setupWindow(Window *window)
     endInsertRows();
 
     emit windowReady(d->windows.count() - 1, window->windowItem());
+
+    ApplicationManager::instance()->applicationWindowMapped(window->application());
 }
 
 
@@ -678,12 +689,14 @@ void WindowManager::resize()
 void WindowManager::waylandSurfaceCreated(WindowSurface *surface)
 {
     qCDebug(LogWayland) << "waylandSurfaceCreate" << surface->surface() << "(PID:" << surface->processId() << ")" << surface->windowProperties();
+    AM_TRACE_INSTANT("wayland", "surfaceCreated", nullptr, surface->processId());
 }
 
 void WindowManager::waylandSurfaceMapped(WindowSurface *surface)
 {
     qCDebug(LogWayland) << "waylandSurfaceMapped" << surface->surface();
     Q_ASSERT(surface != 0);
+    AM_TRACE_SCOPE("wayland", "surfaceMapped", nullptr, surface->processId());
 
     qint64 processId = surface->processId();
     if (processId == 0)
@@ -723,6 +736,7 @@ void WindowManager::waylandSurfaceMapped(WindowSurface *surface)
 void WindowManager::waylandSurfaceUnmapped(WindowSurface *surface)
 {
     qCDebug(LogWayland) << "waylandSurfaceUnmapped" << surface->surface();
+    AM_TRACE_INSTANT("wayland", "surfaceUnmapped", nullptr, surface->processId());
 
     int index = d->findWindowByWaylandSurface(surface->surface());
     if (index == -1) {
@@ -747,6 +761,7 @@ void WindowManager::waylandSurfaceUnmapped(WindowSurface *surface)
 void WindowManager::waylandSurfaceDestroyed(WindowSurface *surface)
 {
     qCDebug(LogWayland) << "waylandSurfaceDestroyed" << surface;
+    AM_TRACE_INSTANT("wayland", "surfaceDestroyed");
     int index = d->findWindowByWaylandSurface(surface->surface());
     if (index == -1) {
         qCWarning(LogWayland) << "waylandSurfaceDestroyed: could not find an application window for surface" << surface;
@@ -834,9 +849,49 @@ QVariantMap WindowManager::windowProperties(QQuickItem *window) const
     \sa ApplicationManagerWindow::setWindowProperty()
 */
 
+/*! \internal
+    Emits applicationWindowActivated, whenever the System-UI moves the keyboard focus into the
+    window of an application. Only the focus reflects the System-UI's decision which application
+    is in the foreground: popups or background applications are mapping surfaces as well.
+*/
+void WindowManager::activeFocusItemChanged()
+{
+    QQuickWindow *view = qobject_cast<QQuickWindow *>(sender());
+    for (QQuickItem *item = view ? view->activeFocusItem() : nullptr; item; item = item->parentItem()) {
+        int index = d->findWindowBySurfaceItem(item);
+        if (index >= 0) {
+            if (const Application *app = d->windows.at(index)->application())
+                emit applicationWindowActivated(app->id());
+            return;
+        }
+    }
+}
+
 void WindowManager::reportFps()
 {
-    SystemMonitor::instance()->reportFrameSwap(nullptr);
+    QWindow *view = qobject_cast<QWindow *>(sender());
+    QScreen *screen = view ? view->screen() : nullptr;
+    qreal refreshRate = screen ? screen->refreshRate() : 0;
+
+    // the global FPS values are only tracking the primary screen, since mixing frames with
+    // different refresh rates would produce meaningless numbers
+    if (!screen || screen == QGuiApplication::primaryScreen())
+        SystemMonitor::instance()->reportFrameSwap(nullptr, QString(), refreshRate);
+    if (screen)
+        SystemMonitor::instance()->reportScreenFrameSwap(screen->name(), refreshRate);
+}
+
+// the system-ui windows are only redrawn on demand: the time up to the start of the next
+// frame is idle time and must not show up as a long frame in the statistics
+void WindowManager::reportFrameStart()
+{
+    QWindow *view = qobject_cast<QWindow *>(sender());
+    QScreen *screen = view ? view->screen() : nullptr;
+
+    if (!screen || screen == QGuiApplication::primaryScreen())
+        SystemMonitor::instance()->reportFrameStart(nullptr);
+    if (screen)
+        SystemMonitor::instance()->reportScreenFrameStart(screen->name());
 }
 
 bool WindowManager::setDBusPolicy(const QVariantMap &yamlFragment)
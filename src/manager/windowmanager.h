@@ -88,6 +88,7 @@ public:
 
     virtual void connectPong(const std::function<void ()> &cb) = 0;
     virtual void connectWindowPropertyChanged(const std::function<void (const QString &name, const QVariant &value)> &cb) = 0;
+    virtual void connectFrameCommitted(const std::function<void ()> &cb) = 0;
 
 protected:
     QWaylandSurface *m_surface;
@@ -134,6 +135,7 @@ public:
 signals:
     void countChanged();
     void raiseApplicationWindow(const QString &applicationId, const QString &applicationAliasId);
+    void applicationWindowActivated(const QString &applicationId);
 
     void windowReady(int index, QQuickItem *window);
     void windowClosing(int index, QQuickItem *window);
@@ -162,6 +164,8 @@ public slots:
 
 private slots:
     void reportFps();
+    void reportFrameStart();
+    void activeFocusItemChanged();
 
 #if defined(AM_MULTI_PROCESS)
 private slots:
@@ -100,6 +100,19 @@ void PackageCreator::setSourceDirectory(const QDir &sourceDir)
     d->m_sourcePath = sourceDir.absolutePath() + QLatin1Char('/');
 }
 
+/*! \internal
+  Turns the package into a delta package against the content of \a baseDir (the source directory
+  of the previous version): files that are unchanged in \a baseDir are only listed in the header
+  together with their SHA256 and are not stored in the archive. The package digest stays the same
+  as for the full package. The \a baseVersion is recorded in the header, so the installer can
+  reject the package early, if a different version is installed.
+*/
+void PackageCreator::setDeltaBaseDirectory(const QDir &baseDir, const QString &baseVersion)
+{
+    d->m_deltaBasePath = baseDir.absolutePath() + QLatin1Char('/');
+    d->m_deltaBaseVersion = baseVersion;
+}
+
 bool PackageCreator::create()
 {
     if (!wasCanceled())
@@ -113,6 +126,11 @@ QByteArray PackageCreator::createdDigest() const
     return d->m_digest;
 }
 
+QStringList PackageCreator::reusedFiles() const
+{
+    return d->m_reusedFiles;
+}
+
 bool PackageCreator::hasFailed() const
 {
     return d->m_failed || wasCanceled();
@@ -173,6 +191,21 @@ bool PackageCreatorPrivate::create()
             { qSL("diskSpaceUsed"), m_report.diskSpaceUsed() }
         };
 
+        QStringList allFiles = m_report.files();
+
+        // Delta packages list the unchanged files in the header, so the extractor can verify them
+        // before reusing the installed copies
+
+        QVariantMap reusedFiles;
+        if (!m_deltaBasePath.isEmpty()) {
+            reusedFiles = findReusedFiles(allFiles);
+            if (!reusedFiles.isEmpty()) {
+                headerData.insert(qSL("reusedFiles"), reusedFiles);
+                headerData.insert(qSL("deltaBaseVersion"), m_deltaBaseVersion);
+            }
+        }
+        m_reusedFiles = reusedFiles.keys();
+
         PackageUtilities::addImportantHeaderDataToDigest(headerData, digest);
 
         emit q->progress(0);
@@ -209,8 +242,6 @@ bool PackageCreatorPrivate::create()
 
         // Add all regular files
 
-        QStringList allFiles = m_report.files();
-
         // Calculate the total size first, so we can report progress later on
 
         qint64 allFilesSize = 0;
@@ -255,8 +286,11 @@ bool PackageCreatorPrivate::create()
             if (!entry)
                 throw Exception(Error::Archive, "[libarchive] could not create a new archive_entry object");
 
+            // reused files are empty placeholders, but their content still goes into the digest
+            bool reused = reusedFiles.contains(file);
+
             fixed_archive_entry_set_pathname(entry, file); // please note: this is a special function (see top of file)
-            archive_entry_set_size(entry, fi.size());
+            archive_entry_set_size(entry, reused ? 0 : fi.size());
             archive_entry_set_mode(entry, mode);
 
             bool headerOk = (archive_write_header(ar, entry) == ARCHIVE_OK);
@@ -281,7 +315,7 @@ bool PackageCreatorPrivate::create()
                         throw Exception(f, "could not read from file");
                     fileSize += bytesRead;
 
-                    if (archive_write_data(ar, buffer, bytesRead) == -1)
+                    if (!reused && (archive_write_data(ar, buffer, bytesRead) == -1))
                         throw ArchiveException(ar, "could not write to archive");
 
                     digest.addData(buffer, bytesRead);
@@ -357,6 +391,42 @@ bool PackageCreatorPrivate::create()
     return false;
 }
 
+QVariantMap PackageCreatorPrivate::findReusedFiles(const QStringList &files) throw(Exception)
+{
+    auto sha256 = [](const QString &filePath) -> QByteArray {
+        QFile f(filePath);
+        if (!f.open(QIODevice::ReadOnly))
+            throw Exception(f, "could not open for reading");
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        if (!hash.addData(&f))
+            throw Exception(f, "could not read from file");
+        return hash.result();
+    };
+
+    QVariantMap reusedFiles;
+
+    foreach (const QString &file, files) {
+        // the installer needs these two at the start of every package
+        if (file == qL1S("info.yaml") || file == qL1S("icon.png"))
+            continue;
+
+        QFileInfo fi(m_sourcePath + file);
+        QFileInfo baseFi(m_deltaBasePath + file);
+
+        if (!fi.isFile() || fi.isSymLink() || !baseFi.isFile() || baseFi.isSymLink() || (fi.size() != baseFi.size()))
+            continue;
+
+        // the eXecutable-bit is part of the package, so a file that only changed its mode is not reused
+        if (fi.permission(QFile::ExeOwner) != baseFi.permission(QFile::ExeOwner))
+            continue;
+
+        QByteArray hash = sha256(fi.absoluteFilePath());
+        if (hash == sha256(baseFi.absoluteFilePath()))
+            reusedFiles.insert(file, QLatin1String(hash.toHex()));
+    }
+    return reusedFiles;
+}
+
 bool PackageCreatorPrivate::addVirtualFile(struct archive *ar, const QString &file, const QByteArray &data)
 {
     bool result = false;
@@ -42,6 +42,7 @@
 #pragma once
 
 #include <QObject>
+#include <QStringList>
 
 #include <QtAppManCommon/error.h>
 
@@ -64,9 +65,12 @@ public:
     QDir sourceDirectory() const;
     void setSourceDirectory(const QDir &sourceDir);
 
+    void setDeltaBaseDirectory(const QDir &baseDir, const QString &baseVersion);
+
     bool create();
 
     QByteArray createdDigest() const;
+    QStringList reusedFiles() const;
 
     bool hasFailed() const;
     bool wasCanceled() const;
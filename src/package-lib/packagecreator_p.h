@@ -41,7 +41,10 @@
 
 #pragma once
 
+#include <QVariantMap>
+
 #include "packagecreator.h"
+#include <QtAppManCommon/exception.h>
 
 #include <archive.h>
 
@@ -56,6 +59,7 @@ public:
 
 private:
     bool addVirtualFile(struct archive *ar, const QString &filename, const QByteArray &data);
+    QVariantMap findReusedFiles(const QStringList &files) throw(Exception);
     void setError(Error errorCode, const QString &errorString);
 
 private:
@@ -63,12 +67,15 @@ private:
 
     QIODevice *m_output;
     QString m_sourcePath;
+    QString m_deltaBasePath;
+    QString m_deltaBaseVersion;
     bool m_failed = false;
     QAtomicInt m_canceled;
     Error m_errorCode = Error::None;
     QString m_errorString;
 
     QByteArray m_digest;
+    QStringList m_reusedFiles;
     const InstallationReport &m_report;
 
     friend class PackageCreator;
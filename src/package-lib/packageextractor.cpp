@@ -49,6 +49,7 @@
 #include <QUrl>
 #include <QDebug>
 #include <QCryptographicHash>
+#include <qplatformdefs.h>
 
 #include <archive.h>
 #include <archive_entry.h>
@@ -70,6 +71,13 @@
 #  define S_IEXEC S_IXUSR
 #endif
 
+#if defined(Q_OS_LINUX)
+#  include <sys/ioctl.h>
+#  ifndef FICLONE
+#    define FICLONE _IOW(0x94, 9, int)
+#  endif
+#endif
+
 QT_BEGIN_NAMESPACE_AM
 
 PackageExtractor::PackageExtractor(const QUrl &downloadUrl, const QDir &destinationDir, QObject *parent)
@@ -94,11 +102,36 @@ void PackageExtractor::setFileExtractedCallback(const std::function<void(const Q
     d->m_fileExtractedCallback = callback;
 }
 
+/*! \internal
+  Delta packages do not contain the files that are unchanged compared to the previous version:
+  these are reflinked (or copied) from \a reuseDir instead. Hardlinks are only used if
+  \a allowHardlinks is set, since they share the owner and permissions with the original.
+*/
+void PackageExtractor::setReuseDirectory(const QDir &reuseDir, bool allowHardlinks)
+{
+    d->m_reusePath = reuseDir.absolutePath() + qL1C('/');
+    d->m_reuseHardlinks = allowHardlinks;
+}
+
 const InstallationReport &PackageExtractor::installationReport() const
 {
     return d->m_report;
 }
 
+/*! \internal
+  Returns whether the package is a delta package. This and deltaBaseVersion() are only valid
+  after the package header has been extracted.
+*/
+bool PackageExtractor::isDeltaPackage() const
+{
+    return !d->m_reusedFiles.isEmpty();
+}
+
+QString PackageExtractor::deltaBaseVersion() const
+{
+    return d->m_deltaBaseVersion;
+}
+
 bool PackageExtractor::extract()
 {
     if (!wasCanceled()) {
@@ -329,6 +362,12 @@ void PackageExtractorPrivate::extract()
 
                     archive_read_data_skip(ar);
 
+                } else if (m_reusedFiles.contains(entryPath)) { // PackageEntry_File (delta)
+                    if (archive_entry_size(entry))
+                        throw Exception(Error::Package, "invalid archive entry '%1': reused files cannot have any content").arg(entryPath);
+
+                    reuseFile(entryPath, entryMode & S_IEXEC, digest);
+
                 } else { // PackageEntry_File
                     f.setFileName(m_destinationPath + entryPath);
                     if (!f.open(QFile::WriteOnly | QFile::Truncate))
@@ -469,6 +508,15 @@ void PackageExtractorPrivate::processMetaData(const QByteArray &metadata, QCrypt
             throw Exception(Error::Package, "metadata has an invalid diskSpaceUsed field (%1)").arg(diskSpaceUsed);
         m_report.setDiskSpaceUsed(diskSpaceUsed);
 
+        const QVariantMap reusedFiles = map.value(qSL("reusedFiles")).toMap();
+        for (auto it = reusedFiles.cbegin(); it != reusedFiles.cend(); ++it) {
+            QByteArray hash = QByteArray::fromHex(it.value().toString().toLatin1());
+            if (hash.size() != 32)
+                throw Exception(Error::Package, "metadata has an invalid reusedFiles entry for %1").arg(it.key());
+            m_reusedFiles.insert(it.key(), hash);
+        }
+        m_deltaBaseVersion = map.value(qSL("deltaBaseVersion")).toString();
+
         PackageUtilities::addImportantHeaderDataToDigest(map, digest);
 
     } else { // footer(s)
@@ -490,6 +538,87 @@ void PackageExtractorPrivate::processMetaData(const QByteArray &metadata, QCrypt
     }
 }
 
+static bool cloneFile(const QString &sourcePath, const QString &destinationPath)
+{
+#if defined(Q_OS_LINUX)
+    int src = QT_OPEN(QFile::encodeName(sourcePath).constData(), O_RDONLY);
+    if (src < 0)
+        return false;
+    int dst = QT_OPEN(QFile::encodeName(destinationPath).constData(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    bool cloned = (dst >= 0) && (::ioctl(dst, FICLONE, src) == 0);
+    if (dst >= 0) {
+        QT_CLOSE(dst);
+        if (!cloned)
+            QFile::remove(destinationPath);
+    }
+    QT_CLOSE(src);
+    return cloned;
+#else
+    Q_UNUSED(sourcePath)
+    Q_UNUSED(destinationPath)
+    return false;
+#endif
+}
+
+void PackageExtractorPrivate::reuseFile(const QString &entryPath, bool executable, QCryptographicHash &digest) throw(Exception)
+{
+    if (m_reusePath.isEmpty())
+        throw Exception(Error::Package, "the delta package does not contain %1 and there is no previous version to take it from").arg(entryPath);
+
+    // security check: the file we are taking over has to be inside the previous version
+    QFileInfo sourceFi(m_reusePath + entryPath);
+    QString sourcePath = sourceFi.canonicalFilePath();
+    QString reuseCanonicalPath = QDir(m_reusePath).canonicalPath() + qL1C('/');
+
+    if (!sourceFi.isFile() || sourceFi.isSymLink() || !sourcePath.startsWith(reuseCanonicalPath))
+        throw Exception(Error::Package, "the delta package does not contain %1 and the previous version does not have it either").arg(entryPath);
+
+    // reflinks are cheapest and safe, hardlinks are cheap, but share the inode (and the mode)
+    // with the original, so they are only an option if the eXecutable-bit does not change
+    QString destinationPath = m_destinationPath + entryPath;
+    bool hardlinked = false;
+
+    if (!cloneFile(sourcePath, destinationPath)) {
+#if defined(Q_OS_UNIX)
+        hardlinked = m_reuseHardlinks && (sourceFi.permission(QFile::ExeOwner) == executable)
+                && (::link(QFile::encodeName(sourcePath).constData(),
+                           QFile::encodeName(destinationPath).constData()) == 0);
+#endif
+        if (!hardlinked && !QFile::copy(sourcePath, destinationPath))
+            throw Exception(Error::IO, "could not copy %1 from the previous version").arg(sourcePath);
+    }
+
+    // the content has to be part of the package digest, just like for a full package
+    QFile f(destinationPath);
+    if (!f.open(QFile::ReadOnly))
+        throw Exception(f, "could not open for reading");
+
+    QCryptographicHash fileDigest(QCryptographicHash::Sha256);
+    char buffer[64 * 1024];
+
+    while (!f.atEnd()) {
+        if (q->wasCanceled())
+            throw Exception(Error::Canceled);
+
+        qint64 bytesRead = f.read(buffer, sizeof(buffer));
+        if (bytesRead < 0)
+            throw Exception(f, "could not read from file");
+
+        digest.addData(buffer, int(bytesRead));
+        fileDigest.addData(buffer, int(bytesRead));
+    }
+
+    if (fileDigest.result() != m_reusedFiles.value(entryPath))
+        throw Exception(Error::Package, "the file %1 of the previous version does not match the one the delta package was created for").arg(entryPath);
+
+    if (!hardlinked) {
+        QFile::Permissions permissions = f.permissions() & ~(QFile::ExeOwner | QFile::ExeUser | QFile::ExeGroup | QFile::ExeOther);
+        if (executable)
+            permissions |= QFile::ExeUser;
+        f.setPermissions(permissions);
+    }
+}
+
 void PackageExtractorPrivate::setError(Error errorCode, const QString &errorString)
 {
     m_failed = true;
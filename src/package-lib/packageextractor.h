@@ -68,10 +68,15 @@ public:
 
     void setFileExtractedCallback(const std::function<void(const QString &)> &callback);
 
+    void setReuseDirectory(const QDir &reuseDir, bool allowHardlinks = false);
+
     bool extract();
 
     const InstallationReport &installationReport() const;
 
+    bool isDeltaPackage() const;
+    QString deltaBaseVersion() const;
+
     bool hasFailed() const;
     bool wasCanceled() const;
 
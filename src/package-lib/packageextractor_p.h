@@ -76,6 +76,7 @@ private:
     void setError(Error errorCode, const QString &errorString);
     qint64 readTar(struct archive *ar, const void **archiveBuffer);
     void processMetaData(const QByteArray &metadata, QCryptographicHash &digest, bool isHeader) throw(Exception);
+    void reuseFile(const QString &entryPath, bool executable, QCryptographicHash &digest) throw(Exception);
 
 private:
     PackageExtractor *q;
@@ -83,6 +84,10 @@ private:
     QUrl m_url;
     QString m_destinationPath;
     std::function<void(const QString &)> m_fileExtractedCallback;
+    QString m_reusePath;
+    bool m_reuseHardlinks = false;
+    QMap<QString, QByteArray> m_reusedFiles; // delta packages only: path -> SHA256
+    QString m_deltaBaseVersion;
     bool m_failed = false;
     QAtomicInt m_canceled;
     Error m_errorCode = Error::None;
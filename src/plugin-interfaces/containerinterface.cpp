@@ -43,4 +43,31 @@
 
 ContainerInterface::~ContainerInterface() { }
 
+bool ContainerInterface::prepare()
+{
+    return true;
+}
+
+qint64 ContainerInterface::cpuTime() const
+{
+    return -1;
+}
+
+qint64 ContainerInterface::memoryUsage() const
+{
+    return -1;
+}
+
+bool ContainerInterface::ioCounters(quint64 *readBytes, quint64 *writtenBytes) const
+{
+    Q_UNUSED(readBytes)
+    Q_UNUSED(writtenBytes)
+    return false;
+}
+
 ContainerManagerInterface::~ContainerManagerInterface() { }
+
+bool ContainerManagerInterface::supportsPreparation() const
+{
+    return false;
+}
@@ -60,6 +60,11 @@ public:
 
     virtual bool isReady() = 0;
 
+    // Starts the (potentially expensive) container setup, before start() is called. The setup
+    // should be done asynchronously: emit ready() once it has finished or preparationFailed()
+    // if it cannot be completed. The default implementation does nothing and returns true.
+    virtual bool prepare();
+
     virtual QString mapContainerPathToHost(const QString &containerPath) const = 0;
     virtual QString mapHostPathToContainer(const QString &hostPath) const = 0;
 
@@ -74,8 +79,17 @@ public:
     virtual void kill() = 0;
     virtual void terminate() = 0;
 
+    // Optional resource accounting for the processes running in the container. This is needed
+    // if they cannot be monitored through /proc/<pid> on the host (e.g. because of a different
+    // pid namespace). The default implementations return -1 (resp. false), which makes the
+    // application-manager fall back to reading the host's procfs.
+    virtual qint64 cpuTime() const;      // user + system time in microseconds
+    virtual qint64 memoryUsage() const;  // bytes (PSS, RSS or cgroup memory usage)
+    virtual bool ioCounters(quint64 *readBytes, quint64 *writtenBytes) const;
+
 Q_SIGNALS:
     void ready();
+    void preparationFailed(const QString &errorString);
     void started();
     void errorOccured(QProcess::ProcessError processError);
     void finished(int exitCode, QProcess::ExitStatus exitStatus);
@@ -92,9 +106,19 @@ public:
     virtual void setConfiguration(const QVariantMap &configuration) = 0;
 
     virtual ContainerInterface *create() = 0;
+
+    // Return true, if containers created by this manager can be prepared before it is known
+    // which application will be started in them: the QuickLauncher will then keep a pool of
+    // prepared containers. The default implementation returns false.
+    virtual bool supportsPreparation() const;
 };
 
-#define AM_ContainerManagerInterface_iid "io.qt.ApplicationManager.ContainerManagerInterface"
+// The version has to be increased with every binary incompatible change to the interfaces above,
+// so that plugins built against an older version are rejected instead of calling the wrong
+// virtual functions.
+// 2: added prepare(), supportsPreparation(), preparationFailed() as well as the resource
+//    accounting via cpuTime(), memoryUsage() and ioCounters()
+#define AM_ContainerManagerInterface_iid "io.qt.ApplicationManager.ContainerManagerInterface/2"
 
 QT_BEGIN_NAMESPACE
 Q_DECLARE_INTERFACE(ContainerManagerInterface, AM_ContainerManagerInterface_iid)
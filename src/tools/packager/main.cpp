@@ -41,6 +41,7 @@ QT_USE_NAMESPACE_AM
 enum Command {
     NoCommand,
     CreatePackage,
+    CreateDeltaPackage,
     DevSignPackage,
     DevVerifyPackage,
     StoreSignPackage,
@@ -53,6 +54,7 @@ static struct {
     const char *description;
 } commandTable[] = {
     { CreatePackage,      "create-package",       "Create a new package." },
+    { CreateDeltaPackage, "create-delta-package", "Create a new package, that reuses unchanged files of the installed version." },
     { DevSignPackage,     "dev-sign-package",     "Add developer signature to package." },
     { DevVerifyPackage,   "dev-verify-package",   "Verify developer signature on package." },
     { StoreSignPackage,   "store-sign-package",   "Add store signature to package." },
@@ -118,6 +120,11 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
+    // signing and verifying a delta package needs the previous version to rebuild the digest
+    QCommandLineOption baseDirectoryOption(qSL("base-directory"),
+                                           qSL("The content root directory of the version a delta package updates."),
+                                           qSL("directory"));
+
     Packager *p = 0;
 
     switch (command(clp)) {
@@ -148,11 +155,26 @@ int main(int argc, char *argv[])
                              clp.positionalArguments().at(2));
         break;
 
+    case CreateDeltaPackage:
+        clp.addPositionalArgument(qSL("package"),          qSL("The file name of the created package."));
+        clp.addPositionalArgument(qSL("source-directory"), qSL("The package's content root directory."));
+        clp.addPositionalArgument(qSL("base-directory"),   qSL("The content root directory of the version this package updates."));
+        clp.process(a);
+
+        if (clp.positionalArguments().size() != 4)
+            clp.showHelp(1);
+
+        p = Packager::create(clp.positionalArguments().at(1),
+                             clp.positionalArguments().at(2),
+                             clp.positionalArguments().at(3));
+        break;
+
     case DevSignPackage:
         clp.addPositionalArgument(qSL("package"),        qSL("File name of the unsigned package (input)."));
         clp.addPositionalArgument(qSL("signed-package"), qSL("File name of the signed package (output)."));
         clp.addPositionalArgument(qSL("certificate"),    qSL("PKCS#12 certificate file."));
         clp.addPositionalArgument(qSL("password"),       qSL("Password for the PKCS#12 certificate."));
+        clp.addOption(baseDirectoryOption);
         clp.process(a);
 
         if (clp.positionalArguments().size() != 5)
@@ -161,19 +183,22 @@ int main(int argc, char *argv[])
         p = Packager::developerSign(clp.positionalArguments().at(1),
                                     clp.positionalArguments().at(2),
                                     clp.positionalArguments().at(3),
-                                    clp.positionalArguments().at(4));
+                                    clp.positionalArguments().at(4),
+                                    clp.value(baseDirectoryOption));
         break;
 
     case DevVerifyPackage:
         clp.addPositionalArgument(qSL("package"),      qSL("File name of the signed package (input)."));
         clp.addPositionalArgument(qSL("certificates"), qSL("The developer's CA certificate file(s)."), qSL("certificates..."));
+        clp.addOption(baseDirectoryOption);
         clp.process(a);
 
         if (clp.positionalArguments().size() < 3)
             clp.showHelp(1);
 
         p = Packager::developerVerify(clp.positionalArguments().at(1),
-                                      clp.positionalArguments().mid(2));
+                                      clp.positionalArguments().mid(2),
+                                      clp.value(baseDirectoryOption));
         break;
 
     case StoreSignPackage:
@@ -182,6 +207,7 @@ int main(int argc, char *argv[])
         clp.addPositionalArgument(qSL("certificate"),    qSL("PKCS#12 certificate file."));
         clp.addPositionalArgument(qSL("password"),       qSL("Password for the PKCS#12 certificate."));
         clp.addPositionalArgument(qSL("hardware-id"),    qSL("Unique hardware id to which this package gets bound."));
+        clp.addOption(baseDirectoryOption);
         clp.process(a);
 
         if (clp.positionalArguments().size() != 6)
@@ -191,13 +217,15 @@ int main(int argc, char *argv[])
                                 clp.positionalArguments().at(2),
                                 clp.positionalArguments().at(3),
                                 clp.positionalArguments().at(4),
-                                clp.positionalArguments().at(5));
+                                clp.positionalArguments().at(5),
+                                clp.value(baseDirectoryOption));
         break;
 
     case StoreVerifyPackage:
         clp.addPositionalArgument(qSL("package"),      qSL("File name of the signed package (input)."));
         clp.addPositionalArgument(qSL("certificates"), qSL("Store CA certificate file(s)."), qSL("certificates..."));
         clp.addPositionalArgument(qSL("hardware-id"),  qSL("Unique hardware id to which this package was bound."));
+        clp.addOption(baseDirectoryOption);
         clp.process(a);
 
         if (clp.positionalArguments().size() < 4)
@@ -205,7 +233,8 @@ int main(int argc, char *argv[])
 
         p = Packager::storeVerify(clp.positionalArguments().at(1),
                                   clp.positionalArguments().mid(2, clp.positionalArguments().size() - 2),
-                                  *--clp.positionalArguments().cend());
+                                  *--clp.positionalArguments().cend(),
+                                  clp.value(baseDirectoryOption));
         break;
     }
 
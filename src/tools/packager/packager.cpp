@@ -32,6 +32,7 @@
 #include <QRegExp>
 #include <QDirIterator>
 #include <QMessageAuthenticationCode>
+#include <QScopedPointer>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -55,16 +56,17 @@ QT_USE_NAMESPACE_AM
 static const int Ext2BlockSize = 1024;
 
 
-Packager *Packager::create(const QString &destinationName, const QString &sourceDir)
+Packager *Packager::create(const QString &destinationName, const QString &sourceDir, const QString &deltaBaseDir)
 {
     Packager *p = new Packager();
     p->m_mode = Create;
     p->m_destinationName = destinationName;
     p->m_sourceDir = sourceDir;
+    p->m_deltaBaseDir = deltaBaseDir;
     return p;
 }
 
-Packager *Packager::developerSign(const QString &sourceName, const QString &destinationName, const QString &certificateFile, const QString &passPhrase)
+Packager *Packager::developerSign(const QString &sourceName, const QString &destinationName, const QString &certificateFile, const QString &passPhrase, const QString &deltaBaseDir)
 {
     Packager *p = new Packager();
     p->m_mode = DeveloperSign;
@@ -72,19 +74,21 @@ Packager *Packager::developerSign(const QString &sourceName, const QString &dest
     p->m_destinationName = destinationName;
     p->m_passphrase = passPhrase;
     p->m_certificateFiles = QStringList { certificateFile };
+    p->m_deltaBaseDir = deltaBaseDir;
     return p;
 }
 
-Packager *Packager::developerVerify(const QString &sourceName, const QStringList &certificateFiles)
+Packager *Packager::developerVerify(const QString &sourceName, const QStringList &certificateFiles, const QString &deltaBaseDir)
 {
     Packager *p = new Packager();
     p->m_mode = DeveloperVerify;
     p->m_sourceName = sourceName;
     p->m_certificateFiles = certificateFiles;
+    p->m_deltaBaseDir = deltaBaseDir;
     return p;
 }
 
-Packager *Packager::storeSign(const QString &sourceName, const QString &destinationName, const QString &certificateFile, const QString &passPhrase, const QString &hardwareId)
+Packager *Packager::storeSign(const QString &sourceName, const QString &destinationName, const QString &certificateFile, const QString &passPhrase, const QString &hardwareId, const QString &deltaBaseDir)
 {
     Packager *p = new Packager();
     p->m_mode = StoreSign;
@@ -93,16 +97,18 @@ Packager *Packager::storeSign(const QString &sourceName, const QString &destinat
     p->m_passphrase = passPhrase;
     p->m_certificateFiles = QStringList { certificateFile };
     p->m_hardwareId = hardwareId;
+    p->m_deltaBaseDir = deltaBaseDir;
     return p;
 }
 
-Packager *Packager::storeVerify(const QString &sourceName, const QStringList &certificateFiles, const QString &hardwareId)
+Packager *Packager::storeVerify(const QString &sourceName, const QStringList &certificateFiles, const QString &hardwareId, const QString &deltaBaseDir)
 {
     Packager *p = new Packager();
     p->m_mode = StoreVerify;
     p->m_sourceName = sourceName;
     p->m_certificateFiles = certificateFiles;
     p->m_hardwareId = hardwareId;
+    p->m_deltaBaseDir = deltaBaseDir;
     return p;
 }
 
@@ -196,10 +202,26 @@ void Packager::execute() throw(Exception)
 
         // finally create the package
         PackageCreator creator(source, &destination, report);
+
+        if (!m_deltaBaseDir.isEmpty()) {
+            QDir deltaBase(m_deltaBaseDir);
+            if (!deltaBase.exists())
+                throw Exception(Error::Package, "base %1 is not a directory").arg(m_deltaBaseDir);
+
+            // the installer rejects the package early, if a different version is installed
+            QScopedPointer<Application> baseApp(yas.scan(deltaBase.absoluteFilePath(infoName)));
+            if (baseApp->id() != app->id())
+                throw Exception(Error::Package, "base %1 contains %2 instead of %3").arg(m_deltaBaseDir, baseApp->id(), app->id());
+            creator.setDeltaBaseDirectory(deltaBase, baseApp->version());
+        }
+
         if (!creator.create())
             throw Exception(Error::Package, "could not create package %1: %2").arg(app->id()).arg(creator.errorString());
 
         m_digest = creator.createdDigest();
+
+        if (!m_deltaBaseDir.isEmpty())
+            m_output = qSL("reusing %1 unchanged files").arg(creator.reusedFiles().size());
         break;
     }
     case DeveloperSign:
@@ -225,6 +247,15 @@ void Packager::execute() throw(Exception)
 
         // extract source
         PackageExtractor extractor(QUrl::fromLocalFile(m_sourceName), tmp.path());
+
+        // delta packages need the previous version for the unchanged files (and the digest)
+        QDir deltaBase(m_deltaBaseDir);
+        if (!m_deltaBaseDir.isEmpty()) {
+            if (!deltaBase.exists())
+                throw Exception(Error::Package, "base %1 is not a directory").arg(m_deltaBaseDir);
+            extractor.setReuseDirectory(deltaBase);
+        }
+
         if (!extractor.extract())
             throw Exception(Error::Package, "could not extract package %1: %2").arg(m_sourceName).arg(extractor.errorString());
 
@@ -274,6 +305,10 @@ void Packager::execute() throw(Exception)
 
         PackageCreator creator(tmp.path(), &destination, report);
 
+        // a signed delta package is still a delta package against the same version
+        if (extractor.isDeltaPackage())
+            creator.setDeltaBaseDirectory(deltaBase, extractor.deltaBaseVersion());
+
         if (certificates.size() != 1)
             throw Exception(Error::Package, "cannot sign packages with more than one certificate");
 
@@ -298,6 +333,9 @@ void Packager::execute() throw(Exception)
             throw Exception(Error::Package, "could not create package %1: %2").arg(m_destinationName).arg(creator.errorString());
 
         m_digest = creator.createdDigest();
+
+        if (extractor.isDeltaPackage())
+            m_output = qSL("reusing %1 unchanged files").arg(creator.reusedFiles().size());
         break;
     }
     default:
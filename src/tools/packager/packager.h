@@ -36,17 +36,20 @@
 class Packager
 {
 public:
-    static Packager *create(const QString &destinationName, const QString &sourceDir);
+    static Packager *create(const QString &destinationName, const QString &sourceDir,
+                            const QString &deltaBaseDir = QString());
 
     static Packager *developerSign(const QString &sourceName, const QString &destinationName,
-                                   const QString &certificateFile, const QString &passPhrase);
-    static Packager *developerVerify(const QString &sourceName, const QStringList &certificateFiles);
+                                   const QString &certificateFile, const QString &passPhrase,
+                                   const QString &deltaBaseDir = QString());
+    static Packager *developerVerify(const QString &sourceName, const QStringList &certificateFiles,
+                                     const QString &deltaBaseDir = QString());
 
     static Packager *storeSign(const QString &sourceName, const QString &destinationName,
                                const QString &certificateFile, const QString &passPhrase,
-                               const QString &hardwareId);
+                               const QString &hardwareId, const QString &deltaBaseDir = QString());
     static Packager *storeVerify(const QString &sourceName, const QStringList &certificateFiles,
-                                 const QString &hardwareId);
+                                 const QString &hardwareId, const QString &deltaBaseDir = QString());
 
     void execute() throw (QT_PREPEND_NAMESPACE_AM(Exception));
 
@@ -74,6 +77,7 @@ private:
     QString m_sourceName;
     QString m_destinationName; // create and signing only
     QString m_sourceDir; // create only
+    QString m_deltaBaseDir; // delta packages only
     QStringList m_certificateFiles;
     QString m_passphrase;  // sign only
     QString m_hardwareId; // store sign/verify only
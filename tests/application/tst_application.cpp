@@ -112,6 +112,8 @@ void tst_Application::database()
         try {
             QVector<const Application *> appsInDb = adb.read();
             QCOMPARE(appsInDb.size(), apps.size());
+            for (const Application *app : qAsConst(appsInDb))
+                QVERIFY(app->restartPolicy() == Application::RestartOnFailure);
         } catch (Exception &e) {
             QVERIFY2(false, e.what());
         }
@@ -183,6 +185,7 @@ void tst_Application::application()
     QCOMPARE(app->isPreloaded(), true);
     QCOMPARE(app->importance(), 0.5);
     QVERIFY(app->backgroundMode() == Application::TracksLocation);
+    QVERIFY(app->restartPolicy() == Application::RestartOnFailure);
     QCOMPARE(app->supportedMimeTypes().size(), 2);
     QCOMPARE(app->supportedMimeTypes().first(), qSL("text/plain"));
     QCOMPARE(app->supportedMimeTypes().last(), qSL("x-scheme-handler/mailto"));
@@ -104,6 +104,11 @@ private slots:
     void cancelPackageInstallation_data();
     void cancelPackageInstallation();
 
+    void concurrentInstallations();
+    void concurrentInstallationAndRemoval();
+    void concurrentDistinctInstallations();
+    void concurrentDiskSpaceReservation();
+
 public:
     enum PathLocation {
         TemporaryMount = 0,
@@ -405,6 +410,9 @@ void tst_ApplicationInstaller::cleanup()
     m_ai->cleanupBrokenInstallations();
     clearSignalSpies();
     recursiveOperation(pathTo(Internal0), SafeRemove());
+
+    // a failed check in a concurrency test would leak this into the following tests
+    m_ai->setMaxConcurrentTasks(1);
 }
 
 void tst_ApplicationInstaller::installationLocations()
@@ -913,6 +921,163 @@ void tst_ApplicationInstaller::cancelPackageInstallation()
     }
 }
 
+void tst_ApplicationInstaller::concurrentInstallations()
+{
+    m_ai->setMaxConcurrentTasks(2);
+
+    // both tasks are running at the same time, but only one of them can claim the application:
+    // the other one waits until the first one is done
+    QString taskId1 = m_ai->startPackageInstallation("internal-0", QUrl::fromLocalFile(AM_TESTDATA_DIR "packages/test-dev-signed.appkg"));
+    QString taskId2 = m_ai->startPackageInstallation("internal-0", QUrl::fromLocalFile(AM_TESTDATA_DIR "packages/test-dev-signed.appkg"));
+    QVERIFY(!taskId1.isEmpty());
+    QVERIFY(!taskId2.isEmpty());
+
+    QTRY_COMPARE(m_startedSpy->count(), 2);
+    QTRY_COMPARE(m_blockingUntilInstallationAcknowledgeSpy->count(), 1);
+    QCOMPARE(m_failedSpy->count(), 0);
+
+    QString firstTaskId = m_blockingUntilInstallationAcknowledgeSpy->first()[0].toString();
+    QString secondTaskId = (firstTaskId == taskId1) ? taskId2 : taskId1;
+    QVERIFY(QStringList({ taskId1, taskId2 }).contains(firstTaskId));
+
+    m_ai->acknowledgePackageInstallation(firstTaskId);
+    QTRY_COMPARE(m_finishedSpy->count(), 1);
+    QCOMPARE(m_finishedSpy->first()[0].toString(), firstTaskId);
+
+    // the second task updates the application that the first one has installed
+    QTRY_COMPARE(m_blockingUntilInstallationAcknowledgeSpy->count(), 2);
+    QCOMPARE(m_blockingUntilInstallationAcknowledgeSpy->at(1)[0].toString(), secondTaskId);
+    m_ai->acknowledgePackageInstallation(secondTaskId);
+    QTRY_COMPARE(m_finishedSpy->count(), 2);
+    QCOMPARE(m_finishedSpy->at(1)[0].toString(), secondTaskId);
+    QCOMPARE(m_failedSpy->count(), 0);
+
+    clearSignalSpies();
+    QString taskId = m_ai->removePackage("com.pelagicore.test", false);
+    QVERIFY(!taskId.isEmpty());
+    QVERIFY(m_finishedSpy->wait());
+    QCOMPARE(m_finishedSpy->first()[0].toString(), taskId);
+}
+
+void tst_ApplicationInstaller::concurrentInstallationAndRemoval()
+{
+    QString taskId = m_ai->startPackageInstallation("internal-0", QUrl::fromLocalFile(AM_TESTDATA_DIR "packages/test-dev-signed.appkg"));
+    QVERIFY(!taskId.isEmpty());
+    m_ai->acknowledgePackageInstallation(taskId);
+    QVERIFY(m_finishedSpy->wait());
+    QCOMPARE(m_finishedSpy->first()[0].toString(), taskId);
+    clearSignalSpies();
+
+    m_ai->setMaxConcurrentTasks(2);
+
+    // an update and a removal of the same application: the removal claims the application when
+    // it is dequeued, so the update has to wait for it instead of failing (or the other way round)
+    QString installTaskId = m_ai->startPackageInstallation("internal-0", QUrl::fromLocalFile(AM_TESTDATA_DIR "packages/test-dev-signed.appkg"));
+    QString removeTaskId = m_ai->removePackage("com.pelagicore.test", false);
+    QVERIFY(!installTaskId.isEmpty());
+    QVERIFY(!removeTaskId.isEmpty());
+
+    m_ai->acknowledgePackageInstallation(installTaskId);
+    QTRY_COMPARE(m_finishedSpy->count(), 2);
+    QCOMPARE(m_failedSpy->count(), 0);
+
+    bool removedFirst = (m_finishedSpy->first()[0].toString() == removeTaskId);
+    QCOMPARE(m_finishedSpy->at(removedFirst ? 1 : 0)[0].toString(), installTaskId);
+    QCOMPARE(QFile::exists(pathTo(Internal0, "com.pelagicore.test/test")), removedFirst);
+
+    if (removedFirst) {
+        clearSignalSpies();
+        taskId = m_ai->removePackage("com.pelagicore.test", false);
+        QVERIFY(!taskId.isEmpty());
+        QVERIFY(m_finishedSpy->wait());
+        QCOMPARE(m_finishedSpy->first()[0].toString(), taskId);
+    }
+}
+
+void tst_ApplicationInstaller::concurrentDistinctInstallations()
+{
+    m_ai->setMaxConcurrentTasks(2);
+
+    // two different applications do not conflict: both tasks can finish
+    QString taskId1 = m_ai->startPackageInstallation("internal-0", QUrl::fromLocalFile(AM_TESTDATA_DIR "packages/test-dev-signed.appkg"));
+    QString taskId2 = m_ai->startPackageInstallation("internal-0", QUrl::fromLocalFile(AM_TESTDATA_DIR "packages/bigtest-dev-signed.appkg"));
+    QVERIFY(!taskId1.isEmpty());
+    QVERIFY(!taskId2.isEmpty());
+
+    // both tasks have to be running at the same time to get here
+    QTRY_COMPARE(m_blockingUntilInstallationAcknowledgeSpy->count(), 2);
+    QCOMPARE(m_failedSpy->count(), 0);
+
+    m_ai->acknowledgePackageInstallation(taskId1);
+    m_ai->acknowledgePackageInstallation(taskId2);
+    QTRY_COMPARE(m_finishedSpy->count(), 2);
+    QCOMPARE(m_failedSpy->count(), 0);
+
+    QVERIFY(QFile::exists(pathTo(Internal0, "com.pelagicore.test/test")));
+    QVERIFY(QFile::exists(pathTo(Internal0, "com.pelagicore.test.bigtest/bigtest")));
+
+    clearSignalSpies();
+    QVERIFY(!m_ai->removePackage("com.pelagicore.test", false).isEmpty());
+    QVERIFY(!m_ai->removePackage("com.pelagicore.test.bigtest", false).isEmpty());
+    QTRY_COMPARE(m_finishedSpy->count(), 2);
+    QCOMPARE(m_failedSpy->count(), 0);
+}
+
+void tst_ApplicationInstaller::concurrentDiskSpaceReservation()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("no removable installation locations on this platform");
+#else
+    AllowUnsignedInstallation allow(true);
+    m_ai->setMaxConcurrentTasks(2);
+
+    // each package fits onto the SD-card on its own, but the second task must not be able to
+    // use the space that the first one has already reserved
+    QString taskId1 = m_ai->startPackageInstallation("removable-0", QUrl::fromLocalFile(AM_TESTDATA_DIR "packages/mediumtest1.appkg"));
+    QString taskId2 = m_ai->startPackageInstallation("removable-0", QUrl::fromLocalFile(AM_TESTDATA_DIR "packages/mediumtest2.appkg"));
+    QVERIFY(!taskId1.isEmpty());
+    QVERIFY(!taskId2.isEmpty());
+
+    QTRY_COMPARE(m_blockingUntilInstallationAcknowledgeSpy->count(), 1);
+    QTRY_COMPARE(m_failedSpy->count(), 1);
+
+    QString blockedTaskId = m_blockingUntilInstallationAcknowledgeSpy->first()[0].toString();
+    QString failedTaskId = m_failedSpy->first()[0].toString();
+    QVERIFY(QStringList({ blockedTaskId, failedTaskId }).contains(taskId1));
+    QVERIFY(QStringList({ blockedTaskId, failedTaskId }).contains(taskId2));
+    QCOMPARE(m_failedSpy->first()[1].toInt(), int(Error::StorageSpace));
+    QString errorString = "~not enough storage space left on removable-0: [0-9.]+ MB available, but [0-9.]+ MB needed";
+    AM_CHECK_ERRORSTRING(m_failedSpy->first()[2].toString(), errorString);
+
+    m_ai->acknowledgePackageInstallation(blockedTaskId);
+    QVERIFY(m_finishedSpy->wait());
+    QCOMPARE(m_finishedSpy->first()[0].toString(), blockedTaskId);
+
+    // neither task may leak its reservation: once the installed package is removed again, the
+    // other one fits as well
+    bool firstInstalled = (blockedTaskId == taskId1);
+    clearSignalSpies();
+    QString taskId = m_ai->removePackage(firstInstalled ? "com.pelagicore.test.medium1" : "com.pelagicore.test.medium2", false);
+    QVERIFY(!taskId.isEmpty());
+    QVERIFY(m_finishedSpy->wait());
+    QCOMPARE(m_finishedSpy->first()[0].toString(), taskId);
+
+    clearSignalSpies();
+    taskId = m_ai->startPackageInstallation("removable-0", QUrl::fromLocalFile(firstInstalled ? AM_TESTDATA_DIR "packages/mediumtest2.appkg"
+                                                                                              : AM_TESTDATA_DIR "packages/mediumtest1.appkg"));
+    QVERIFY(!taskId.isEmpty());
+    m_ai->acknowledgePackageInstallation(taskId);
+    QVERIFY(m_finishedSpy->wait());
+    QCOMPARE(m_finishedSpy->first()[0].toString(), taskId);
+
+    clearSignalSpies();
+    taskId = m_ai->removePackage(firstInstalled ? "com.pelagicore.test.medium2" : "com.pelagicore.test.medium1", false);
+    QVERIFY(!taskId.isEmpty());
+    QVERIFY(m_finishedSpy->wait());
+    QCOMPARE(m_finishedSpy->first()[0].toString(), taskId);
+#endif
+}
+
 
 static tst_ApplicationInstaller *tstApplicationInstaller = 0;
 
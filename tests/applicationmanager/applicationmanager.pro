@@ -0,0 +1,11 @@
+TARGET = tst_applicationmanager
+
+include($$PWD/../tests.pri)
+
+QT *= qml
+QT *= \
+    appman_common-private \
+    appman_application-private \
+    appman_manager-private \
+
+SOURCES += tst_applicationmanager.cpp
@@ -0,0 +1,402 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QtTest>
+#include <QTemporaryFile>
+#include <QPointer>
+
+#include <csignal>
+
+#include "application.h"
+#include "applicationdatabase.h"
+#include "applicationmanager.h"
+#include "yamlapplicationscanner.h"
+#include "abstractruntime.h"
+#include "runtimefactory.h"
+#include "foregroundbooster.h"
+
+QT_USE_NAMESPACE_AM
+
+class TestRuntime : public AbstractRuntime
+{
+    Q_OBJECT
+
+public:
+    explicit TestRuntime(AbstractContainer *container, const Application *app, AbstractRuntimeManager *manager)
+        : AbstractRuntime(container, app, manager)
+    { }
+
+    State state() const override
+    {
+        return m_running ? Active : Inactive;
+    }
+
+    qint64 applicationProcessId() const override
+    {
+        return m_running ? 1 : 0;
+    }
+
+    void setIgnoreTerminate(bool ignore)
+    {
+        m_ignoreTerminate = ignore;
+    }
+
+public slots:
+    bool start() override
+    {
+        m_running = true;
+        emit stateChanged(state());
+        return true;
+    }
+
+    void stop(bool forceKill) override
+    {
+        exit(forceKill ? SIGKILL : 0, forceKill ? QProcess::CrashExit : QProcess::NormalExit);
+    }
+
+    void terminate() override
+    {
+        if (!m_ignoreTerminate)
+            exit(0, QProcess::NormalExit);
+    }
+
+    void kill() override
+    {
+        exit(SIGKILL, QProcess::CrashExit);
+    }
+
+    void exit(int exitCode, QProcess::ExitStatus status)
+    {
+        if (!m_running)
+            return;
+        m_running = false;
+        emit finished(exitCode, status);
+        emit stateChanged(state());
+        deleteLater();
+    }
+
+private:
+    bool m_running = false;
+    bool m_ignoreTerminate = false;
+};
+
+class TestRuntimeManager : public AbstractRuntimeManager
+{
+    Q_OBJECT
+
+public:
+    TestRuntimeManager(const QString &id, QObject *parent)
+        : AbstractRuntimeManager(id, parent)
+    { }
+
+    static QString defaultIdentifier() { return qSL("test"); }
+
+    bool inProcess() const override
+    {
+        return m_inProcess;
+    }
+
+    // the ForegroundBooster ignores in-process runtimes
+    void setInProcess(bool inProcess)
+    {
+        m_inProcess = inProcess;
+    }
+
+    TestRuntime *create(AbstractContainer *container, const Application *app) override
+    {
+        return new TestRuntime(container, app, this);
+    }
+
+private:
+    bool m_inProcess = true;
+};
+
+
+class tst_ApplicationManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void databaseFormat();
+    void restart();
+    void containerSelection();
+    void foregroundBoost();
+    void shutDown();
+
+private:
+    static Application *createApplication(const QString &id);
+    static TestRuntime *runtime(const QString &id);
+
+    ApplicationDatabase *m_adb = nullptr;
+    ApplicationManager *m_am = nullptr;
+};
+
+Application *tst_ApplicationManager::createApplication(const QString &id)
+{
+    QByteArray yaml =
+            "formatVersion: 1\n"
+            "formatType: am-application\n"
+            "---\n"
+            "id: " + id.toLatin1() + "\n"
+            "name: { en_US: 'Test' }\n"
+            "icon: icon.png\n"
+            "code: test.foo\n"
+            "runtime: test\n";
+
+    QTemporaryFile temp;
+    if (!temp.open() || (temp.write(yaml) != yaml.size()))
+        return nullptr;
+    temp.close();
+
+    try {
+        return YamlApplicationScanner().scan(temp.fileName());
+    } catch (const Exception &) {
+        return nullptr;
+    }
+}
+
+TestRuntime *tst_ApplicationManager::runtime(const QString &id)
+{
+    const Application *app = ApplicationManager::instance()->fromId(id);
+    return app ? qobject_cast<TestRuntime *>(app->currentRuntime()) : nullptr;
+}
+
+void tst_ApplicationManager::initTestCase()
+{
+    QVERIFY(RuntimeFactory::instance()->registerRuntime(new TestRuntimeManager(qSL("test"), qApp)));
+
+    QVector<const Application *> apps;
+    for (const char *id : { "com.pelagicore.test1", "com.pelagicore.test2" }) {
+        Application *app = createApplication(qL1S(id));
+        QVERIFY(app);
+        apps << app;
+    }
+
+    m_adb = new ApplicationDatabase();
+    QVERIFY(m_adb->isValid());
+    m_adb->write(apps);
+    qDeleteAll(apps);
+
+    QString errorString;
+    m_am = ApplicationManager::createInstance(m_adb, true, &errorString);
+    QVERIFY2(m_am, qPrintable(errorString));
+    QCOMPARE(m_am->count(), 2);
+}
+
+void tst_ApplicationManager::cleanupTestCase()
+{
+    delete m_am;
+    delete m_adb;
+}
+
+void tst_ApplicationManager::databaseFormat()
+{
+    QTemporaryFile dbFile;
+    QVERIFY(dbFile.open());
+
+    // a database without a format header, as written by older versions
+    {
+        QDataStream ds(&dbFile);
+        ds << qSL("com.pelagicore.test1") << qSL("test.foo") << qSL("test");
+        dbFile.flush();
+    }
+    {
+        ApplicationDatabase adb(dbFile.fileName());
+        QVERIFY(adb.isValid());
+        QVERIFY(adb.isOutdated());
+        QVERIFY_EXCEPTION_THROWN(adb.read(), Exception);
+
+        QScopedPointer<Application> app(createApplication(qSL("com.pelagicore.test3")));
+        QVERIFY(app);
+        adb.write({ app.data() });
+    }
+    {
+        ApplicationDatabase adb(dbFile.fileName());
+        QVERIFY(!adb.isOutdated());
+        QVector<const Application *> apps = adb.read();
+        QCOMPARE(apps.size(), 1);
+        QCOMPARE(apps.first()->id(), qSL("com.pelagicore.test3"));
+        qDeleteAll(apps);
+    }
+}
+
+void tst_ApplicationManager::restart()
+{
+    const QString id = qSL("com.pelagicore.test1");
+    const Application *app = m_am->fromId(id);
+
+    m_am->setRestartConfiguration({ { qSL("policy"), qSL("on-failure") },
+                                    { qSL("initialDelay"), 50 },
+                                    { qSL("maximumDelay"), 80 },
+                                    { qSL("maximumCount"), 3 } });
+
+    QSignalSpy scheduledSpy(m_am, &ApplicationManager::applicationRestartScheduled);
+    QSignalSpy crashLoopSpy(m_am, &ApplicationManager::applicationCrashLoopDetected);
+
+    // normal exits and explicit stops do not trigger a restart with the on-failure policy
+    QVERIFY(m_am->startApplication(app));
+    runtime(id)->exit(0, QProcess::NormalExit);
+    QTRY_VERIFY(!app->currentRuntime());
+    QVERIFY(m_am->startApplication(app));
+    m_am->stopApplication(app, true);
+    QTRY_VERIFY(!app->currentRuntime());
+    QTest::qWait(100);
+    QCOMPARE(scheduledSpy.count(), 0);
+    QVERIFY(!app->currentRuntime());
+
+    // crashes are restarted with an exponential back-off, that is capped at maximumDelay
+    QVERIFY(m_am->startApplication(app));
+    for (int delay : { 50, 80, 80 }) {
+        QElapsedTimer timer;
+        timer.start();
+        runtime(id)->exit(SIGSEGV, QProcess::CrashExit);
+
+        QCOMPARE(scheduledSpy.count(), 1);
+        QCOMPARE(scheduledSpy.takeFirst(), QVariantList({ id, delay }));
+        QTRY_VERIFY(runtime(id));
+        QVERIFY(timer.elapsed() >= delay);
+    }
+    QCOMPARE(app->restartCount(), 3);
+
+    // the next crash is one too many
+    runtime(id)->exit(SIGSEGV, QProcess::CrashExit);
+    QCOMPARE(scheduledSpy.count(), 0);
+    QCOMPARE(crashLoopSpy.count(), 1);
+    QCOMPARE(crashLoopSpy.first().at(0).toString(), id);
+    QTest::qWait(100);
+    QVERIFY(!app->currentRuntime());
+
+    m_am->setRestartConfiguration({ { qSL("policy"), qSL("never") } });
+}
+
+void tst_ApplicationManager::containerSelection()
+{
+    QCOMPARE(m_am->selectableContainerIds(), QStringList { qSL("process") });
+
+    m_am->setContainerSelectionConfiguration({ QVariantMap { { qSL("com.pelagicore.*"), qSL("plugin") } },
+                                               QVariantMap { { qSL("*"), qSL("plugin") } } });
+    QCOMPARE(m_am->selectableContainerIds(), QStringList({ qSL("plugin"), qSL("process") }));
+
+    m_am->setContainerSelectionConfiguration(QVariantList());
+    QCOMPARE(m_am->selectableContainerIds(), QStringList { qSL("process") });
+}
+
+void tst_ApplicationManager::foregroundBoost()
+{
+    const QString id1 = qSL("com.pelagicore.test1");
+    const QString id2 = qSL("com.pelagicore.test2");
+
+    ForegroundBooster *fb = ForegroundBooster::instance();
+    fb->initialize({ { qSL("foregroundControlGroup"), qSL("foreground") },
+                     { qSL("backgroundControlGroup"), qSL("background") },
+                     { qSL("demotionDelay"), 100 } });
+    QVERIFY(fb->isEnabled());
+
+    QSignalSpy boostedSpy(fb, &ForegroundBooster::applicationBoosted);
+    QSignalSpy demotedSpy(fb, &ForegroundBooster::applicationDemoted);
+
+    // applications that are not running cannot be boosted
+    fb->activateApplication(id1);
+    QCOMPARE(boostedSpy.count(), 0);
+    QVERIFY(fb->foregroundApplication().isEmpty());
+
+    // the runtimes are only pretending to be out-of-process after they have been started, since
+    // the test has no containers
+    QVERIFY(m_am->startApplication(m_am->fromId(id1)));
+    QVERIFY(m_am->startApplication(m_am->fromId(id2)));
+    auto rtm = static_cast<TestRuntimeManager *>(RuntimeFactory::instance()->manager(qSL("test")));
+    rtm->setInProcess(false);
+
+    fb->activateApplication(id1);
+    QCOMPARE(boostedSpy.count(), 1);
+    QCOMPARE(boostedSpy.takeFirst().at(0).toString(), id1);
+    fb->activateApplication(id1);
+    QCOMPARE(boostedSpy.count(), 0);
+
+    // switching back within the demotion delay keeps the first application boosted
+    fb->activateApplication(id2);
+    fb->activateApplication(id1);
+    QCOMPARE(fb->foregroundApplication(), id1);
+    QCOMPARE(boostedSpy.count(), 2);
+    QVERIFY(demotedSpy.wait(1000));
+    QCOMPARE(demotedSpy.count(), 1);
+    QCOMPARE(demotedSpy.takeFirst().at(0).toString(), id2);
+
+    // the hysteresis is per application
+    fb->activateApplication(id2);
+    QTest::qWait(50);
+    QCOMPARE(demotedSpy.count(), 0);
+    QTRY_COMPARE(demotedSpy.count(), 1);
+    QCOMPARE(demotedSpy.takeFirst().at(0).toString(), id1);
+    QCOMPARE(fb->foregroundApplication(), id2);
+
+    rtm->setInProcess(true);
+    fb->initialize(QVariantMap());
+    m_am->stopApplication(m_am->fromId(id1), true);
+    m_am->stopApplication(m_am->fromId(id2), true);
+    QTRY_VERIFY(!runtime(id1) && !runtime(id2));
+}
+
+// this has to be the last test, since there is no way back from a shut-down
+void tst_ApplicationManager::shutDown()
+{
+    QVERIFY(m_am->startApplication(m_am->fromId(qSL("com.pelagicore.test1"))));
+    QVERIFY(m_am->startApplication(m_am->fromId(qSL("com.pelagicore.test2"))));
+    QVERIFY(runtime(qSL("com.pelagicore.test1")));
+    QVERIFY(runtime(qSL("com.pelagicore.test2")));
+
+    // the first application quits right away, the second one ignores the request and gets killed
+    QPointer<TestRuntime> rt1 = runtime(qSL("com.pelagicore.test1"));
+    QPointer<TestRuntime> rt2 = runtime(qSL("com.pelagicore.test2"));
+    rt2->setIgnoreTerminate(true);
+
+    QSignalSpy finishedSpy(m_am, &ApplicationManager::shutDownFinished);
+    QElapsedTimer timer;
+    timer.start();
+
+    m_am->shutDown(200);
+
+    QVERIFY(m_am->isShuttingDown());
+    QCOMPARE(rt1->state(), AbstractRuntime::Inactive);
+    QCOMPARE(rt2->state(), AbstractRuntime::Active);
+    QVERIFY(!m_am->startApplication(m_am->fromId(qSL("com.pelagicore.test1"))));
+
+    QVERIFY(finishedSpy.wait(2000));
+    QVERIFY(timer.elapsed() >= 200);
+    QCOMPARE(finishedSpy.count(), 1);
+    QCOMPARE(finishedSpy.first().at(0).toStringList(), QStringList { qSL("com.pelagicore.test2") });
+
+    QTRY_VERIFY(!rt1 && !rt2);
+    QVERIFY(!m_am->fromId(qSL("com.pelagicore.test2"))->currentRuntime());
+}
+
+QTEST_MAIN(tst_ApplicationManager)
+
+#include "tst_applicationmanager.moc"
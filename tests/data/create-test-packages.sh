@@ -117,6 +117,20 @@ packager dev-sign-package "$dst/bigtest.appkg" "$dst/bigtest-dev-signed.appkg" c
 cp info.yaml "$src"
 rm "$src/bigtest"
 
+###  medium packages: each one fits onto the test SD-card, but not both at the same time
+
+dd if=/dev/zero of="$src/mediumtest" bs=1048576 count=1 >/dev/null 2>&1
+
+for i in 1 2; do
+  sed <info.yaml >"$src/info.yaml" "s/id: \"com.pelagicore.test\"/id: \"com.pelagicore.test.medium$i\"/"
+
+  info "Create medium package $i"
+  packager create-package "$dst/mediumtest$i.appkg" "$src"
+done
+
+cp info.yaml "$src"
+rm "$src/mediumtest"
+
 ### create invalid packages
 
 tar -C "$src" -xof "$dst/test.appkg" -- --PACKAGE-HEADER-- --PACKAGE-FOOTER--
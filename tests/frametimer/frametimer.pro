@@ -0,0 +1,9 @@
+TARGET = tst_frametimer
+
+include($$PWD/../tests.pri)
+
+QT *= \
+    appman_common-private \
+    appman_manager-private \
+
+SOURCES += tst_frametimer.cpp
@@ -0,0 +1,191 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest>
+
+#include "frametimer.h"
+
+QT_USE_NAMESPACE_AM
+
+class tst_FrameTimer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+    void percentiles();
+    void buckets();
+    void droppedFrames();
+    void stall();
+    void idle();
+    void idleThreshold();
+};
+
+void tst_FrameTimer::empty()
+{
+    FrameTimer ft;
+    QCOMPARE(ft.averageFps(), qreal(0));
+    QCOMPARE(ft.frameTimePercentile(qreal(0.5)), qreal(0));
+    QCOMPARE(ft.droppedFrames(), 0);
+    QCOMPARE(ft.longestFrameTime(), qreal(0));
+}
+
+void tst_FrameTimer::percentiles()
+{
+    FrameTimer ft;
+    ft.setRefreshRate(60);
+
+    // 90 frames at 10ms, 9 at 20ms and a single one at 45ms
+    for (int i = 0; i < 90; ++i)
+        ft.addFrameTime(10000);
+    for (int i = 0; i < 9; ++i)
+        ft.addFrameTime(20000);
+    ft.addFrameTime(45000);
+
+    // the 10ms frames are in the (9ms, 10ms] bucket, but nothing is shorter than 10ms
+    QCOMPARE(ft.frameTimePercentile(qreal(0.5)), qreal(10));
+    QCOMPARE(ft.frameTimePercentile(qreal(0.9)), qreal(10));
+    QCOMPARE(ft.frameTimePercentile(qreal(0.99)), qreal(20));
+    QCOMPARE(ft.frameTimePercentile(qreal(1)), qreal(45));
+    QCOMPARE(ft.longestFrameTime(), qreal(45));
+
+    ft.reset();
+    QCOMPARE(ft.frameTimePercentile(qreal(0.5)), qreal(0));
+    QCOMPARE(ft.longestFrameTime(), qreal(0));
+}
+
+void tst_FrameTimer::buckets()
+{
+    // exactly 1ms is still in the first bucket
+    FrameTimer ft;
+    ft.addFrameTime(1000);
+    QCOMPARE(ft.frameTimePercentile(qreal(1)), qreal(1));
+
+    // 10ms steps between 50ms and 200ms: the bucket is clamped to the shortest and longest frame
+    ft.reset();
+    ft.addFrameTime(55000);
+    ft.addFrameTime(58000);
+    QCOMPARE(ft.frameTimePercentile(qreal(0.5)), qreal(56.5));
+    QCOMPARE(ft.frameTimePercentile(qreal(1)), qreal(58));
+
+    // 100ms steps between 200ms and 1s
+    ft.reset();
+    ft.addFrameTime(250000);
+    ft.addFrameTime(300000);
+    QCOMPARE(ft.frameTimePercentile(qreal(0.5)), qreal(275));
+    QCOMPARE(ft.frameTimePercentile(qreal(1)), qreal(300));
+
+    // everything above 1s ends up in the overflow bucket
+    ft.reset();
+    ft.addFrameTime(1500000);
+    ft.addFrameTime(4000000);
+    QCOMPARE(ft.frameTimePercentile(qreal(1)), qreal(4000));
+    QCOMPARE(ft.longestFrameTime(), qreal(4000));
+}
+
+void tst_FrameTimer::droppedFrames()
+{
+    FrameTimer ft;
+    ft.setRefreshRate(50);
+    QCOMPARE(ft.idealFrameTime(), 20000);
+
+    ft.addFrameTime(20000);
+    ft.addFrameTime(29000); // less than half a frame late
+    QCOMPARE(ft.droppedFrames(), 0);
+    ft.addFrameTime(30000); // half a frame late
+    QCOMPARE(ft.droppedFrames(), 1);
+    ft.addFrameTime(100000);
+    QCOMPARE(ft.droppedFrames(), 5);
+}
+
+void tst_FrameTimer::stall()
+{
+    // a window that never reports the frame start is measured from swap to swap: a freeze
+    // has to show up as a long frame
+    FrameTimer ft;
+    ft.newFrame();
+    QTest::qSleep(200);
+    ft.newFrame();
+
+    QVERIFY(ft.longestFrameTime() >= 200);
+    QVERIFY(ft.frameTimePercentile(qreal(1)) >= 200);
+    QVERIFY(ft.droppedFrames() > 0);
+
+    // the same is true, if the window stalls after the frame was started
+    ft.reset();
+    ft.frameStarted();
+    QTest::qSleep(200);
+    ft.newFrame();
+    QVERIFY(ft.longestFrameTime() >= 200);
+}
+
+void tst_FrameTimer::idle()
+{
+    // the time between a swap and the start of the next frame is idle time
+    FrameTimer ft;
+    ft.newFrame();
+    ft.reset();
+    QTest::qSleep(200);
+    ft.frameStarted();
+    ft.newFrame();
+
+    QCOMPARE(ft.droppedFrames(), 0);
+    QVERIFY(ft.longestFrameTime() < 100);
+
+    // only the first start after a swap counts
+    ft.reset();
+    ft.frameStarted();
+    QTest::qSleep(200);
+    ft.frameStarted();
+    ft.newFrame();
+    QVERIFY(ft.longestFrameTime() >= 200);
+}
+
+void tst_FrameTimer::idleThreshold()
+{
+    // without frame start reports, long gaps between two swaps are idle time
+    FrameTimer ft;
+    ft.setIdleThreshold(3);
+    ft.newFrame();
+    ft.reset();
+    QTest::qSleep(200);
+    ft.newFrame();
+
+    QCOMPARE(ft.droppedFrames(), 0);
+    QCOMPARE(ft.longestFrameTime(), qreal(0));
+
+    // the swap after the gap starts the next measurement
+    ft.newFrame();
+    QCOMPARE(ft.droppedFrames(), 0);
+    QVERIFY(ft.longestFrameTime() < 50);
+    QVERIFY(ft.averageFps() > 0);
+}
+
+QTEST_APPLESS_MAIN(tst_FrameTimer)
+
+#include "tst_frametimer.moc"
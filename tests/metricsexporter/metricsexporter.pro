@@ -0,0 +1,10 @@
+TARGET = tst_metricsexporter
+
+include($$PWD/../tests.pri)
+
+QT *= \
+    network \
+    appman_common-private \
+    appman_manager-private \
+
+SOURCES += tst_metricsexporter.cpp
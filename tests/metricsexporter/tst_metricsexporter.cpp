@@ -0,0 +1,166 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QLocalSocket>
+
+#include "metricsexporter.h"
+
+QT_USE_NAMESPACE_AM
+
+class tst_MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void exposition();
+    void collector();
+    void scrape_data();
+    void scrape();
+
+private:
+    QTemporaryDir m_tmp;
+    QString m_socketName;
+};
+
+void tst_MetricsExporter::initTestCase()
+{
+    QVERIFY(m_tmp.isValid());
+    m_socketName = m_tmp.path() + qSL("/metrics");
+
+    // a stale left-over from a crashed instance has to be replaced
+    QFile stale(m_socketName);
+    QVERIFY(stale.open(QFile::WriteOnly));
+    stale.close();
+
+    MetricsExporter *me = MetricsExporter::instance();
+    QVERIFY(!me->isEnabled());
+    me->initialize(QVariantMap { { qSL("socket"), m_socketName } });
+    QVERIFY(me->isEnabled());
+
+    me->registerCounter(qSL("test_requests"), qSL("Requests"));
+    me->registerGauge(qSL("test_temperature_celsius"), qSL("Temperature"));
+    me->registerHistogram(qSL("test_duration_seconds"), QString(), { 1, 0.5 });
+}
+
+void tst_MetricsExporter::exposition()
+{
+    MetricsExporter *me = MetricsExporter::instance();
+
+    me->incrementCounter(qSL("test_requests"));
+    me->incrementCounter(qSL("test_requests"), MetricsExporter::Labels(), 2);
+    me->incrementCounter(qSL("test_requests"), { { qSL("result"), qSL("a \"b\"") } });
+    me->setGauge(qSL("test_temperature_celsius"), { { qSL("zone"), qSL("cpu") }, { qSL("core"), qSL("0") } }, 42.5);
+    me->observe(qSL("test_duration_seconds"), MetricsExporter::Labels(), 0.5);
+    me->observe(qSL("test_duration_seconds"), MetricsExporter::Labels(), 0.75);
+    me->observe(qSL("test_duration_seconds"), MetricsExporter::Labels(), 5);
+
+    // unregistered metrics and type mismatches are ignored
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(qSL(".*test_unknown.*")));
+    me->setGauge(qSL("test_unknown"), MetricsExporter::Labels(), 1);
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(qSL(".*test_requests.*")));
+    me->setGauge(qSL("test_requests"), MetricsExporter::Labels(), 1);
+
+    const QByteArray expected =
+            "# TYPE test_duration_seconds histogram\n"
+            "test_duration_seconds_bucket{le=\"0.5\"} 1\n"
+            "test_duration_seconds_bucket{le=\"1\"} 2\n"
+            "test_duration_seconds_bucket{le=\"+Inf\"} 3\n"
+            "test_duration_seconds_count 3\n"
+            "test_duration_seconds_sum 6.25\n"
+            "# TYPE test_requests counter\n"
+            "# HELP test_requests Requests\n"
+            "test_requests_total 3\n"
+            "test_requests_total{result=\"a \\\"b\\\"\"} 1\n"
+            "# TYPE test_temperature_celsius gauge\n"
+            "# HELP test_temperature_celsius Temperature\n"
+            "test_temperature_celsius{core=\"0\",zone=\"cpu\"} 42.5\n"
+            "# EOF\n";
+    QCOMPARE(me->exposition(), expected);
+}
+
+void tst_MetricsExporter::collector()
+{
+    MetricsExporter *me = MetricsExporter::instance();
+    me->registerGauge(qSL("test_collected"), QString());
+
+    int calls = 0;
+    {
+        QObject context;
+        me->registerCollector(&context, [me, &calls]() {
+            me->clearSeries(qSL("test_collected"));
+            me->setGauge(qSL("test_collected"), { { qSL("call"), QString::number(++calls) } }, calls);
+        });
+
+        QVERIFY(me->exposition().contains("test_collected{call=\"1\"} 1\n"));
+        QByteArray out = me->exposition();
+        QVERIFY(out.contains("test_collected{call=\"2\"} 2\n"));
+        QVERIFY(!out.contains("call=\"1\""));
+    }
+
+    // the collector is gone together with its context object
+    me->exposition();
+    QCOMPARE(calls, 2);
+}
+
+void tst_MetricsExporter::scrape_data()
+{
+    QTest::addColumn<QByteArray>("request");
+    QTest::addColumn<bool>("http");
+
+    QTest::newRow("raw") << QByteArray() << false;
+    QTest::newRow("http") << QByteArray("GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n") << true;
+}
+
+void tst_MetricsExporter::scrape()
+{
+    QFETCH(QByteArray, request);
+    QFETCH(bool, http);
+
+    QLocalSocket socket;
+    socket.connectToServer(m_socketName);
+    QVERIFY(socket.waitForConnected(1000));
+    if (!request.isEmpty())
+        socket.write(request);
+
+    QByteArray response;
+    QTRY_VERIFY_WITH_TIMEOUT((response += socket.readAll()).endsWith("# EOF\n"), 2000);
+
+    QCOMPARE(response.startsWith("HTTP/1.0 200 OK\r\n"), http);
+    QVERIFY(response.contains("test_requests_total 3\n"));
+    if (http)
+        QVERIFY(response.contains("Content-Type: application/openmetrics-text"));
+    else
+        QVERIFY(response.startsWith("# TYPE "));
+}
+
+QTEST_MAIN(tst_MetricsExporter)
+
+#include "tst_metricsexporter.moc"
@@ -52,6 +52,8 @@ private Q_SLOTS:
     void initTestCase();
 
     void test();
+    void deltaPackage();
+    void deltaPackageErrors();
     void brokenMetadata_data();
     void brokenMetadata();
 
@@ -64,6 +66,7 @@ private:
     bool createInfoYaml(TemporaryDir &tmp, const QString &changeField = QString(), const QVariant &toValue = QVariant());
     bool createIconPng(TemporaryDir &tmp);
     bool createCode(TemporaryDir &tmp);
+    void installPackage(const QString &filePath, QString &errorString);
 
 
     ApplicationInstaller *m_ai = 0;
@@ -258,6 +261,135 @@ void tst_PackagerTool::test()
     }
 }
 
+void tst_PackagerTool::deltaPackage()
+{
+    // test() left the previous version of com.pelagicore.test installed
+    TemporaryDir base;
+    TemporaryDir tmp;
+    QString errorString;
+
+    for (TemporaryDir *dir : { &base, &tmp })
+        QVERIFY(createInfoYaml(*dir) && createIconPng(*dir) && createCode(*dir));
+
+    QFile newFile(QDir(tmp.path()).absoluteFilePath(qSL("new.txt")));
+    QVERIFY(newFile.open(QFile::WriteOnly) && newFile.write("new") == 3LL);
+    newFile.close();
+
+    QScopedPointer<Packager> full(Packager::create(pathTo("full.appkg"), tmp.path()));
+    QVERIFY2(packagerCheck(full.data(), errorString), qPrintable(errorString));
+    QScopedPointer<Packager> delta(Packager::create(pathTo("delta.appkg"), tmp.path(), base.path()));
+    QVERIFY2(packagerCheck(delta.data(), errorString), qPrintable(errorString));
+
+    // the delta package is verified against the digest of the full package
+    QCOMPARE(delta->packageDigest(), full->packageDigest());
+    QCOMPARE(delta->output(), qSL("reusing 1 unchanged files"));
+
+    // signing needs the base version to get at the complete content
+    QVERIFY(!packagerCheck(Packager::developerSign(
+                               pathTo("delta.appkg"),
+                               pathTo("delta.dev-signed.appkg"),
+                               m_devCertificate,
+                               m_devPassword), errorString));
+    QVERIFY2(errorString.contains(qL1S("there is no previous version")), qPrintable(errorString));
+
+    QScopedPointer<Packager> signedDelta(Packager::developerSign(
+                                             pathTo("delta.appkg"),
+                                             pathTo("delta.dev-signed.appkg"),
+                                             m_devCertificate,
+                                             m_devPassword,
+                                             base.path()));
+    QVERIFY2(packagerCheck(signedDelta.data(), errorString), qPrintable(errorString));
+
+    // ... and the signed package is still a delta package
+    QCOMPARE(signedDelta->packageDigest(), full->packageDigest());
+    QCOMPARE(signedDelta->output(), qSL("reusing 1 unchanged files"));
+
+    QVERIFY2(packagerCheck(Packager::developerVerify(
+                               pathTo("delta.dev-signed.appkg"),
+                               m_caFiles,
+                               base.path()), errorString), qPrintable(errorString));
+
+    m_ai->setDevelopmentMode(true); // allow packages without store signature
+    installPackage(pathTo("delta.dev-signed.appkg"), errorString);
+    m_ai->setDevelopmentMode(false);
+    QVERIFY2(errorString.isEmpty(), qPrintable(errorString));
+
+    QDir checkDir(pathTo("internal-0"));
+    QVERIFY(checkDir.cd(qSL("com.pelagicore.test")));
+
+    for (const QString &file : { qSL("info.yaml"), qSL("icon.png"), qSL("test.qml"), qSL("new.txt") }) {
+        QVERIFY(checkDir.exists(file));
+        QFile src(QDir(tmp.path()).absoluteFilePath(file));
+        QVERIFY(src.open(QFile::ReadOnly));
+        QFile dst(checkDir.absoluteFilePath(file));
+        QVERIFY(dst.open(QFile::ReadOnly));
+        QCOMPARE(src.readAll(), dst.readAll());
+    }
+}
+
+void tst_PackagerTool::deltaPackageErrors()
+{
+    // deltaPackage() left com.pelagicore.test installed, with the original test.qml and no version
+    TemporaryDir base;
+    TemporaryDir tmp;
+    QString errorString;
+
+    for (TemporaryDir *dir : { &base, &tmp })
+        QVERIFY(createInfoYaml(*dir) && createIconPng(*dir) && createCode(*dir));
+
+    // missing base
+    QVERIFY(!packagerCheck(Packager::create(pathTo("delta.appkg"), tmp.path(), pathTo("no-such-dir")), errorString));
+    QVERIFY2(errorString.contains(qL1S("is not a directory")), qPrintable(errorString));
+
+    // files with a different eXecutable-bit are not reused
+    QFile baseCode(QDir(base.path()).absoluteFilePath(qSL("test.qml")));
+    QVERIFY(baseCode.setPermissions(baseCode.permissions() | QFile::ExeOwner | QFile::ExeUser));
+
+    QScopedPointer<Packager> modeDelta(Packager::create(pathTo("delta.appkg"), tmp.path(), base.path()));
+    QVERIFY2(packagerCheck(modeDelta.data(), errorString), qPrintable(errorString));
+    QCOMPARE(modeDelta->output(), qSL("reusing 0 unchanged files"));
+
+    QVERIFY(baseCode.setPermissions(baseCode.permissions() & ~(QFile::ExeOwner | QFile::ExeUser)));
+
+    // these packages are unsigned: only the delta package checks should make them fail
+    ApplicationManager::instance()->setSecurityChecksEnabled(false);
+
+    // the base version does not match the installed one
+    QVERIFY(createInfoYaml(base, qSL("version"), qSL("1.0")));
+    QVERIFY2(packagerCheck(Packager::create(pathTo("delta.appkg"), tmp.path(), base.path()), errorString), qPrintable(errorString));
+
+    installPackage(pathTo("delta.appkg"), errorString);
+    QVERIFY2(errorString.contains(qL1S("needs version '1.0' to be installed, but found version ''")), qPrintable(errorString));
+
+    // the installed test.qml does not match the one in the base directory
+    QVERIFY(createInfoYaml(base));
+    for (TemporaryDir *dir : { &base, &tmp }) {
+        QFile code(QDir(dir->path()).absoluteFilePath(qSL("test.qml")));
+        QVERIFY(code.open(QFile::WriteOnly | QFile::Truncate) && code.write("// diff") == 7LL);
+    }
+    QVERIFY2(packagerCheck(Packager::create(pathTo("delta.appkg"), tmp.path(), base.path()), errorString), qPrintable(errorString));
+
+    installPackage(pathTo("delta.appkg"), errorString);
+    QVERIFY2(errorString.contains(qL1S("the file test.qml of the previous version does not match")), qPrintable(errorString));
+
+    QFile installedCode(QDir(pathTo("internal-0")).absoluteFilePath(qSL("com.pelagicore.test/test.qml")));
+    QVERIFY(installedCode.open(QFile::ReadOnly));
+    QCOMPARE(installedCode.readAll(), QByteArray("// test"));
+    installedCode.close();
+
+    // a fresh installation of a delta package
+    QSignalSpy finishedSpy(m_ai, &ApplicationInstaller::taskFinished);
+    QString taskId = m_ai->removePackage(qSL("com.pelagicore.test"), false);
+    QVERIFY(!taskId.isEmpty());
+    QVERIFY(finishedSpy.wait());
+    QCOMPARE(finishedSpy.first()[0].toString(), taskId);
+
+    installPackage(pathTo("delta.appkg"), errorString);
+    QVERIFY2(errorString.contains(qL1S("needs version '' to be installed already")), qPrintable(errorString));
+
+    ApplicationManager::instance()->setSecurityChecksEnabled(true);
+}
+
 void tst_PackagerTool::brokenMetadata_data()
 {
     QTest::addColumn<QString>("yamlField");
@@ -312,6 +444,26 @@ bool tst_PackagerTool::createInfoYaml(TemporaryDir &tmp, const QString &changeFi
     return infoYaml.open(QFile::WriteOnly) && infoYaml.write(yaml) == yaml.size();
 }
 
+// errorString is empty, if the installation succeeded
+void tst_PackagerTool::installPackage(const QString &filePath, QString &errorString)
+{
+    QSignalSpy finishedSpy(m_ai, &ApplicationInstaller::taskFinished);
+    QSignalSpy failedSpy(m_ai, &ApplicationInstaller::taskFailed);
+
+    QString taskId = m_ai->startPackageInstallation(qSL("internal-0"), QUrl::fromLocalFile(filePath));
+    m_ai->acknowledgePackageInstallation(taskId);
+
+    QTRY_VERIFY(!finishedSpy.isEmpty() || !failedSpy.isEmpty());
+
+    if (!failedSpy.isEmpty()) {
+        QCOMPARE(failedSpy.first()[0].toString(), taskId);
+        errorString = failedSpy.first()[2].toString();
+    } else {
+        QCOMPARE(finishedSpy.first()[0].toString(), taskId);
+        errorString.clear();
+    }
+}
+
 bool tst_PackagerTool::createIconPng(TemporaryDir &tmp)
 {
     QFile iconPng(QDir(tmp.path()).absoluteFilePath(qSL("icon.png")));
@@ -0,0 +1,198 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest>
+
+#include <csignal>
+#include <pthread.h>
+
+#include "processcontainer.h"
+#include "controlgroupv2.h"
+
+QT_USE_NAMESPACE_AM
+
+class tst_ProcessContainer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void spawnExitCode();
+    void spawnSignalMask();
+    void spawnExecFailure();
+    void controlGroupV2Leaf();
+};
+
+// the QProcess enums cannot be recorded by QSignalSpy in all Qt versions
+struct SpawnResult
+{
+    SpawnResult(SpawnedHostProcess *process)
+    {
+        QObject::connect(process, &AbstractContainerProcess::started, [this]() { ++started; });
+        QObject::connect(process, &AbstractContainerProcess::errorOccured, [this](QProcess::ProcessError e) { error = e; });
+        QObject::connect(process, &AbstractContainerProcess::finished,
+                         [this](int code, QProcess::ExitStatus status) { exitCode = code; exitStatus = status; finished = true; });
+    }
+
+    int started = 0;
+    bool finished = false;
+    int exitCode = -1;
+    QProcess::ExitStatus exitStatus = QProcess::NormalExit;
+    QProcess::ProcessError error = QProcess::UnknownError;
+};
+
+void tst_ProcessContainer::init()
+{
+    if ((qstrncmp(QTest::currentTestFunction(), "spawn", 5) == 0) && !SpawnedHostProcess::isSupported())
+        QSKIP("the 'spawn' process backend needs pidfd support (Linux 5.3)");
+}
+
+void tst_ProcessContainer::spawnExitCode()
+{
+    SpawnedHostProcess process;
+    SpawnResult result(&process);
+
+    process.start(qSL("/bin/sh"), { qSL("-c"), qSL("exit 42") });
+    QTRY_VERIFY(result.finished);
+
+    QCOMPARE(result.started, 1);
+    QCOMPARE(result.exitCode, 42);
+    QCOMPARE(result.exitStatus, QProcess::NormalExit);
+    QCOMPARE(process.state(), QProcess::NotRunning);
+    QCOMPARE(process.processId(), 0);
+}
+
+void tst_ProcessContainer::spawnSignalMask()
+{
+    sigset_t before;
+    sigset_t after;
+    QCOMPARE(::pthread_sigmask(SIG_SETMASK, nullptr, &before), 0);
+
+    // the child has to get our signal mask back: otherwise it would survive its own SIGTERM
+    SpawnedHostProcess process;
+    SpawnResult result(&process);
+
+    process.start(qSL("/bin/sh"), { qSL("-c"), qSL("kill -TERM $$; exit 0") });
+
+    QCOMPARE(::pthread_sigmask(SIG_SETMASK, nullptr, &after), 0);
+    for (int sig = 1; sig < NSIG; ++sig)
+        QCOMPARE(::sigismember(&after, sig), ::sigismember(&before, sig));
+
+    QTRY_VERIFY(result.finished);
+    QCOMPARE(result.exitCode, int(SIGTERM));
+    QCOMPARE(result.exitStatus, QProcess::CrashExit);
+}
+
+void tst_ProcessContainer::spawnExecFailure()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+
+    // exists, but is not executable: this fails in the child's execve()
+    QFile notExecutable(tmp.path() + qSL("/not-executable"));
+    QVERIFY(notExecutable.open(QFile::WriteOnly));
+    notExecutable.close();
+
+    SpawnedHostProcess process;
+    SpawnResult result(&process);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(qSL("Could not start .*not-executable.*")));
+    process.start(notExecutable.fileName(), { });
+    QTRY_COMPARE(result.error, QProcess::FailedToStart);
+
+    QCOMPARE(result.started, 0);
+    QVERIFY(!result.finished);
+    QCOMPARE(process.state(), QProcess::NotRunning);
+
+    // a failing chdir() in the child takes the same path
+    SpawnedHostProcess process2;
+    SpawnResult result2(&process2);
+    process2.setWorkingDirectory(tmp.path() + qSL("/no-such-dir"));
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(qSL("Could not start .*sh.*")));
+    process2.start(qSL("/bin/sh"), { qSL("-c"), qSL("exit 0") });
+    QTRY_COMPARE(result2.error, QProcess::FailedToStart);
+    QCOMPARE(result2.started, 0);
+}
+
+void tst_ProcessContainer::controlGroupV2Leaf()
+{
+    // a fake hierarchy: a real cgroup2 file-system creates these interface files by itself
+    QTemporaryDir fakeRoot;
+    QVERIFY(fakeRoot.isValid());
+
+    for (const QString &group : { QString(), qSL("am"), qSL("am/foreground") }) {
+        QDir dir(fakeRoot.path() + qL1C('/') + group);
+        QVERIFY(dir.mkpath(qSL(".")));
+        QFile available(dir.absoluteFilePath(qSL("cgroup.controllers")));
+        QVERIFY(available.open(QFile::WriteOnly) && available.write("cpu io memory pids") > 0);
+        QFile enabled(dir.absoluteFilePath(qSL("cgroup.subtree_control")));
+        QVERIFY(enabled.open(QFile::WriteOnly));
+    }
+    ControlGroupV2::setMountPoint(fakeRoot.path());
+
+    ProcessContainerManager manager;
+    manager.setConfiguration(QVariantMap {
+        { qSL("controlGroupRoot"), qSL("/am") },
+        { qSL("controlGroupPerProcess"), true },
+        { qSL("controlGroups"), QVariantMap {
+              { qSL("foreground"), QVariantMap {
+                    { qSL("cpu.weight"), 200 },
+                    { qSL("memory.high"), qSL("max") },
+                    { qSL("cpuset"), qSL("foreground") } // v1 style: ignored
+                } }
+          } }
+    });
+
+    // the class' own controllers, plus the ones needed for the accounting
+    QCOMPARE(manager.controlGroupV2LeafControllers(qSL("foreground")),
+             QStringList({ qSL("cpu"), qSL("memory"), qSL("io") }));
+
+    QCOMPARE(manager.controlGroupV2LeafPath(qSL("foreground"), qSL("process-1-1")),
+             qSL("am/foreground/process-1-1"));
+    QVERIFY(QDir(fakeRoot.path()).exists(qSL("am/foreground/process-1-1")));
+
+    // enabled top-down, including the class itself, so the leaf gets the interface files
+    for (const QString &group : { QString(), qSL("am"), qSL("am/foreground") }) {
+        QFile enabled(fakeRoot.path() + qL1C('/') + group + qSL("/cgroup.subtree_control"));
+        QVERIFY(enabled.open(QFile::ReadOnly));
+        QCOMPARE(enabled.readAll(), QByteArray("+cpu +memory +io"));
+    }
+    QFile cpuWeight(fakeRoot.path() + qSL("/am/foreground/cpu.weight"));
+    QVERIFY(cpuWeight.open(QFile::ReadOnly));
+    QCOMPARE(cpuWeight.readAll(), QByteArray("200"));
+
+    // not configured
+    QVERIFY(manager.controlGroupV2LeafPath(qSL("background"), qSL("process-1-2")).isEmpty());
+
+    ControlGroupV2::setMountPoint(qSL("/sys/fs/cgroup"));
+}
+
+QTEST_GUILESS_MAIN(tst_ProcessContainer)
+
+#include "tst_processcontainer.moc"
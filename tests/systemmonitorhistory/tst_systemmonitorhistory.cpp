@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest>
+#include <QTemporaryFile>
+#include <qnumeric.h>
+
+#include "systemmonitorhistory.h"
+
+QT_USE_NAMESPACE_AM
+
+class tst_SystemMonitorHistory : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void resolutions();
+    void downsampling();
+    void dump();
+};
+
+static void addSample(SystemMonitorHistory &h, qint64 timestamp, qreal cpu, qreal mem, qreal fps)
+{
+    qreal values[SystemMonitorHistory::MetricCount];
+    values[SystemMonitorHistory::CpuLoad] = cpu;
+    values[SystemMonitorHistory::MemoryUsed] = mem;
+    values[SystemMonitorHistory::Fps] = fps;
+    h.addSample(timestamp, values);
+}
+
+void tst_SystemMonitorHistory::resolutions()
+{
+    SystemMonitorHistory h;
+    QCOMPARE(h.resolutions(), QVector<int>() << 1000 << 10000 << 60000);
+}
+
+void tst_SystemMonitorHistory::downsampling()
+{
+    SystemMonitorHistory h;
+
+    // 4 samples in the first second, 1 in the next one (which closes the first bucket)
+    addSample(h, 1000, 0.1, 100, qQNaN());
+    addSample(h, 1250, 0.5, 300, qQNaN());
+    addSample(h, 1500, 0.3, 200, qQNaN());
+    addSample(h, 1750, 0.3, 200, qQNaN());
+    addSample(h, 2000, 1, 1000, 60);
+
+    QVariantList buckets = h.buckets(1000);
+    QCOMPARE(buckets.size(), 1);
+
+    QVariantMap b = buckets.first().toMap();
+    QCOMPARE(b.value(qSL("timestamp")).toLongLong(), qint64(1000));
+    QCOMPARE(b.value(qSL("samples")).toInt(), 4);
+    QVERIFY(!b.contains(qSL("fps")));
+
+    QVariantMap cpu = b.value(qSL("cpuLoad")).toMap();
+    QCOMPARE(cpu.value(qSL("min")).toReal(), qreal(float(0.1)));
+    QCOMPARE(cpu.value(qSL("max")).toReal(), qreal(float(0.5)));
+    QVERIFY(qAbs(cpu.value(qSL("avg")).toReal() - 0.3) < 0.0001);
+
+    QVariantMap mem = b.value(qSL("memoryUsed")).toMap();
+    QCOMPARE(mem.value(qSL("avg")).toReal(), qreal(200));
+
+    // the coarser tiers are still collecting
+    QVERIFY(h.buckets(10000).isEmpty());
+    QVERIFY(h.buckets(1000, 1001).isEmpty());
+
+    // a sample in the next minute closes all tiers
+    addSample(h, 60000, 0, 0, 0);
+    QCOMPARE(h.buckets(1000).size(), 2);
+    QCOMPARE(h.buckets(60000).size(), 1);
+    QCOMPARE(h.buckets(60000).first().toMap().value(qSL("samples")).toInt(), 5);
+}
+
+void tst_SystemMonitorHistory::dump()
+{
+    SystemMonitorHistory h;
+    for (int i = 0; i < 200; ++i)
+        addSample(h, i * 1000, 0.5, 1024, 60);
+
+    QTemporaryFile f;
+    QVERIFY(f.open());
+    QVERIFY(h.dump(f.fileName()));
+
+    QByteArray data = f.readAll();
+    QVERIFY(data.startsWith("AMSH"));
+
+    // the 1 second tier is full (120 buckets), the others have 19 and 3 buckets
+    const int bucketSize = 8 + 4 + 3 * 3 * 4;
+    const int expected = 4 + 3 * 4 + 3 * 2 * 4 + (120 + 19 + 3) * bucketSize;
+    QCOMPARE(data.size(), expected);
+}
+
+QTEST_MAIN(tst_SystemMonitorHistory)
+
+#include "tst_systemmonitorhistory.moc"
@@ -0,0 +1,241 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest>
+#include <QThread>
+#include <QTemporaryFile>
+
+#include "spscqueue.h"
+#include "systemmonitor_p.h"
+#if defined(Q_OS_LINUX)
+#  include "sysfsreader.h"
+#endif
+
+QT_USE_NAMESPACE_AM
+
+class tst_SystemMonitorSampler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void queue();
+    void queueThreaded();
+    void batch();
+    void procFs();
+    void sampler();
+
+private:
+    int m_available = 0;
+};
+
+void tst_SystemMonitorSampler::queue()
+{
+    SpscQueue<int, 4> q;
+    int value = -1;
+
+    QVERIFY(q.isEmpty());
+    QVERIFY(!q.pop(&value));
+
+    for (int i = 0; i < 4; ++i)
+        QVERIFY(q.push(i));
+    QVERIFY(!q.push(4));
+
+    QVERIFY(q.pop(&value));
+    QCOMPARE(value, 0);
+    QVERIFY(q.push(4)); // wraps around
+
+    for (int i = 1; i <= 4; ++i) {
+        QVERIFY(q.pop(&value));
+        QCOMPARE(value, i);
+    }
+    QVERIFY(q.isEmpty());
+}
+
+class Producer : public QThread
+{
+public:
+    Producer(SpscQueue<int, 16> *queue, int count)
+        : m_queue(queue), m_count(count)
+    { }
+
+protected:
+    void run() override
+    {
+        for (int i = 0; i < m_count; ) {
+            if (m_queue->push(i))
+                ++i;
+            else
+                yieldCurrentThread();
+        }
+    }
+
+private:
+    SpscQueue<int, 16> *m_queue;
+    int m_count;
+};
+
+void tst_SystemMonitorSampler::queueThreaded()
+{
+    const int count = 100000;
+    SpscQueue<int, 16> q;
+    Producer producer(&q, count);
+    producer.start();
+
+    // every value has to arrive exactly once and in order
+    int expected = 0;
+    QElapsedTimer timer;
+    timer.start();
+    while (expected < count && timer.elapsed() < 10000) {
+        int value;
+        if (q.pop(&value)) {
+            QCOMPARE(value, expected);
+            ++expected;
+        } else {
+            QThread::yieldCurrentThread();
+        }
+    }
+    QVERIFY(producer.wait(1000));
+    QCOMPARE(expected, count);
+    QVERIFY(q.isEmpty());
+}
+
+void tst_SystemMonitorSampler::batch()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("SysFsBatch is only available on Linux");
+#else
+    QVector<QTemporaryFile *> files;
+    QVector<SysFsReader *> readers;
+    for (int i = 0; i < 3; ++i) {
+        QTemporaryFile *f = new QTemporaryFile(this);
+        QVERIFY(f->open());
+        QVERIFY(f->write("value " + QByteArray::number(i)) > 0);
+        QVERIFY(f->flush());
+        files << f;
+        readers << new SysFsReader(QFile::encodeName(f->fileName()), 64);
+        QVERIFY(readers.last()->isOpen());
+    }
+
+    // with and without io_uring, a batch delivers the complete content to every reader
+    SysFsBatch batch;
+    for (const SysFsReader *reader : qAsConst(readers))
+        batch.add(reader);
+    batch.submit();
+    for (int i = 0; i < readers.size(); ++i)
+        QCOMPARE(readers.at(i)->readValue().constData(), QByteArray("value " + QByteArray::number(i)).constData());
+
+    // the prefetched data is only consumed once: the next read has to see the current content
+    QVERIFY(files.at(0)->seek(0));
+    QVERIFY(files.at(0)->write("changed") > 0);
+    QVERIFY(files.at(0)->flush());
+    QCOMPARE(readers.at(0)->readValue().constData(), "changed");
+
+    qDeleteAll(readers);
+    qDeleteAll(files);
+#endif
+}
+
+void tst_SystemMonitorSampler::procFs()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("ProcFsPrefetcher is only available on Linux");
+#else
+    quint64 pid = quint64(QCoreApplication::applicationPid());
+
+    ProcFsPrefetcher procFs;
+    procFs.reset();
+    procFs.addProcessTree(pid, ProcFsPrefetcher::Stat);
+    procFs.addProcess(pid, ProcFsPrefetcher::Statm);
+    QCOMPARE(procFs.processTree(pid).value(0), pid);
+
+    SysFsBatch batch;
+    procFs.addTo(&batch);
+    batch.submit();
+
+    const QByteArray stat = procFs.read(pid, ProcFsPrefetcher::Stat);
+    QVERIFY(stat.startsWith(QByteArray::number(pid) + " ("));
+    QVERIFY(!stat.contains('\0'));
+    QCOMPARE(procFs.read(pid, ProcFsPrefetcher::Stat), stat); // cached within a tick
+    QCOMPARE(procFs.read(pid, ProcFsPrefetcher::Statm).simplified().split(' ').size(), 7);
+
+    // the files are kept open for the next tick, but they are read again
+    procFs.reset();
+    procFs.addProcess(pid, ProcFsPrefetcher::Stat);
+    procFs.addTo(&batch);
+    batch.submit();
+    QVERIFY(procFs.read(pid, ProcFsPrefetcher::Stat).startsWith(QByteArray::number(pid) + " ("));
+
+    // files that have not been prefetched are read synchronously
+    QVERIFY(!procFs.read(pid, ProcFsPrefetcher::Statm).isEmpty());
+#endif
+}
+
+void tst_SystemMonitorSampler::sampler()
+{
+    QThread thread;
+    SystemMonitorSampler *sampler = new SystemMonitorSampler;
+    sampler->moveToThread(&thread);
+    connect(&thread, &QThread::finished, sampler, &QObject::deleteLater);
+    thread.start();
+
+    // the signal is emitted on the sampling thread
+    connect(sampler, &SystemMonitorSampler::reportsAvailable, this, [this]() { ++m_available; },
+            Qt::QueuedConnection);
+
+    SystemMonitorSampler::Configuration config;
+    config.interval = 10;
+    config.cpu = true;
+    config.memory = true;
+    sampler->setConfiguration(config);
+
+    // reportsAvailable() is only emitted once until the reports are taken
+    QTRY_COMPARE_WITH_TIMEOUT(m_available, 1, 2000);
+    QTest::qWait(100);
+    QCOMPARE(m_available, 1);
+
+    // the queue is bounded: reports are dropped instead of piling up
+    SystemMonitorSampler::Report r;
+    int reports = 0;
+    while (sampler->takeReport(&r)) {
+        QVERIFY(r.hasCpu);
+        QVERIFY(r.hasMemory);
+        QVERIFY(r.cpuLoad >= 0 && r.cpuLoad <= 1);
+        ++reports;
+    }
+    QVERIFY(reports >= 1 && reports <= 16);
+
+    // taking the reports re-arms the notification
+    QTRY_COMPARE_WITH_TIMEOUT(m_available, 2, 2000);
+
+    thread.quit();
+    QVERIFY(thread.wait(2000));
+}
+
+QTEST_MAIN(tst_SystemMonitorSampler)
+
+#include "tst_systemmonitorsampler.moc"
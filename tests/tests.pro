@@ -3,6 +3,7 @@ TEMPLATE = subdirs
 enable-tests:SUBDIRS = \
     application \
     runtime \
+    applicationmanager \
     cryptography \
     signature \
     utilities \
@@ -11,9 +12,15 @@ enable-tests:SUBDIRS = \
     packageextractor \
     packager-tool \
     applicationinstaller \
+    systemmonitorhistory \
+    systemmonitorsampler \
+    frametimer \
+    metricsexporter \
+    trace \
 
 enable-tests:linux*:SUBDIRS += \
     sudo \
+    processcontainer \
 
 OTHER_FILES += \
     tests.pri \
@@ -0,0 +1,11 @@
+TARGET = tst_trace
+
+include($$PWD/../tests.pri)
+
+QT *= \
+    appman_common-private \
+
+# test the macros, even if the application-manager itself is built without tracing
+DEFINES *= AM_TRACING
+
+SOURCES += tst_trace.cpp
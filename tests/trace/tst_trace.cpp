@@ -0,0 +1,155 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 Pelagicore AG
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Pelagicore Application Manager.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT-QTAS$
+** Commercial License Usage
+** Licensees holding valid commercial Qt Automotive Suite licenses may use
+** this file in accordance with the commercial license agreement provided
+** with the Software or, alternatively, in accordance with the terms
+** contained in a written agreement between you and The Qt Company.  For
+** licensing terms and conditions see https://www.qt.io/terms-conditions.
+** For further information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "trace.h"
+
+QT_USE_NAMESPACE_AM
+
+class WorkerThread : public QThread
+{
+protected:
+    void run() override
+    {
+        Trace::record(Trace::Instant, "test", "threadEvent", "worker");
+    }
+};
+
+class tst_Trace : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void macros();
+    void threads();
+    void wrapAround();
+    void dump();
+
+private:
+    static QJsonArray events(const QString &name);
+};
+
+// all events called name in the current trace
+QJsonArray tst_Trace::events(const QString &name)
+{
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(Trace::toChromeJson(), &error);
+    if (error.error != QJsonParseError::NoError)
+        return QJsonArray();
+
+    QJsonArray result;
+    for (const QJsonValue &v : doc.object().value(qSL("traceEvents")).toArray()) {
+        if (v.toObject().value(qSL("name")).toString() == name)
+            result.append(v);
+    }
+    return result;
+}
+
+void tst_Trace::macros()
+{
+    {
+        AM_TRACE_SCOPE("test", "macroScope", qSL("with a text that is too long to fit"), 42);
+        AM_TRACE_INSTANT("test", "macroInstant");
+    }
+
+    QJsonArray scope = events(qSL("macroScope"));
+    QCOMPARE(scope.size(), 2);
+    QJsonObject begin = scope.at(0).toObject();
+    QJsonObject end = scope.at(1).toObject();
+    QCOMPARE(begin.value(qSL("ph")).toString(), qSL("B"));
+    QCOMPARE(begin.value(qSL("cat")).toString(), qSL("test"));
+    QCOMPARE(begin.value(qSL("args")).toObject().value(qSL("text")).toString(),
+             qSL("with a text that is too long t"));
+    QCOMPARE(begin.value(qSL("args")).toObject().value(qSL("value")).toInt(), 42);
+    QCOMPARE(end.value(qSL("ph")).toString(), qSL("E"));
+    QVERIFY(!end.contains(qSL("args")));
+    QVERIFY(end.value(qSL("ts")).toDouble() >= begin.value(qSL("ts")).toDouble());
+
+    QJsonArray instant = events(qSL("macroInstant"));
+    QCOMPARE(instant.size(), 1);
+    QCOMPARE(instant.at(0).toObject().value(qSL("ph")).toString(), qSL("i"));
+    QCOMPARE(instant.at(0).toObject().value(qSL("tid")), begin.value(qSL("tid")));
+}
+
+void tst_Trace::threads()
+{
+    WorkerThread t;
+    t.setObjectName(qSL("worker"));
+    t.start();
+    QVERIFY(t.wait(5000));
+    Trace::record(Trace::Instant, "test", "threadEvent", "main");
+
+    QJsonArray threadEvents = events(qSL("threadEvent"));
+    QCOMPARE(threadEvents.size(), 2);
+    QVERIFY(threadEvents.at(0).toObject().value(qSL("tid")) != threadEvents.at(1).toObject().value(qSL("tid")));
+
+    bool foundThreadName = false;
+    for (const QJsonValue &v : events(qSL("thread_name")))
+        foundThreadName = foundThreadName || (v.toObject().value(qSL("args")).toObject().value(qSL("name")).toString() == qSL("worker"));
+    QVERIFY(foundThreadName);
+}
+
+void tst_Trace::wrapAround()
+{
+    // the ring buffer keeps the last 4096 events of each thread
+    for (int i = 0; i < 5000; ++i)
+        Trace::record(Trace::Instant, "test", "wrapEvent", nullptr, i);
+
+    QJsonArray wrapEvents = events(qSL("wrapEvent"));
+    QCOMPARE(wrapEvents.size(), 4096);
+    QCOMPARE(wrapEvents.first().toObject().value(qSL("args")).toObject().value(qSL("value")).toInt(), 5000 - 4096);
+    QCOMPARE(wrapEvents.last().toObject().value(qSL("args")).toObject().value(qSL("value")).toInt(), 4999);
+}
+
+void tst_Trace::dump()
+{
+    QTemporaryDir tmp;
+    QVERIFY(tmp.isValid());
+    QString fileName = tmp.path() + qSL("/trace.json");
+
+    Trace::record(Trace::Instant, "test", "dumpEvent");
+    QVERIFY(Trace::dump(fileName));
+
+    QFile f(fileName);
+    QVERIFY(f.open(QFile::ReadOnly));
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QVERIFY(doc.object().value(qSL("traceEvents")).isArray());
+    QVERIFY(!Trace::dump(tmp.path() + qSL("/does-not-exist/trace.json")));
+}
+
+QTEST_MAIN(tst_Trace)
+
+#include "tst_trace.moc"